@@ -0,0 +1,274 @@
+#pragma once
+#include <QRectF>
+#include <QPointF>
+#include <QHash>
+#include <QVector>
+#include <QPair>
+#include <QPointer>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QCoreApplication>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+/**
+ * @brief Web map tile grid used to page layers in per-viewport cells
+ *
+ * Cell (z, x, y) is the 256 px tile of that address; bounds are in degrees.
+ */
+namespace CellGrid {
+
+constexpr double MaxMercatorLatitude = 85.05112878;
+
+inline int lonToCellX(double lon, int z)
+{
+    const int n = 1 << z;
+    int x = static_cast<int>(std::floor((lon + 180.0) / 360.0 * n));
+    return qBound(0, x, n - 1);
+}
+
+inline int latToCellY(double lat, int z)
+{
+    const int n = 1 << z;
+    double latRad = qDegreesToRadians(qBound(-MaxMercatorLatitude, lat, MaxMercatorLatitude));
+    int y = static_cast<int>(std::floor((1.0 - std::asinh(std::tan(latRad)) / M_PI) / 2.0 * n));
+    return qBound(0, y, n - 1);
+}
+
+inline double cellXToLon(int x, int z)
+{
+    return x / static_cast<double>(1 << z) * 360.0 - 180.0;
+}
+
+inline double cellYToLat(int y, int z)
+{
+    double n = M_PI * (1.0 - 2.0 * y / static_cast<double>(1 << z));
+    return qRadiansToDegrees(std::atan(std::sinh(n)));
+}
+
+inline quint64 cellKey(int z, int x, int y)
+{
+    return (static_cast<quint64>(z) << 48) | (static_cast<quint64>(x) << 24) | static_cast<quint64>(y);
+}
+
+inline QRectF cellBounds(int z, int x, int y)
+{
+    QPointF northWest(cellXToLon(x, z), cellYToLat(y, z));
+    QPointF southEast(cellXToLon(x + 1, z), cellYToLat(y + 1, z));
+    return QRectF(northWest, southEast).normalized();
+}
+
+// Degrees of longitude covered by the given number of pixels at zoom z
+inline double toleranceForZoom(int z, double pixels)
+{
+    return pixels * 360.0 / (256.0 * static_cast<double>(1 << z));
+}
+
+} // namespace CellGrid
+
+/**
+ * @brief LRU cache of the cells a layer has fetched, shared by the cell-paged layers
+ *
+ * Cells are kept per (z, x, y) and evicted least recently used first once there
+ * are more than the capacity; cells used by the current frame are never evicted.
+ * A failed fetch is tried again after RetryDelayMs. Items (features, points)
+ * returned by several cells are stored once per group and id, and dropped with
+ * the last cell that returned them; Item needs an int cellRefs member for this.
+ * Layers whose geometry depends on the cell zoom use the zoom as the group.
+ *
+ * Used on the GUI thread only; fetch() runs its read callback on a worker pool
+ * and delivers the result back through the event loop.
+ */
+template<typename Item>
+class CellCache {
+public:
+    using Items = QHash<qint64, Item>;
+    using Fetched = QVector<QPair<qint64, Item>>;
+
+    static constexpr qint64 RetryDelayMs = 5000;
+
+    explicit CellCache(int capacity) : m_capacity(capacity) { m_clock.start(); }
+
+    int cellCount() const { return m_cells.size(); }
+    int itemCount() const
+    {
+        int count = 0;
+        for (const Items& items : m_items) {
+            count += items.size();
+        }
+        return count;
+    }
+    const Items& items(int group) const
+    {
+        static const Items empty;
+        auto it = m_items.constFind(group);
+        return it != m_items.cend() ? *it : empty;
+    }
+    // Bumped whenever items are added or dropped
+    quint64 revision() const { return m_revision; }
+    // Bumped by clear(); results fetched before it are dropped
+    int generation() const { return m_generation; }
+
+    // Marks the cells of zoom z covering visible as used by a new frame, calls
+    // startFetch(key, z, bounds) for those not cached yet or due for a retry,
+    // then evicts. Returns true once every visible cell is loaded.
+    template<typename StartFetch>
+    bool requestVisible(const QRectF& visible, int z, int group, StartFetch startFetch)
+    {
+        ++m_frame;
+        const int x0 = CellGrid::lonToCellX(visible.left(), z);
+        const int x1 = CellGrid::lonToCellX(visible.right(), z);
+        const int y0 = CellGrid::latToCellY(visible.bottom(), z); // North edge has the smaller row
+        const int y1 = CellGrid::latToCellY(visible.top(), z);
+        const qint64 now = m_clock.elapsed();
+        bool complete = true;
+
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                const quint64 key = CellGrid::cellKey(z, x, y);
+                auto it = m_cells.find(key);
+                if (it == m_cells.end()) {
+                    Cell cell;
+                    cell.group = group;
+                    it = m_cells.insert(key, cell);
+                    startFetch(key, z, CellGrid::cellBounds(z, x, y));
+                } else if (it->state == Failed && now - it->failedAtMs >= RetryDelayMs) {
+                    it->state = Loading;
+                    startFetch(key, z, CellGrid::cellBounds(z, x, y));
+                }
+                it->lastUsedFrame = m_frame;
+                complete = complete && it->state == Loaded;
+            }
+        }
+
+        evict();
+        return complete;
+    }
+
+    // Runs read(Fetched&) on workers and applies its result on the GUI thread.
+    // Nothing is applied once owner, which must own this cache, is destroyed;
+    // changed runs after a result added items.
+    template<typename Read>
+    void fetch(QThreadPool& workers, QObject* owner, quint64 key, Read read, std::function<void()> changed)
+    {
+        QPointer<QObject> guard(owner);
+        CellCache* cache = this;
+        const int generation = m_generation;
+
+        workers.start([guard, cache, key, generation, read, changed]() {
+            Fetched fetched;
+            const bool ok = read(fetched);
+
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, cache, key, generation, ok, fetched, changed]() {
+                if (guard && cache->apply(key, generation, ok, fetched) && changed) {
+                    changed();
+                }
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    // Takes the result of a fetch started in the given generation; returns true
+    // when it was still wanted and added items
+    bool apply(quint64 key, int generation, bool ok, const Fetched& fetched)
+    {
+        auto it = m_cells.find(key);
+        if (generation != m_generation || it == m_cells.end() || it->state != Loading) {
+            return false; // Cleared or evicted while the fetch ran
+        }
+
+        if (!ok) {
+            it->state = Failed;
+            it->failedAtMs = m_clock.elapsed();
+            return false;
+        }
+
+        it->state = Loaded;
+        it->itemIds.reserve(fetched.size());
+        Items& items = m_items[it->group];
+        for (const auto& entry : fetched) {
+            // Items crossing cell borders arrive once per cell; keep a single copy
+            Item& item = items[entry.first];
+            if (item.cellRefs == 0) {
+                item = entry.second;
+                item.cellRefs = 0;
+            }
+            ++item.cellRefs;
+            it->itemIds.append(entry.first);
+        }
+
+        if (fetched.isEmpty()) return false;
+        ++m_revision;
+        return true;
+    }
+
+    void clear()
+    {
+        ++m_generation;
+        ++m_revision;
+        m_cells.clear();
+        m_items.clear();
+    }
+
+private:
+    enum CellState {
+        Loading,
+        Loaded,
+        Failed
+    };
+
+    struct Cell {
+        CellState state = Loading;
+        QVector<qint64> itemIds;
+        int group = 0;
+        quint64 lastUsedFrame = 0;
+        qint64 failedAtMs = 0;
+    };
+
+    void release(const Cell& cell)
+    {
+        auto items = m_items.find(cell.group);
+        if (items == m_items.end()) return;
+
+        for (qint64 id : cell.itemIds) {
+            auto item = items->find(id);
+            if (item != items->end() && --item->cellRefs <= 0) {
+                items->erase(item);
+                ++m_revision;
+            }
+        }
+        if (items->isEmpty()) {
+            m_items.erase(items);
+        }
+    }
+
+    void evict()
+    {
+        if (m_cells.size() <= m_capacity) return;
+
+        // Least recently used first; cells of the current frame are never evicted
+        QVector<QPair<quint64, quint64>> candidates; // (last used frame, key)
+        for (auto it = m_cells.cbegin(); it != m_cells.cend(); ++it) {
+            if (it->lastUsedFrame != m_frame) {
+                candidates.append(qMakePair(it->lastUsedFrame, it.key()));
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        for (const auto& candidate : qAsConst(candidates)) {
+            if (m_cells.size() <= m_capacity) break;
+            auto it = m_cells.find(candidate.second);
+            release(*it);
+            m_cells.erase(it);
+        }
+    }
+
+    QHash<quint64, Cell> m_cells;
+    QHash<int, Items> m_items;
+    int m_capacity;
+    int m_generation = 0;
+    quint64 m_revision = 0;
+    quint64 m_frame = 0;
+    QElapsedTimer m_clock;
+};
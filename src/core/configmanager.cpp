@@ -109,6 +109,96 @@ int ConfigManager::getDatabasePolygonsLimit() const
     return m_databaseConfig["tables"]["polygons"]["limit"].toInt(1000);
 }
 
+QString ConfigManager::getDatabasePolygonsIdColumn() const
+{
+    return m_databaseConfig["tables"]["polygons"]["id_column"].toString("id");
+}
+
+int ConfigManager::getPolygonCellMinZoom() const
+{
+    return m_databaseConfig["tables"]["polygons"]["cell_min_zoom"].toInt(4);
+}
+
+int ConfigManager::getPolygonCellMaxZoom() const
+{
+    return m_databaseConfig["tables"]["polygons"]["cell_max_zoom"].toInt(12);
+}
+
+int ConfigManager::getPolygonCellCacheSize() const
+{
+    return m_databaseConfig["tables"]["polygons"]["cell_cache_size"].toInt(256);
+}
+
+int ConfigManager::getPolygonFetchThreads() const
+{
+    return m_databaseConfig["tables"]["polygons"]["fetch_threads"].toInt(2);
+}
+
+double ConfigManager::getPolygonSimplifyTolerance() const
+{
+    return m_databaseConfig["tables"]["polygons"]["simplify_tolerance_px"].toDouble(0.5);
+}
+
+QString ConfigManager::getDatabasePointsTableName() const
+{
+    return m_databaseConfig["tables"]["points"]["table_name"].toString("points");
+}
+
+QString ConfigManager::getDatabasePointsGeometryColumn() const
+{
+    return m_databaseConfig["tables"]["points"]["geometry_column"].toString("geom");
+}
+
+QString ConfigManager::getDatabasePointsIdColumn() const
+{
+    return m_databaseConfig["tables"]["points"]["id_column"].toString("id");
+}
+
+QString ConfigManager::getDatabasePointsNameColumn() const
+{
+    return m_databaseConfig["tables"]["points"]["name_column"].toString("name");
+}
+
+int ConfigManager::getDatabasePointsLimit() const
+{
+    return m_databaseConfig["tables"]["points"]["limit"].toInt(5000);
+}
+
+int ConfigManager::getPointCellMinZoom() const
+{
+    return m_databaseConfig["tables"]["points"]["cell_min_zoom"].toInt(6);
+}
+
+int ConfigManager::getPointCellMaxZoom() const
+{
+    return m_databaseConfig["tables"]["points"]["cell_max_zoom"].toInt(12);
+}
+
+int ConfigManager::getPointCellCacheSize() const
+{
+    return m_databaseConfig["tables"]["points"]["cell_cache_size"].toInt(256);
+}
+
+int ConfigManager::getPointFetchThreads() const
+{
+    return m_databaseConfig["tables"]["points"]["fetch_threads"].toInt(1);
+}
+
+int ConfigManager::getPointClusterRadius() const
+{
+    return m_databaseConfig["tables"]["points"]["cluster_radius_px"].toInt(48);
+}
+
+int ConfigManager::getPointClusterMaxZoom() const
+{
+    return m_databaseConfig["tables"]["points"]["cluster_max_zoom"].toInt(16);
+}
+
+int ConfigManager::getPointAggregateMaxZoom() const
+{
+    return m_databaseConfig["tables"]["points"]["aggregate_max_zoom"].toInt(10);
+}
+
 QString ConfigManager::getDatabaseUsername() const
 {
     return getDatabaseUser(); // Alias
@@ -119,6 +209,96 @@ int ConfigManager::getDatabaseConnectionTimeout() const
     return getDatabaseTimeout(); // Alias
 }
 
+int ConfigManager::getDatabaseMaxConnections() const
+{
+    return m_databaseConfig["postgis"]["max_connections"].toInt(10);
+}
+
+int ConfigManager::getDatabaseHealthCheckInterval() const
+{
+    return m_databaseConfig["postgis"]["health_check_interval_s"].toInt(30);
+}
+
+int ConfigManager::getDatabaseFailureThreshold() const
+{
+    return m_databaseConfig["postgis"]["failure_threshold"].toInt(3);
+}
+
+int ConfigManager::getDatabaseProbeMinInterval() const
+{
+    return m_databaseConfig["postgis"]["probe_min_interval_ms"].toInt(1000);
+}
+
+int ConfigManager::getDatabaseProbeMaxInterval() const
+{
+    return m_databaseConfig["postgis"]["probe_max_interval_ms"].toInt(60000);
+}
+
+int ConfigManager::getPersistenceFlushInterval() const
+{
+    return m_databaseConfig["persistence"]["flush_interval_ms"].toInt(1000);
+}
+
+int ConfigManager::getPersistenceBatchSize() const
+{
+    return m_databaseConfig["persistence"]["batch_size"].toInt(500);
+}
+
+QString ConfigManager::getPersistenceJournalPath() const
+{
+    return m_databaseConfig["persistence"]["journal"]["path"].toString("resources/cache/persistence.journal");
+}
+
+int ConfigManager::getPersistenceJournalMaxSize() const
+{
+    return m_databaseConfig["persistence"]["journal"]["max_size_mb"].toInt(64);
+}
+
+int ConfigManager::getPersistenceJournalSaveInterval() const
+{
+    return m_databaseConfig["persistence"]["journal"]["save_interval_ms"].toInt(10000);
+}
+
+bool ConfigManager::getPositionHistoryEnabled() const
+{
+    return m_databaseConfig["position_history"]["enabled"].toBool(true);
+}
+
+int ConfigManager::getPositionHistoryBatchSize() const
+{
+    return m_databaseConfig["position_history"]["batch_size"].toInt(5000);
+}
+
+int ConfigManager::getPositionHistoryMaxPending() const
+{
+    return m_databaseConfig["position_history"]["max_pending_samples"].toInt(200000);
+}
+
+int ConfigManager::getPositionHistoryPartitionDaysAhead() const
+{
+    return m_databaseConfig["position_history"]["partition_days_ahead"].toInt(2);
+}
+
+int ConfigManager::getPositionHistoryRetentionDays() const
+{
+    return m_databaseConfig["position_history"]["retention_days"].toInt(30);
+}
+
+QString ConfigManager::getDatabaseMetricsDumpPath() const
+{
+    return m_databaseConfig["metrics"]["dump_path"].toString();
+}
+
+bool ConfigManager::getChangeNotificationsEnabled() const
+{
+    return m_databaseConfig["notifications"]["enabled"].toBool(true);
+}
+
+int ConfigManager::getChangeNotificationCoalesceInterval() const
+{
+    return m_databaseConfig["notifications"]["coalesce_ms"].toInt(100);
+}
+
 // Map configuration
 QPointF ConfigManager::getDefaultMapCenter() const
 {
@@ -181,6 +361,16 @@ int ConfigManager::getAircraftUpdateInterval() const
     return m_aircraftConfig["aircraft"]["update_interval_ms"].toInt(1000);
 }
 
+int ConfigManager::getAircraftTickInterval() const
+{
+    return m_aircraftConfig["aircraft"]["tick_interval_ms"].toInt(100);
+}
+
+int ConfigManager::getAircraftLoadBatchSize() const
+{
+    return m_aircraftConfig["aircraft"]["load_batch_size"].toInt(1000);
+}
+
 int ConfigManager::getAircraftIconSize() const
 {
     return m_aircraftConfig["aircraft"]["icon_size"].toInt(20);
@@ -236,6 +426,52 @@ QPolygonF ConfigManager::getHanoiRegion() const
     return polygon;
 }
 
+// Flight trail configuration
+int ConfigManager::getTrailMaxPoints() const
+{
+    return m_aircraftConfig["trail"]["max_points"].toInt(50);
+}
+
+int ConfigManager::getTrailPoolBlockSlots() const
+{
+    return m_aircraftConfig["trail"]["pool_block_slots"].toInt(256);
+}
+
+double ConfigManager::getTrailMinDistancePx() const
+{
+    return m_aircraftConfig["trail"]["min_distance_px"].toDouble(2.0);
+}
+
+double ConfigManager::getTrailMinHeadingChange() const
+{
+    return m_aircraftConfig["trail"]["min_heading_change_deg"].toDouble(5.0);
+}
+
+int ConfigManager::getTrailReferenceZoom() const
+{
+    return m_aircraftConfig["trail"]["reference_zoom"].toInt(getDefaultZoom());
+}
+
+int ConfigManager::getTrailFadeInterval() const
+{
+    return m_aircraftConfig["trail"]["fade_interval_ms"].toInt(500);
+}
+
+double ConfigManager::getTrailFadeFactor() const
+{
+    return m_aircraftConfig["trail"]["fade_factor"].toDouble(0.9);
+}
+
+int ConfigManager::getGeofenceDwellSeconds() const
+{
+    return m_aircraftConfig["geofence"]["dwell_seconds"].toInt(60);
+}
+
+int ConfigManager::getGeofenceEventBatchInterval() const
+{
+    return m_aircraftConfig["geofence"]["event_batch_ms"].toInt(200);
+}
+
 // Application configuration
 QString ConfigManager::getApplicationName() const
 {
@@ -320,3 +556,63 @@ bool ConfigManager::isAntialiasingEnabled() const
 {
     return m_dataSourcesConfig["rendering"]["antialiasing"].toBool(true);
 }
+
+int ConfigManager::getVectorLoadBatchSize() const
+{
+    return m_dataSourcesConfig["vector_loading"]["batch_size"].toInt(500);
+}
+
+bool ConfigManager::getGeometryCacheEnabled() const
+{
+    return m_dataSourcesConfig["vector_loading"]["geometry_cache"]["enabled"].toBool(true);
+}
+
+QString ConfigManager::getGeometryCacheDirectory() const
+{
+    return m_dataSourcesConfig["vector_loading"]["geometry_cache"]["directory"].toString("resources/cache/geometry");
+}
+
+int ConfigManager::getIndexedCellMinZoom() const
+{
+    return m_dataSourcesConfig["vector_loading"]["indexed_sources"]["cell_min_zoom"].toInt(10);
+}
+
+int ConfigManager::getIndexedCellMaxZoom() const
+{
+    return m_dataSourcesConfig["vector_loading"]["indexed_sources"]["cell_max_zoom"].toInt(14);
+}
+
+int ConfigManager::getIndexedCellCacheSize() const
+{
+    return m_dataSourcesConfig["vector_loading"]["indexed_sources"]["cell_cache_size"].toInt(256);
+}
+
+int ConfigManager::getIndexedFetchThreads() const
+{
+    return m_dataSourcesConfig["vector_loading"]["indexed_sources"]["fetch_threads"].toInt(2);
+}
+
+int ConfigManager::getIndexedMaxFeaturesPerCell() const
+{
+    return m_dataSourcesConfig["vector_loading"]["indexed_sources"]["max_features_per_cell"].toInt(50000);
+}
+
+double ConfigManager::getIndexedSimplifyTolerance() const
+{
+    return m_dataSourcesConfig["vector_loading"]["indexed_sources"]["simplify_tolerance_px"].toDouble(0.5);
+}
+
+bool ConfigManager::getReverseGeocodingEnabled() const
+{
+    return m_dataSourcesConfig["reverse_geocoding"]["enabled"].toBool(true);
+}
+
+QString ConfigManager::getReverseGeocodingSource() const
+{
+    return m_dataSourcesConfig["reverse_geocoding"]["source"].toString("resources/shapefiles/vn.json");
+}
+
+QString ConfigManager::getReverseGeocodingNameField() const
+{
+    return m_dataSourcesConfig["reverse_geocoding"]["name_field"].toString("name");
+}
@@ -34,8 +34,45 @@ public:
     QString getDatabasePolygonsTableName() const;
     QString getDatabasePolygonsGeometryColumn() const;
     int getDatabasePolygonsLimit() const;
+    QString getDatabasePolygonsIdColumn() const;
+    // Viewport fetching: cells are map tiles at the view zoom clamped to [min, max]
+    int getPolygonCellMinZoom() const;
+    int getPolygonCellMaxZoom() const;
+    int getPolygonCellCacheSize() const;
+    int getPolygonFetchThreads() const;
+    double getPolygonSimplifyTolerance() const; // Server-side generalization tolerance in pixels
+    QString getDatabasePointsTableName() const;
+    QString getDatabasePointsGeometryColumn() const;
+    QString getDatabasePointsIdColumn() const;
+    QString getDatabasePointsNameColumn() const;
+    int getDatabasePointsLimit() const; // Rows per fetched cell
+    int getPointCellMinZoom() const;
+    int getPointCellMaxZoom() const;
+    int getPointCellCacheSize() const;
+    int getPointFetchThreads() const;
+    int getPointClusterRadius() const; // Grid cell size in pixels when clustering points
+    int getPointClusterMaxZoom() const; // Points are drawn individually above this zoom
+    int getPointAggregateMaxZoom() const; // Up to this zoom the server sends counts per grid cell, not points
     QString getDatabaseUsername() const;  // Alias for getDatabaseUser
     int getDatabaseConnectionTimeout() const; // Alias for getDatabaseTimeout
+    int getDatabaseMaxConnections() const;
+    int getDatabaseHealthCheckInterval() const; // Seconds a pooled connection may idle before it is re-validated
+    int getDatabaseFailureThreshold() const; // Consecutive connect failures before going offline
+    int getDatabaseProbeMinInterval() const; // Offline probe backoff bounds in milliseconds
+    int getDatabaseProbeMaxInterval() const;
+    int getPersistenceFlushInterval() const;
+    int getPersistenceBatchSize() const;
+    QString getPersistenceJournalPath() const; // Unwritten changes kept across restarts; empty disables
+    int getPersistenceJournalMaxSize() const; // MB
+    int getPersistenceJournalSaveInterval() const; // Milliseconds between saves while writes are failing
+    bool getPositionHistoryEnabled() const;
+    int getPositionHistoryBatchSize() const;
+    int getPositionHistoryMaxPending() const; // Samples held while the database is unreachable
+    int getPositionHistoryPartitionDaysAhead() const;
+    int getPositionHistoryRetentionDays() const;
+    QString getDatabaseMetricsDumpPath() const; // Metrics JSON written at exit; empty disables
+    bool getChangeNotificationsEnabled() const;
+    int getChangeNotificationCoalesceInterval() const; // Milliseconds notifications are gathered into one batch
     
     // Map configuration
     QPointF getDefaultMapCenter() const;
@@ -51,6 +88,8 @@ public:
     // Aircraft configuration
     double getDefaultAircraftSpeed() const;
     int getAircraftUpdateInterval() const;
+    int getAircraftTickInterval() const;
+    int getAircraftLoadBatchSize() const;
     int getAircraftIconSize() const;
     int getAircraftSelectionRadius() const;
     int getMaxAircraftCount() const;
@@ -59,6 +98,19 @@ public:
     QRectF getMovementBoundary() const;
     QPolygonF getHanoiRegion() const;
     
+    // Flight trail configuration
+    int getTrailMaxPoints() const;       // Also the hard cap for Aircraft::setMaxTrailPoints()
+    int getTrailPoolBlockSlots() const;
+    double getTrailMinDistancePx() const;
+    double getTrailMinHeadingChange() const;
+    int getTrailReferenceZoom() const;
+    int getTrailFadeInterval() const;
+    double getTrailFadeFactor() const;
+    
+    // Geofence configuration
+    int getGeofenceDwellSeconds() const;
+    int getGeofenceEventBatchInterval() const;
+    
     // Application configuration
     QString getApplicationName() const;
     QString getApplicationVersion() const;
@@ -74,6 +126,18 @@ public:
     double getPolygonOpacity() const;
     int getBorderWidth() const;
     bool isAntialiasingEnabled() const;
+    int getVectorLoadBatchSize() const; // Features read per batch handed to the map
+    bool getGeometryCacheEnabled() const;
+    QString getGeometryCacheDirectory() const; // Compiled vector caches, one file per source hash
+    int getIndexedCellMinZoom() const; // GeoPackage/FlatGeobuf sources read per viewport cell
+    int getIndexedCellMaxZoom() const;
+    int getIndexedCellCacheSize() const;
+    int getIndexedFetchThreads() const;
+    int getIndexedMaxFeaturesPerCell() const;
+    double getIndexedSimplifyTolerance() const; // Vertex thinning distance in pixels
+    bool getReverseGeocodingEnabled() const;
+    QString getReverseGeocodingSource() const; // Province boundaries aircraft are tagged with
+    QString getReverseGeocodingNameField() const;
 
 signals:
     void configurationChanged();
@@ -0,0 +1,103 @@
+#include "featurestore.h"
+#include "viewtransform.h"
+#include <QPolygonF>
+#include <QVariant>
+#include <QDebug>
+
+std::shared_ptr<const FeatureStore> FeatureStore::fromCache(const GeometryCache& cache, const QString& nameField)
+{
+    std::shared_ptr<FeatureStore> store(new FeatureStore());
+
+    QVector<RTree<int>::Entry> entries;
+    entries.reserve(cache.featureCount());
+
+    for (int index = 0; index < cache.featureCount(); ++index) {
+        // Level 0 is full resolution; generalized rings would misplace points near borders
+        QVector<QPolygonF> rings;
+        const int ringCount = cache.ringCount(index, 0);
+        for (int r = 0; r < ringCount; ++r) {
+            const GeometryCache::Ring& ring = cache.ring(index, 0, r);
+            const GeometryCache::Point* points = cache.points(ring);
+
+            QPolygonF polygon;
+            polygon.reserve(int(ring.pointCount));
+            for (quint32 i = 0; i < ring.pointCount; ++i) {
+                polygon.append(QPointF(points[i].x, points[i].y));
+            }
+            rings.append(polygon);
+        }
+
+        store->append(cache.featureName(index), cache.featureAttributes(index), rings, nameField, entries);
+    }
+    store->m_tree.build(std::move(entries));
+
+    qDebug() << "Feature store indexed" << store->m_features.size() << "features";
+    return store;
+}
+
+std::shared_ptr<const FeatureStore> FeatureStore::fromFeatures(const QVector<GeometryCache::SourceFeature>& features,
+                                                               const QString& nameField)
+{
+    std::shared_ptr<FeatureStore> store(new FeatureStore());
+
+    QVector<RTree<int>::Entry> entries;
+    entries.reserve(features.size());
+
+    for (const GeometryCache::SourceFeature& source : features) {
+        // Projected like the cache compiler does, so both paths locate the same
+        QVector<QPolygonF> rings;
+        rings.reserve(source.rings.size());
+        for (const QPolygonF& ring : source.rings) {
+            QPolygonF world;
+            world.reserve(ring.size());
+            for (const QPointF& point : ring) {
+                world.append(ViewTransform::projectToWorld(point));
+            }
+            rings.append(world);
+        }
+
+        store->append(source.name, source.attributes, rings, nameField, entries);
+    }
+    store->m_tree.build(std::move(entries));
+
+    qDebug() << "Feature store indexed" << store->m_features.size() << "streamed features";
+    return store;
+}
+
+void FeatureStore::append(const QString& name, const QJsonObject& attributes, const QVector<QPolygonF>& rings,
+                          const QString& nameField, QVector<RTree<int>::Entry>& entries)
+{
+    Feature feature;
+    feature.attributes = attributes;
+    feature.name = attributes.value(nameField).toVariant().toString();
+    if (feature.name.isEmpty()) {
+        feature.name = name;
+    }
+    feature.polygon = PreparedPolygon(rings);
+    if (feature.polygon.isEmpty()) return;
+
+    const int featureIndex = m_features.size();
+    entries.append(RTree<int>::Entry{feature.polygon.boundingRect(), featureIndex});
+    if (!feature.name.isEmpty() && !m_nameIndex.contains(feature.name)) {
+        m_nameIndex.insert(feature.name, featureIndex);
+    }
+    m_features.append(std::move(feature));
+}
+
+int FeatureStore::locate(const QPointF& geoPoint, int hint) const
+{
+    const QPointF world = ViewTransform::projectToWorld(geoPoint);
+
+    // A moving point usually stays in the same feature: one grid lookup, no tree walk
+    if (hint >= 0 && hint < m_features.size() && m_features[hint].polygon.containsPoint(world)) {
+        return hint;
+    }
+
+    int found = -1;
+    m_tree.query(world, [&](int index) {
+        if ((found < 0 || index < found) && index != hint && m_features[index].polygon.containsPoint(world)) {
+            found = index;
+        }
+    });
+    return found;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "geometrycache.h"
+#include "preparedpolygon.h"
+#include "rtree.h"
+#include <QHash>
+#include <QJsonObject>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+/**
+ * @brief Polygon features with their attributes, indexed for point lookups
+ *
+ * Built once from a compiled GeometryCache, or from the streamed features
+ * when no cache is kept, so names and attributes come with the geometry
+ * either way. Each feature's full-resolution rings
+ * become a PreparedPolygon in world coordinates, and an R-tree over their
+ * bounds narrows a lookup to the few features near the point. Features are
+ * expected not to overlap (administrative areas); where they do, the lowest
+ * index wins.
+ */
+class FeatureStore {
+public:
+    struct Feature {
+        QString name;
+        QJsonObject attributes;
+        PreparedPolygon polygon;  // World (zoom-0) coordinates
+    };
+
+    // nameField selects the attribute used as feature name, falling back to the cached name
+    static std::shared_ptr<const FeatureStore> fromCache(const GeometryCache& cache,
+                                                         const QString& nameField = QString());
+    // Same, from longitude/latitude features as VectorLoader streams them
+    static std::shared_ptr<const FeatureStore> fromFeatures(const QVector<GeometryCache::SourceFeature>& features,
+                                                            const QString& nameField = QString());
+
+    int size() const { return m_features.size(); }
+    bool isEmpty() const { return m_features.isEmpty(); }
+    const Feature& feature(int index) const { return m_features[index]; }
+    QString name(int index) const { return index < 0 ? QString() : m_features[index].name; }
+    int indexOf(const QString& name) const { return m_nameIndex.value(name, -1); }
+
+    // Feature containing the longitude/latitude point, or -1. The hint, usually
+    // the previous answer for a moving point, is tested before the R-tree.
+    int locate(const QPointF& geoPoint, int hint = -1) const;
+
+private:
+    FeatureStore() = default;
+
+    // Adds the feature unless it has no area; rings in world coordinates
+    void append(const QString& name, const QJsonObject& attributes, const QVector<QPolygonF>& rings,
+                const QString& nameField, QVector<RTree<int>::Entry>& entries);
+
+    QVector<Feature> m_features;
+    QHash<QString, int> m_nameIndex;
+    RTree<int> m_tree;
+};
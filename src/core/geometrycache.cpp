@@ -0,0 +1,400 @@
+#include "geometrycache.h"
+#include "viewtransform.h"
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDir>
+#include <QJsonDocument>
+#include <QDebug>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+struct GeometryCache::Header {
+    char magic[8];
+    quint32 version;
+    quint32 lodCount;
+    quint8 sourceHash[32];
+    quint32 featureCount;
+    quint32 ringCount;
+    quint64 pointCount;
+    quint64 featuresOffset;
+    quint64 ringsOffset;
+    quint64 pointsOffset;
+    quint64 stringsOffset;
+    quint64 stringsSize;
+    double lodTolerance[LodCount];  // World units; 0 for full resolution
+};
+
+struct GeometryCache::FeatureRecord {
+    double minX;
+    double minY;
+    double maxX;
+    double maxY;
+    quint32 nameOffset;
+    quint32 nameLength;
+    quint32 attributesOffset;
+    quint32 attributesLength;
+    quint32 firstRing[LodCount];
+    quint32 ringCount[LodCount];
+};
+
+namespace {
+
+constexpr char Magic[8] = { 'G', 'I', 'S', 'G', 'E', 'O', 'C', '\0' };
+
+// A generalized ring may deviate by at most this many pixels at its zoom
+constexpr double LodPixelTolerance = 0.5;
+
+// Zoom each generalized level is built for; level 0 is full resolution
+constexpr std::array<int, GeometryCache::LodCount> LodZooms = { 0, 12, 9, 6 };
+
+static_assert(std::is_standard_layout<GeometryCache::Point>::value, "Point is mapped from disk");
+static_assert(sizeof(GeometryCache::Point) == 16, "Point layout is part of the file format");
+static_assert(sizeof(GeometryCache::Ring) == 16, "Ring layout is part of the file format");
+
+quint64 align8(quint64 offset)
+{
+    return (offset + 7) & ~quint64(7);
+}
+
+double lodTolerance(int lod)
+{
+    return lod == 0 ? 0.0 : LodPixelTolerance / double(1 << LodZooms[lod]);
+}
+
+double perpendicularDistance(const QPointF& p, const QPointF& a, const QPointF& b)
+{
+    const double dx = b.x() - a.x();
+    const double dy = b.y() - a.y();
+    const double length = std::sqrt(dx * dx + dy * dy);
+    if (length == 0.0) {
+        return std::hypot(p.x() - a.x(), p.y() - a.y());
+    }
+    return std::abs(dy * p.x() - dx * p.y() + b.x() * a.y() - b.y() * a.x()) / length;
+}
+
+// Douglas-Peucker without recursion; keeps the first and last point
+QPolygonF simplify(const QPolygonF& ring, double tolerance)
+{
+    if (tolerance <= 0.0 || ring.size() <= 4) return ring;
+
+    QVector<bool> keep(ring.size(), false);
+    keep.first() = keep.last() = true;
+
+    QVector<QPair<int, int>> stack;
+    stack.append(qMakePair(0, ring.size() - 1));
+    while (!stack.isEmpty()) {
+        const QPair<int, int> span = stack.takeLast();
+        double maxDistance = 0.0;
+        int farthest = -1;
+        for (int i = span.first + 1; i < span.second; ++i) {
+            const double distance = perpendicularDistance(ring[i], ring[span.first], ring[span.second]);
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                farthest = i;
+            }
+        }
+        if (farthest >= 0 && maxDistance > tolerance) {
+            keep[farthest] = true;
+            stack.append(qMakePair(span.first, farthest));
+            stack.append(qMakePair(farthest, span.second));
+        }
+    }
+
+    QPolygonF simplified;
+    for (int i = 0; i < ring.size(); ++i) {
+        if (keep[i]) simplified << ring[i];
+    }
+    return simplified;
+}
+
+template<typename T>
+bool writeSection(QSaveFile& file, const QVector<T>& items)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Sections are written as raw bytes");
+    const qint64 bytes = qint64(items.size()) * qint64(sizeof(T));
+    return bytes == 0 || file.write(reinterpret_cast<const char*>(items.constData()), bytes) == bytes;
+}
+
+bool writePadding(QSaveFile& file)
+{
+    static const char zeros[8] = {};
+    const qint64 padding = qint64(align8(file.pos()) - file.pos());
+    return padding == 0 || file.write(zeros, padding) == padding;
+}
+
+} // namespace
+
+GeometryCache::~GeometryCache()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+    }
+}
+
+QByteArray GeometryCache::hashSource(const QString& sourcePath)
+{
+    QStringList files = { sourcePath };
+
+    // A shapefile's attributes and index live in sidecar files
+    QFileInfo info(sourcePath);
+    if (info.suffix().compare("shp", Qt::CaseInsensitive) == 0) {
+        for (const char* suffix : { "dbf", "shx", "prj" }) {
+            files << info.dir().filePath(info.completeBaseName() + "." + suffix);
+        }
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    for (const QString& path : files) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            if (path == sourcePath) return QByteArray();
+            continue;
+        }
+        hash.addData(QFileInfo(path).suffix().toUtf8());
+        hash.addData(&file);
+    }
+    return hash.result();
+}
+
+QString GeometryCache::cacheFilePath(const QString& cacheDirectory, const QByteArray& sourceHash)
+{
+    return QDir(cacheDirectory).filePath(QString::fromLatin1(sourceHash.toHex()) + ".gmc");
+}
+
+std::shared_ptr<const GeometryCache> GeometryCache::open(const QString& path, const QByteArray& sourceHash)
+{
+    std::shared_ptr<GeometryCache> cache(new GeometryCache());
+    cache->m_file.setFileName(path);
+    if (!cache->m_file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+
+    cache->m_size = cache->m_file.size();
+    cache->m_data = cache->m_file.map(0, cache->m_size);
+    if (!cache->m_data) {
+        qDebug() << "Cannot map geometry cache" << path << ":" << cache->m_file.errorString();
+        return nullptr;
+    }
+
+    if (!cache->validate(sourceHash)) {
+        qDebug() << "Ignoring stale or corrupt geometry cache" << path;
+        return nullptr;
+    }
+    return cache;
+}
+
+bool GeometryCache::validate(const QByteArray& sourceHash)
+{
+    if (m_size < qint64(sizeof(Header))) return false;
+
+    m_header = reinterpret_cast<const Header*>(m_data);
+    if (std::memcmp(m_header->magic, Magic, sizeof(Magic)) != 0
+        || m_header->version != FormatVersion
+        || m_header->lodCount != LodCount
+        || sourceHash.size() != int(sizeof(m_header->sourceHash))
+        || std::memcmp(m_header->sourceHash, sourceHash.constData(), sizeof(m_header->sourceHash)) != 0) {
+        return false;
+    }
+
+    // Every section must lie inside the file and be aligned for direct access
+    auto sectionFits = [this](quint64 offset, quint64 count, quint64 itemSize) {
+        return offset % 8 == 0 && offset <= quint64(m_size)
+            && count <= (quint64(m_size) - offset) / itemSize;
+    };
+    if (!sectionFits(m_header->featuresOffset, m_header->featureCount, sizeof(FeatureRecord))
+        || !sectionFits(m_header->ringsOffset, m_header->ringCount, sizeof(Ring))
+        || !sectionFits(m_header->pointsOffset, m_header->pointCount, sizeof(Point))
+        || !sectionFits(m_header->stringsOffset, m_header->stringsSize, 1)) {
+        return false;
+    }
+
+    m_features = reinterpret_cast<const FeatureRecord*>(m_data + m_header->featuresOffset);
+    m_rings = reinterpret_cast<const Ring*>(m_data + m_header->ringsOffset);
+    m_points = reinterpret_cast<const Point*>(m_data + m_header->pointsOffset);
+    m_strings = reinterpret_cast<const char*>(m_data + m_header->stringsOffset);
+
+    // Range checks here keep the accessors free of them
+    for (quint32 i = 0; i < m_header->featureCount; ++i) {
+        const FeatureRecord& feature = m_features[i];
+        if (quint64(feature.nameOffset) + feature.nameLength > m_header->stringsSize
+            || quint64(feature.attributesOffset) + feature.attributesLength > m_header->stringsSize) {
+            return false;
+        }
+        for (int lod = 0; lod < LodCount; ++lod) {
+            if (quint64(feature.firstRing[lod]) + feature.ringCount[lod] > m_header->ringCount) {
+                return false;
+            }
+        }
+        m_bounds |= QRectF(QPointF(feature.minX, feature.minY), QPointF(feature.maxX, feature.maxY));
+    }
+    for (quint32 i = 0; i < m_header->ringCount; ++i) {
+        if (m_rings[i].firstPoint + m_rings[i].pointCount > m_header->pointCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GeometryCache::build(const QString& path, const QByteArray& sourceHash, const QVector<SourceFeature>& features)
+{
+    if (sourceHash.size() != int(sizeof(Header::sourceHash))) return false;
+
+    QVector<FeatureRecord> records;
+    QVector<Ring> rings;
+    QVector<Point> points;
+    QByteArray strings;
+    records.reserve(features.size());
+
+    auto appendString = [&strings](const QByteArray& bytes, quint32& offset, quint32& length) {
+        offset = quint32(strings.size());
+        length = quint32(bytes.size());
+        strings.append(bytes);
+    };
+
+    for (const SourceFeature& feature : features) {
+        FeatureRecord record = {};
+
+        // Project once; the levels of detail are generalized in world units
+        QVector<QPolygonF> worldRings;
+        worldRings.reserve(feature.rings.size());
+        QRectF bounds;
+        for (const QPolygonF& ring : feature.rings) {
+            QPolygonF worldRing;
+            worldRing.reserve(ring.size());
+            for (const QPointF& point : ring) {
+                worldRing << ViewTransform::projectToWorld(point);
+            }
+            bounds |= worldRing.boundingRect();
+            worldRings.append(worldRing);
+        }
+        record.minX = bounds.left();
+        record.minY = bounds.top();
+        record.maxX = bounds.right();
+        record.maxY = bounds.bottom();
+
+        for (int lod = 0; lod < LodCount; ++lod) {
+            record.firstRing[lod] = quint32(rings.size());
+            for (const QPolygonF& worldRing : worldRings) {
+                const QPolygonF simplified = simplify(worldRing, lodTolerance(lod));
+                if (simplified.size() < 4) continue; // Collapsed below a pixel at this level
+
+                rings.append(Ring{ quint64(points.size()), quint32(simplified.size()), 0 });
+                for (const QPointF& point : simplified) {
+                    points.append(Point{ point.x(), point.y() });
+                }
+            }
+            record.ringCount[lod] = quint32(rings.size()) - record.firstRing[lod];
+        }
+
+        appendString(feature.name.toUtf8(), record.nameOffset, record.nameLength);
+        appendString(QJsonDocument(feature.attributes).toJson(QJsonDocument::Compact),
+                     record.attributesOffset, record.attributesLength);
+        records.append(record);
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = FormatVersion;
+    header.lodCount = LodCount;
+    std::memcpy(header.sourceHash, sourceHash.constData(), sizeof(header.sourceHash));
+    header.featureCount = quint32(records.size());
+    header.ringCount = quint32(rings.size());
+    header.pointCount = quint64(points.size());
+    header.featuresOffset = align8(sizeof(Header));
+    header.ringsOffset = align8(header.featuresOffset + quint64(records.size()) * sizeof(FeatureRecord));
+    header.pointsOffset = align8(header.ringsOffset + quint64(rings.size()) * sizeof(Ring));
+    header.stringsOffset = align8(header.pointsOffset + quint64(points.size()) * sizeof(Point));
+    header.stringsSize = quint64(strings.size());
+    for (int lod = 0; lod < LodCount; ++lod) {
+        header.lodTolerance[lod] = lodTolerance(lod);
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Cannot write geometry cache" << path << ":" << file.errorString();
+        return false;
+    }
+
+    bool ok = file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == qint64(sizeof(header))
+        && writePadding(file) && writeSection(file, records)
+        && writePadding(file) && writeSection(file, rings)
+        && writePadding(file) && writeSection(file, points)
+        && writePadding(file) && file.write(strings) == strings.size();
+    if (!ok || !file.commit()) {
+        qDebug() << "Failed to write geometry cache" << path << ":" << file.errorString();
+        return false;
+    }
+
+    qDebug() << "Compiled geometry cache" << path << ":" << records.size() << "features,"
+             << rings.size() << "rings," << points.size() << "points";
+    return true;
+}
+
+int GeometryCache::featureCount() const
+{
+    return int(m_header->featureCount);
+}
+
+const GeometryCache::FeatureRecord& GeometryCache::record(int feature) const
+{
+    return m_features[feature];
+}
+
+QString GeometryCache::string(quint32 offset, quint32 length) const
+{
+    return QString::fromUtf8(m_strings + offset, int(length));
+}
+
+QRectF GeometryCache::featureBounds(int feature) const
+{
+    const FeatureRecord& r = record(feature);
+    return QRectF(QPointF(r.minX, r.minY), QPointF(r.maxX, r.maxY));
+}
+
+QString GeometryCache::featureName(int feature) const
+{
+    const FeatureRecord& r = record(feature);
+    return string(r.nameOffset, r.nameLength);
+}
+
+QJsonObject GeometryCache::featureAttributes(int feature) const
+{
+    const FeatureRecord& r = record(feature);
+    return QJsonDocument::fromJson(QByteArray::fromRawData(m_strings + r.attributesOffset,
+                                                           int(r.attributesLength))).object();
+}
+
+int GeometryCache::lodForZoom(int zoom) const
+{
+    const double worldPerPixel = 1.0 / double(1 << qBound(0, zoom, 30));
+    for (int lod = LodCount - 1; lod > 0; --lod) {
+        if (m_header->lodTolerance[lod] <= LodPixelTolerance * worldPerPixel) {
+            return lod;
+        }
+    }
+    return 0;
+}
+
+int GeometryCache::ringCount(int feature, int lod) const
+{
+    return int(record(feature).ringCount[lod]);
+}
+
+const GeometryCache::Ring& GeometryCache::ring(int feature, int lod, int index) const
+{
+    return m_rings[record(feature).firstRing[lod] + quint32(index)];
+}
+
+const GeometryCache::Point* GeometryCache::points(const Ring& ring) const
+{
+    return m_points + ring.firstPoint;
+}
+
+QRectF GeometryCache::bounds() const
+{
+    return m_bounds;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <QPolygonF>
+#include <QRectF>
+#include <QByteArray>
+#include <QJsonObject>
+#include <memory>
+
+/**
+ * @brief Read-only, memory-mapped polygon layer compiled from a vector file
+ *
+ * The file is a flat little-endian layout: a header, then fixed-size feature
+ * records, ring records, points and a UTF-8 string table, each section
+ * 8-byte aligned. Points are already projected to zoom-0 Web Mercator world
+ * coordinates (ViewTransform::projectToWorld), so rendering is a scale and a
+ * translation. Every feature carries its world bounding box, its name and
+ * attributes as compact JSON, and its exterior rings at LodCount levels of
+ * detail, from full resolution to Douglas-Peucker generalizations for
+ * progressively smaller zooms.
+ *
+ * Caches are keyed by a SHA-256 of the source file (and the shapefile
+ * sidecars), so an edited source is compiled again rather than served stale.
+ * Nothing is parsed on open; the header and section bounds are validated and
+ * all accessors read straight from the mapping.
+ */
+class GeometryCache {
+public:
+    static constexpr int LodCount = 4;
+    static constexpr quint32 FormatVersion = 1;
+
+    struct Point {
+        double x;
+        double y;
+    };
+
+    struct Ring {
+        quint64 firstPoint;
+        quint32 pointCount;
+        quint32 reserved;
+    };
+
+    // Input to build(); rings are exterior rings in longitude/latitude
+    struct SourceFeature {
+        QVector<QPolygonF> rings;
+        QString name;
+        QJsonObject attributes;
+    };
+
+    ~GeometryCache();
+
+    // Hash identifying the content of a vector source
+    static QByteArray hashSource(const QString& sourcePath);
+    static QString cacheFilePath(const QString& cacheDirectory, const QByteArray& sourceHash);
+
+    // Maps the cache; null when missing, corrupt, of another version or for another source hash
+    static std::shared_ptr<const GeometryCache> open(const QString& path, const QByteArray& sourceHash);
+    // Compiles features into path, replacing it atomically
+    static bool build(const QString& path, const QByteArray& sourceHash, const QVector<SourceFeature>& features);
+
+    int featureCount() const;
+    QRectF featureBounds(int feature) const;  // World coordinates
+    QString featureName(int feature) const;
+    QJsonObject featureAttributes(int feature) const;
+
+    // Coarsest level whose generalization stays under half a pixel at zoom
+    int lodForZoom(int zoom) const;
+    int ringCount(int feature, int lod) const;
+    const Ring& ring(int feature, int lod, int index) const;
+    const Point* points(const Ring& ring) const;
+
+    QRectF bounds() const;  // World bounds of all features
+    qint64 sizeBytes() const { return m_size; }
+
+private:
+    struct Header;
+    struct FeatureRecord;
+
+    GeometryCache() = default;
+    bool validate(const QByteArray& sourceHash);
+
+    const FeatureRecord& record(int feature) const;
+    QString string(quint32 offset, quint32 length) const;
+
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    qint64 m_size = 0;
+    const Header* m_header = nullptr;
+    const FeatureRecord* m_features = nullptr;
+    const Ring* m_rings = nullptr;
+    const Point* m_points = nullptr;
+    const char* m_strings = nullptr;
+    QRectF m_bounds;
+};
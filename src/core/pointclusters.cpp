@@ -0,0 +1,58 @@
+#include "pointclusters.h"
+#include <QHash>
+
+PointClusters::PointClusters(const QVector<Cluster>& points, int minZoom, int maxZoom, double radiusPx)
+    : m_minZoom(minZoom)
+    , m_maxZoom(qMax(minZoom, maxZoom))
+{
+    if (points.isEmpty()) return;
+
+    m_levels.resize(m_maxZoom - m_minZoom + 2);
+    m_levels.last().clusters = points;
+
+    // Each zoom merges the clusters of the zoom above, so a level costs its input size
+    for (int level = m_levels.size() - 2; level >= 0; --level) {
+        const double cellSize = radiusPx / double(1 << (m_minZoom + level));
+        const QVector<Cluster>& finer = m_levels[level + 1].clusters;
+        QVector<Cluster>& clusters = m_levels[level].clusters;
+        QHash<quint64, int> cellClusters;
+        cellClusters.reserve(finer.size());
+
+        for (const Cluster& child : finer) {
+            const quint64 key = (static_cast<quint64>(static_cast<quint32>(child.world.x() / cellSize)) << 32)
+                              | static_cast<quint32>(child.world.y() / cellSize);
+            auto cell = cellClusters.find(key);
+            if (cell == cellClusters.end()) {
+                cell = cellClusters.insert(key, clusters.size());
+                clusters.append(Cluster{QPointF(), 0, child.pointId});
+            }
+
+            // Sum of weighted positions until every child is in
+            Cluster& cluster = clusters[cell.value()];
+            cluster.world += child.world * child.count;
+            cluster.count += child.count;
+        }
+
+        for (Cluster& cluster : clusters) {
+            cluster.world /= cluster.count;
+        }
+    }
+
+    for (Level& level : m_levels) {
+        QVector<RTree<int>::Entry> entries;
+        entries.reserve(level.clusters.size());
+        for (int i = 0; i < level.clusters.size(); ++i) {
+            entries.append(RTree<int>::Entry{QRectF(level.clusters[i].world, level.clusters[i].world), i});
+        }
+        level.index.build(std::move(entries));
+    }
+}
+
+const PointClusters::Level* PointClusters::levelForZoom(int zoom) const
+{
+    if (m_levels.isEmpty()) return nullptr;
+
+    // Past the last clustered zoom every point stands on its own
+    const int index = qBound(0, qMin(zoom, m_maxZoom + 1) - m_minZoom, m_levels.size() - 1);
+    return &m_levels[index];
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "rtree.h"
+#include <QPointF>
+#include <QVector>
+
+/**
+ * @brief Grid clusters of weighted points for a range of zooms, built once and drawn many times
+ *
+ * The finest level holds the input points themselves; each coarser zoom merges
+ * the clusters of the zoom above into grid cells of radiusPx pixels, so building
+ * all levels is linear in the points per level. Every level keeps an R-tree over
+ * its cluster positions, so a frame only touches the clusters in view.
+ *
+ * Input points may already stand for several points (counts aggregated on the
+ * server); they are merged by weight like any other cluster. Nothing refers to
+ * outside state, so a set can be built on a worker thread and handed over whole.
+ */
+class PointClusters {
+public:
+    struct Cluster {
+        QPointF world;       // Zoom-0 Web Mercator; weighted centroid of the members
+        int count = 1;
+        qint64 pointId = 0;  // The only member when count is 1
+    };
+
+    struct Level {
+        QVector<Cluster> clusters;
+        RTree<int> index;
+    };
+
+    PointClusters() = default;
+    // Levels for zooms minZoom..maxZoom, then the unmerged points for every zoom past maxZoom
+    PointClusters(const QVector<Cluster>& points, int minZoom, int maxZoom, double radiusPx);
+
+    bool isEmpty() const { return m_levels.isEmpty(); }
+    int minZoom() const { return m_minZoom; }
+    int maxZoom() const { return m_maxZoom; }
+    int pointCount() const { return m_levels.isEmpty() ? 0 : m_levels.last().clusters.size(); }
+
+    // Zooms below minZoom get the coarsest level; null when there are no points
+    const Level* levelForZoom(int zoom) const;
+
+private:
+    QVector<Level> m_levels;
+    int m_minZoom = 0;
+    int m_maxZoom = 0;
+};
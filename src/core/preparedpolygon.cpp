@@ -0,0 +1,171 @@
+#include "preparedpolygon.h"
+#include <QtMath>
+
+PreparedPolygon::PreparedPolygon(const QPolygonF& polygon, int gridSize)
+{
+    build(QVector<QPolygonF>{polygon}, gridSize);
+}
+
+PreparedPolygon::PreparedPolygon(const QVector<QPolygonF>& rings, int gridSize)
+{
+    build(rings, gridSize);
+}
+
+bool PreparedPolygon::containsPoint(const QPointF& point) const
+{
+    int cell = cellAt(point);
+    if (cell < 0) {
+        return false;
+    }
+
+    switch (cellClass(cell)) {
+        case Inside:
+            return true;
+        case Outside:
+            return false;
+        default:
+            return crossingTest(point, cell / m_columns);
+    }
+}
+
+int PreparedPolygon::cellAt(const QPointF& point) const
+{
+    if (m_edges.isEmpty() ||
+        point.x() < m_bounds.left() || point.x() > m_bounds.right() ||
+        point.y() < m_bounds.top() || point.y() > m_bounds.bottom()) {
+        return -1;
+    }
+
+    return rowAt(point.y()) * m_columns + columnAt(point.x());
+}
+
+void PreparedPolygon::build(const QVector<QPolygonF>& rings, int gridSize)
+{
+    for (const QPolygonF& ring : rings) {
+        if (ring.size() < 3) continue;
+
+        for (int i = 0; i < ring.size(); ++i) {
+            const QPointF& a = ring[i];
+            const QPointF& b = ring[(i + 1) % ring.size()];
+            if (a != b) {
+                m_edges.append(Edge{a, b}); // Also closes rings that are not explicitly closed
+            }
+        }
+        m_bounds = m_bounds.isNull() ? ring.boundingRect() : m_bounds.united(ring.boundingRect());
+    }
+
+    if (m_edges.isEmpty()) {
+        return;
+    }
+
+    // Roughly one edge per cell keeps boundary cells cheap without a huge grid
+    if (gridSize <= 0) {
+        gridSize = qBound(4, static_cast<int>(qSqrt(m_edges.size())) * 2, 128);
+    }
+    m_columns = gridSize;
+    m_rows = gridSize;
+    m_cellWidth = qMax(m_bounds.width() / m_columns, 1e-12);
+    m_cellHeight = qMax(m_bounds.height() / m_rows, 1e-12);
+
+    // Bucket edges by row band for the crossing test
+    m_rowEdges.resize(m_rows);
+    for (int i = 0; i < m_edges.size(); ++i) {
+        const Edge& edge = m_edges[i];
+        int firstRow = rowAt(qMin(edge.a.y(), edge.b.y()));
+        int lastRow = rowAt(qMax(edge.a.y(), edge.b.y()));
+        for (int row = firstRow; row <= lastRow; ++row) {
+            m_rowEdges[row].append(i);
+        }
+    }
+
+    // Mark every cell an edge passes through as boundary
+    m_cellClasses.fill(Outside, m_columns * m_rows);
+    QVector<bool> boundary(m_columns * m_rows, false);
+    for (const Edge& edge : m_edges) {
+        int firstRow = rowAt(qMin(edge.a.y(), edge.b.y()));
+        int lastRow = rowAt(qMax(edge.a.y(), edge.b.y()));
+        int firstColumn = columnAt(qMin(edge.a.x(), edge.b.x()));
+        int lastColumn = columnAt(qMax(edge.a.x(), edge.b.x()));
+
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                int cell = row * m_columns + column;
+                if (boundary[cell]) continue;
+
+                QRectF cellRect(m_bounds.left() + column * m_cellWidth,
+                                m_bounds.top() + row * m_cellHeight,
+                                m_cellWidth, m_cellHeight);
+                if (edgeIntersectsRect(edge, cellRect)) {
+                    boundary[cell] = true;
+                }
+            }
+        }
+    }
+
+    // Cells without edges are uniformly inside or outside; one test at the center decides
+    for (int row = 0; row < m_rows; ++row) {
+        for (int column = 0; column < m_columns; ++column) {
+            int cell = row * m_columns + column;
+            if (boundary[cell]) {
+                m_cellClasses[cell] = Boundary;
+            } else {
+                QPointF center(m_bounds.left() + (column + 0.5) * m_cellWidth,
+                               m_bounds.top() + (row + 0.5) * m_cellHeight);
+                m_cellClasses[cell] = crossingTest(center, row) ? Inside : Outside;
+            }
+        }
+    }
+}
+
+bool PreparedPolygon::crossingTest(const QPointF& point, int row) const
+{
+    // Even-odd ray cast towards +x; only edges in this row band can cross the ray
+    bool inside = false;
+    for (int index : m_rowEdges[row]) {
+        const Edge& edge = m_edges[index];
+        if ((edge.a.y() > point.y()) != (edge.b.y() > point.y())) {
+            double crossX = edge.a.x() + (point.y() - edge.a.y()) * (edge.b.x() - edge.a.x()) / (edge.b.y() - edge.a.y());
+            if (point.x() < crossX) {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
+
+bool PreparedPolygon::edgeIntersectsRect(const Edge& edge, const QRectF& rect) const
+{
+    // Liang-Barsky clip of the segment against the rectangle
+    double t0 = 0.0, t1 = 1.0;
+    double dx = edge.b.x() - edge.a.x();
+    double dy = edge.b.y() - edge.a.y();
+
+    const double p[4] = { -dx, dx, -dy, dy };
+    const double q[4] = { edge.a.x() - rect.left(), rect.right() - edge.a.x(),
+                          edge.a.y() - rect.top(), rect.bottom() - edge.a.y() };
+
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0) return false; // Parallel and outside
+        } else {
+            double t = q[i] / p[i];
+            if (p[i] < 0.0) {
+                t0 = qMax(t0, t);
+            } else {
+                t1 = qMin(t1, t);
+            }
+            if (t0 > t1) return false;
+        }
+    }
+    return true;
+}
+
+int PreparedPolygon::rowAt(double y) const
+{
+    return qBound(0, static_cast<int>((y - m_bounds.top()) / m_cellHeight), m_rows - 1);
+}
+
+int PreparedPolygon::columnAt(double x) const
+{
+    return qBound(0, static_cast<int>((x - m_bounds.left()) / m_cellWidth), m_columns - 1);
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <QPolygonF>
+#include <QRectF>
+#include <QVector>
+
+/**
+ * @brief Point-in-polygon index built once and queried many times
+ *
+ * The bounding box is split into a uniform grid. Cells that no edge crosses are
+ * classified up front as fully inside or outside, so most queries are a single
+ * lookup. Points in boundary cells run an even-odd crossing test against only the
+ * edges overlapping their grid row. Multiple rings (holes, multi-part regions)
+ * are combined with the even-odd rule.
+ */
+class PreparedPolygon {
+public:
+    enum CellClass : quint8 {
+        Outside,
+        Inside,
+        Boundary
+    };
+
+    PreparedPolygon() = default;
+    explicit PreparedPolygon(const QPolygonF& polygon, int gridSize = 0);
+    explicit PreparedPolygon(const QVector<QPolygonF>& rings, int gridSize = 0);
+
+    bool isEmpty() const { return m_edges.isEmpty(); }
+    QRectF boundingRect() const { return m_bounds; }
+
+    bool containsPoint(const QPointF& point) const;
+
+    // Grid cell containing the point, or -1 outside the bounding box
+    int cellAt(const QPointF& point) const;
+    CellClass cellClass(int cell) const { return static_cast<CellClass>(m_cellClasses[cell]); }
+
+private:
+    struct Edge {
+        QPointF a;
+        QPointF b;
+    };
+
+    void build(const QVector<QPolygonF>& rings, int gridSize);
+    bool crossingTest(const QPointF& point, int row) const;
+    bool edgeIntersectsRect(const Edge& edge, const QRectF& rect) const;
+    int rowAt(double y) const;
+    int columnAt(double x) const;
+
+    QVector<Edge> m_edges;
+    QRectF m_bounds;
+    int m_columns = 0;
+    int m_rows = 0;
+    double m_cellWidth = 0.0;
+    double m_cellHeight = 0.0;
+    QVector<quint8> m_cellClasses;
+    QVector<QVector<int>> m_rowEdges; // Edge indices overlapping each row band
+};
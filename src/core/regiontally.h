@@ -0,0 +1,97 @@
+#pragma once
+#include <QHash>
+#include <QVector>
+
+/**
+ * @brief Which region each tracked item is in, with a running count per region
+ *
+ * Regions are indices into some feature store and -1 means outside all of
+ * them. Moving, adding or removing an item adjusts two counts at most, so
+ * the totals never need a full pass.
+ */
+template<typename Key>
+class RegionTally {
+public:
+    bool contains(const Key& key) const { return m_regions.contains(key); }
+    int regionOf(const Key& key) const { return m_regions.value(key, -1); }
+    int size() const { return m_regions.size(); }
+
+    int regionCount() const { return m_counts.size(); }
+    int count(int region) const { return region >= 0 && region < m_counts.size() ? m_counts[region] : 0; }
+
+    // Tracks the key if it is new; returns true if its region changed
+    bool assign(const Key& key, int region)
+    {
+        auto existing = m_regions.find(key);
+        if (existing == m_regions.end()) {
+            existing = m_regions.insert(key, -1);
+        }
+
+        const int previous = existing.value();
+        if (previous == region) return false;
+
+        existing.value() = region;
+        if (previous >= 0) --m_counts[previous];
+        if (region >= 0) ++m_counts[region];
+        return true;
+    }
+
+    // Returns false if the key was not tracked
+    bool remove(const Key& key)
+    {
+        auto existing = m_regions.find(key);
+        if (existing == m_regions.end()) return false;
+
+        if (existing.value() >= 0) {
+            --m_counts[existing.value()];
+        }
+        m_regions.erase(existing);
+        return true;
+    }
+
+    void clear()
+    {
+        m_regions.clear();
+        m_counts.fill(0);
+    }
+
+    // New set of regions: every tracked key is placed again by locate(key)
+    template<typename Locate>
+    void relocateAll(int regionCount, Locate locate)
+    {
+        m_counts.fill(0, regionCount);
+        for (auto it = m_regions.begin(); it != m_regions.end(); ++it) {
+            const int region = locate(it.key());
+            it.value() = region;
+            if (region >= 0) {
+                ++m_counts[region];
+            }
+        }
+    }
+
+    QVector<Key> keysIn(int region) const
+    {
+        QVector<Key> keys;
+        if (count(region) == 0) return keys;
+
+        keys.reserve(m_counts[region]);
+        for (auto it = m_regions.cbegin(); it != m_regions.cend(); ++it) {
+            if (it.value() == region) {
+                keys.append(it.key());
+            }
+        }
+        return keys;
+    }
+
+    template<typename Fn>
+    void forEachKey(Fn fn) const
+    {
+        for (auto it = m_regions.cbegin(); it != m_regions.cend(); ++it) {
+            fn(it.key());
+        }
+    }
+
+private:
+    QHash<Key, int> m_regions;  // Region per tracked key, -1 outside all
+    QVector<int> m_counts;      // Tracked keys per region
+};
@@ -0,0 +1,172 @@
+#pragma once
+#include <QRectF>
+#include <QPointF>
+#include <QVector>
+#include <QVarLengthArray>
+#include <QtMath>
+#include <algorithm>
+
+/**
+ * @brief Static R-tree over rectangles, bulk loaded with Sort-Tile-Recursive packing
+ *
+ * Built once from a full set of entries and queried many times. Rebuild it when
+ * the indexed set changes. Bounds tests are inclusive, so point and degenerate
+ * rectangles are found as expected.
+ */
+template<typename T>
+class RTree {
+public:
+    struct Entry {
+        QRectF bounds;
+        T value;
+    };
+
+    void build(QVector<Entry> entries);
+    void clear();
+
+    int size() const { return m_entries.size(); }
+    bool isEmpty() const { return m_entries.isEmpty(); }
+
+    // Calls func(value) for every entry whose bounds contain the point
+    template<typename Func>
+    void query(const QPointF& point, Func&& func) const
+    {
+        query(QRectF(point, point), std::forward<Func>(func));
+    }
+
+    // Calls func(value) for every entry whose bounds overlap the rectangle
+    template<typename Func>
+    void query(const QRectF& rect, Func&& func) const
+    {
+        if (m_root < 0) return;
+
+        QVarLengthArray<int, 128> stack;
+        stack.append(m_root);
+
+        while (!stack.isEmpty()) {
+            const Node& node = m_nodes[stack.last()];
+            stack.removeLast();
+            if (!overlaps(node.bounds, rect)) continue;
+
+            if (node.leaf) {
+                for (int i = node.first; i < node.first + node.count; ++i) {
+                    if (overlaps(m_entries[i].bounds, rect)) {
+                        func(m_entries[i].value);
+                    }
+                }
+            } else {
+                for (int i = node.first; i < node.first + node.count; ++i) {
+                    stack.append(i);
+                }
+            }
+        }
+    }
+
+private:
+    struct Node {
+        QRectF bounds;
+        int first = 0;   // First child node, or first entry for leaves
+        int count = 0;
+        bool leaf = false;
+    };
+
+    static constexpr int NodeCapacity = 16;
+
+    static bool overlaps(const QRectF& a, const QRectF& b)
+    {
+        return a.left() <= b.right() && b.left() <= a.right() &&
+               a.top() <= b.bottom() && b.top() <= a.bottom();
+    }
+
+    // QRectF::united() ignores empty rectangles, which would drop point entries
+    static QRectF unite(const QRectF& a, const QRectF& b)
+    {
+        return QRectF(QPointF(qMin(a.left(), b.left()), qMin(a.top(), b.top())),
+                      QPointF(qMax(a.right(), b.right()), qMax(a.bottom(), b.bottom())));
+    }
+
+    template<typename Item, typename BoundsOf>
+    static void sortTileRecursive(QVector<Item>& items, BoundsOf boundsOf);
+
+    QVector<Entry> m_entries;
+    QVector<Node> m_nodes;
+    int m_root = -1;
+};
+
+template<typename T>
+void RTree<T>::build(QVector<Entry> entries)
+{
+    clear();
+    if (entries.isEmpty()) return;
+
+    m_entries = std::move(entries);
+    sortTileRecursive(m_entries, [](const Entry& entry) { return entry.bounds; });
+
+    // Leaf level: consecutive runs of sorted entries
+    QVector<Node> level;
+    for (int i = 0; i < m_entries.size(); i += NodeCapacity) {
+        Node node;
+        node.first = i;
+        node.count = qMin(NodeCapacity, m_entries.size() - i);
+        node.leaf = true;
+        node.bounds = m_entries[i].bounds;
+        for (int j = i + 1; j < i + node.count; ++j) {
+            node.bounds = unite(node.bounds, m_entries[j].bounds);
+        }
+        level.append(node);
+    }
+
+    // Pack each level into parents until a single root remains
+    while (level.size() > 1) {
+        sortTileRecursive(level, [](const Node& node) { return node.bounds; });
+
+        int base = m_nodes.size();
+        m_nodes += level;
+
+        QVector<Node> parents;
+        for (int i = 0; i < level.size(); i += NodeCapacity) {
+            Node node;
+            node.first = base + i;
+            node.count = qMin(NodeCapacity, level.size() - i);
+            node.bounds = level[i].bounds;
+            for (int j = i + 1; j < i + node.count; ++j) {
+                node.bounds = unite(node.bounds, level[j].bounds);
+            }
+            parents.append(node);
+        }
+        level = parents;
+    }
+
+    m_root = m_nodes.size();
+    m_nodes.append(level.first());
+}
+
+template<typename T>
+void RTree<T>::clear()
+{
+    m_entries.clear();
+    m_nodes.clear();
+    m_root = -1;
+}
+
+template<typename T>
+template<typename Item, typename BoundsOf>
+void RTree<T>::sortTileRecursive(QVector<Item>& items, BoundsOf boundsOf)
+{
+    // Sort by x into vertical slices, then by y inside each slice
+    std::sort(items.begin(), items.end(), [&](const Item& a, const Item& b) {
+        return boundsOf(a).center().x() < boundsOf(b).center().x();
+    });
+
+    int leafCount = (items.size() + NodeCapacity - 1) / NodeCapacity;
+    int sliceCount = qMax(1, static_cast<int>(qCeil(qSqrt(leafCount))));
+    int sliceSize = sliceCount * NodeCapacity;
+
+    for (int start = 0; start < items.size(); start += sliceSize) {
+        auto first = items.begin() + start;
+        auto last = items.begin() + qMin(start + sliceSize, items.size());
+        std::sort(first, last, [&](const Item& a, const Item& b) {
+            return boundsOf(a).center().y() < boundsOf(b).center().y();
+        });
+    }
+}
@@ -0,0 +1,160 @@
+#include "trailbuffer.h"
+#include "configmanager.h"
+#include <QDebug>
+
+TrailPool& TrailPool::instance()
+{
+    static TrailPool instance;
+    return instance;
+}
+
+TrailPool::TrailPool()
+{
+    ConfigManager& config = ConfigManager::instance();
+    configure(config.getTrailMaxPoints(), config.getTrailPoolBlockSlots());
+}
+
+int TrailPool::slotCapacity() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_slotCapacity;
+}
+
+void TrailPool::configure(int slotCapacity, int slotsPerBlock)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_blocks.empty()) {
+        qWarning() << "TrailPool already allocated, ignoring reconfiguration";
+        return;
+    }
+
+    m_slotCapacity = qMax(2, slotCapacity);
+    m_slotsPerBlock = qMax(1, slotsPerBlock);
+}
+
+int TrailPool::acquireSlot(QPointF** data)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_freeSlots.isEmpty()) {
+        allocateBlock();
+    }
+
+    ++m_usedSlots;
+    const int slot = m_freeSlots.takeLast();
+    *data = slotData(slot);
+    return slot;
+}
+
+void TrailPool::releaseSlot(int slot)
+{
+    QMutexLocker locker(&m_mutex);
+    if (slot < 0 || slot >= slotCount()) return;
+
+    m_freeSlots.append(slot);
+    --m_usedSlots;
+}
+
+QPointF* TrailPool::slotData(int slot) const
+{
+    return m_blocks[slot / m_slotsPerBlock].get() + (slot % m_slotsPerBlock) * m_slotCapacity;
+}
+
+int TrailPool::allocatedSlots() const
+{
+    QMutexLocker locker(&m_mutex);
+    return slotCount();
+}
+
+int TrailPool::usedSlots() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_usedSlots;
+}
+
+qint64 TrailPool::memoryBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return slotBytes();
+}
+
+void TrailPool::allocateBlock()
+{
+    int firstSlot = slotCount();
+    m_blocks.emplace_back(new QPointF[static_cast<size_t>(m_slotsPerBlock) * m_slotCapacity]);
+
+    // Push in reverse so slots are handed out in ascending order
+    m_freeSlots.reserve(m_freeSlots.size() + m_slotsPerBlock);
+    for (int i = m_slotsPerBlock - 1; i >= 0; --i) {
+        m_freeSlots.append(firstSlot + i);
+    }
+
+    qDebug() << "TrailPool allocated block, total slots:" << slotCount()
+             << "memory:" << slotBytes() / 1024 << "KB";
+}
+
+TrailBuffer::~TrailBuffer()
+{
+    releaseSlot();
+}
+
+void TrailBuffer::setCapacity(int capacity)
+{
+    // Slots are sized once from trail.max_points; a longer trail cannot fit
+    const int slotCapacity = TrailPool::instance().slotCapacity();
+    if (capacity > slotCapacity) {
+        qWarning() << "Trail capacity" << capacity << "exceeds the pool slot size, clamped to"
+                   << slotCapacity << "(raise trail.max_points in aircraft.json)";
+    }
+    capacity = qBound(2, capacity, slotCapacity);
+    if (capacity != m_capacity) {
+        m_capacity = capacity;
+        clear();
+    }
+}
+
+void TrailBuffer::append(const QPointF& point)
+{
+    if (m_capacity == 0) {
+        setCapacity(TrailPool::instance().slotCapacity());
+    }
+    if (m_slot < 0) {
+        m_slot = TrailPool::instance().acquireSlot(&m_data);
+    }
+
+    m_data[m_head] = point;
+    m_head = (m_head + 1) % m_capacity;
+    if (m_size < m_capacity) {
+        ++m_size;
+    }
+    ++m_appended;
+}
+
+void TrailBuffer::clear()
+{
+    m_head = 0;
+    m_size = 0;
+    ++m_generation;
+}
+
+const QPointF& TrailBuffer::at(int index) const
+{
+    int start = (m_head - m_size + m_capacity) % m_capacity;
+    return m_data[(start + index) % m_capacity];
+}
+
+QVector<QPointF> TrailBuffer::toVector() const
+{
+    QVector<QPointF> points;
+    points.reserve(m_size);
+    forEach([&points](const QPointF& point) { points.append(point); });
+    return points;
+}
+
+void TrailBuffer::releaseSlot()
+{
+    if (m_slot >= 0) {
+        TrailPool::instance().releaseSlot(m_slot);
+        m_slot = -1;
+        m_data = nullptr;
+    }
+}
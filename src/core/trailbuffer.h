@@ -0,0 +1,110 @@
+#pragma once
+#include <QMutex>
+#include <QPointF>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Shared slab allocator for flight trail storage
+ *
+ * Every trail draws one fixed-size slot from a common pool. Slots are carved
+ * out of large blocks, so memory grows in predictable steps and released
+ * slots are recycled instead of going back to the heap.
+ *
+ * Aircraft are also built on pool threads while loading from the database,
+ * so the free list and block table are guarded by a mutex. Blocks are never
+ * freed or moved, which lets a buffer keep its slot's data pointer and read
+ * points without taking the lock.
+ */
+class TrailPool {
+public:
+    static TrailPool& instance();
+
+    // Number of points every slot can hold (fixed once the first block exists)
+    int slotCapacity() const;
+    void configure(int slotCapacity, int slotsPerBlock);
+
+    // Returns the slot and stores its data, valid until the slot is released
+    int acquireSlot(QPointF** data);
+    void releaseSlot(int slot);
+
+    // Statistics
+    int allocatedSlots() const;
+    int usedSlots() const;
+    qint64 memoryBytes() const;
+
+private:
+    TrailPool();
+    TrailPool(const TrailPool&) = delete;
+    TrailPool& operator=(const TrailPool&) = delete;
+
+    void allocateBlock();
+    int slotCount() const { return static_cast<int>(m_blocks.size()) * m_slotsPerBlock; }
+    qint64 slotBytes() const { return static_cast<qint64>(slotCount()) * m_slotCapacity * sizeof(QPointF); }
+    QPointF* slotData(int slot) const;
+
+    mutable QMutex m_mutex;
+    std::vector<std::unique_ptr<QPointF[]>> m_blocks;
+    QVector<int> m_freeSlots;
+    int m_slotCapacity = 50;
+    int m_slotsPerBlock = 256;
+    int m_usedSlots = 0;
+};
+
+/**
+ * @brief Fixed-capacity ring buffer of trail points backed by a TrailPool slot
+ *
+ * Appending is O(1) and overwrites the oldest point once the buffer is full.
+ * Points are read in place (oldest first) without copying.
+ */
+class TrailBuffer {
+public:
+    TrailBuffer() = default;
+    ~TrailBuffer();
+
+    TrailBuffer(const TrailBuffer&) = delete;
+    TrailBuffer& operator=(const TrailBuffer&) = delete;
+
+    // Clamped to 2..TrailPool::slotCapacity(), with a warning when a request is cut
+    void setCapacity(int capacity);
+    int capacity() const { return m_capacity; }
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    void append(const QPointF& point);
+    void clear();
+
+    // Index 0 is the oldest point still stored
+    const QPointF& at(int index) const;
+    const QPointF& last() const { return at(m_size - 1); }
+
+    // Total number of points ever appended; lets renderers detect new points
+    quint64 totalAppended() const { return m_appended; }
+    // Bumped whenever stored points are discarded outside of normal wrap-around
+    int generation() const { return m_generation; }
+
+    template<typename Func>
+    void forEach(Func&& func) const
+    {
+        if (m_size == 0) return;
+        int start = (m_head - m_size + m_capacity) % m_capacity;
+        for (int i = 0; i < m_size; ++i) {
+            func(m_data[(start + i) % m_capacity]);
+        }
+    }
+
+    QVector<QPointF> toVector() const;
+
+private:
+    void releaseSlot();
+
+    int m_slot = -1;      // Pool slot, acquired lazily on first append
+    QPointF* m_data = nullptr; // The slot's points
+    int m_capacity = 0;
+    int m_head = 0;       // Next write position
+    int m_size = 0;
+    quint64 m_appended = 0;
+    int m_generation = 0;
+};
@@ -86,6 +86,13 @@ double ViewTransform::pixelsPerMeter() const {
     return 1.0 / metersPerPixel();
 }
 
+QPointF ViewTransform::projectToWorld(const QPointF& geoPoint) {
+    double x = (geoPoint.x() + 180.0) / 360.0 * TILE_SIZE;
+    double latRad = geoPoint.y() * M_PI / 180.0;
+    double y = (1.0 - log(tan(latRad) + 1.0 / cos(latRad)) / M_PI) / 2.0 * TILE_SIZE;
+    return QPointF(x, y);
+}
+
 QPointF ViewTransform::geoToPixel(const QPointF& geoPoint) const {
     // Web Mercator projection
     double x = (geoPoint.x() + 180.0) / 360.0 * (1 << m_zoom) * TILE_SIZE;
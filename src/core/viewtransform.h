@@ -35,6 +35,9 @@ public:
     // Utility methods
     double metersPerPixel() const;
     double pixelsPerMeter() const;
+    
+    // Web Mercator projection at zoom 0 (world spans 0..TILE_SIZE pixels)
+    static QPointF projectToWorld(const QPointF& geoPoint);
 
 signals:
     void transformChanged();
@@ -0,0 +1,253 @@
+#include "wkbreader.h"
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+// Geometry type codes (OGC)
+constexpr quint32 WkbPolygonType = 3;
+constexpr quint32 WkbMultiPolygonType = 6;
+constexpr quint32 WkbGeometryCollectionType = 7;
+
+// PostGIS EWKB flags in the high bits of the type word
+constexpr quint32 EwkbZFlag = 0x80000000;
+constexpr quint32 EwkbMFlag = 0x40000000;
+constexpr quint32 EwkbSridFlag = 0x20000000;
+
+constexpr int MaxNestingDepth = 8;
+
+constexpr bool HostIsLittleEndian = (Q_BYTE_ORDER == Q_LITTLE_ENDIAN);
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void appendUInt32(QByteArray& out, quint32 value)
+{
+    value = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendRing(QByteArray& out, const QPolygonF& ring)
+{
+    appendUInt32(out, static_cast<quint32>(ring.size()));
+    if (HostIsLittleEndian) {
+        // QPointF is two contiguous doubles, the same layout as a WKB 2D point
+        out.append(reinterpret_cast<const char*>(ring.constData()),
+                   static_cast<int>(ring.size() * sizeof(QPointF)));
+        return;
+    }
+    for (const QPointF& point : ring) {
+        for (double ordinate : {point.x(), point.y()}) {
+            quint64 bits;
+            std::memcpy(&bits, &ordinate, sizeof(bits));
+            bits = qToLittleEndian(bits);
+            out.append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+        }
+    }
+}
+
+void appendPolygon(QByteArray& out, const WkbReader::Polygon& polygon)
+{
+    out.append(char(1)); // Little endian
+    appendUInt32(out, WkbPolygonType);
+    appendUInt32(out, static_cast<quint32>(polygon.size()));
+    for (const QPolygonF& ring : polygon) {
+        appendRing(out, ring);
+    }
+}
+
+} // namespace
+
+WkbReader::WkbReader(const char* data, std::size_t size)
+    : m_data(data)
+    , m_size(size)
+{
+}
+
+bool WkbReader::readPolygons(QVector<Polygon>& polygons)
+{
+    m_pos = 0;
+    return readGeometry(polygons, 0);
+}
+
+bool WkbReader::decodeByteaHex(const char* text, std::size_t length, QByteArray& buffer)
+{
+    // bytea hex output format: "\x" followed by two digits per byte
+    if (length < 2 || text[0] != '\\' || text[1] != 'x' || (length % 2) != 0) {
+        return false;
+    }
+
+    const std::size_t byteCount = (length - 2) / 2;
+    buffer.resize(static_cast<int>(byteCount)); // Keeps the allocation when shrinking
+    char* out = buffer.data();
+    const char* in = text + 2;
+
+    for (std::size_t i = 0; i < byteCount; ++i) {
+        int high = hexValue(in[2 * i]);
+        int low = hexValue(in[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        out[i] = static_cast<char>((high << 4) | low);
+    }
+    return true;
+}
+
+bool WkbReader::readGeometry(QVector<Polygon>& polygons, int depth)
+{
+    if (depth > MaxNestingDepth || m_pos >= m_size) {
+        return false;
+    }
+
+    const char byteOrder = m_data[m_pos++];
+    if (byteOrder != 0 && byteOrder != 1) {
+        return false;
+    }
+    const bool littleEndian = (byteOrder == 1);
+
+    quint32 typeWord;
+    if (!readUInt32(typeWord, littleEndian)) {
+        return false;
+    }
+
+    int dimensions = 2;
+    if (typeWord & EwkbZFlag) ++dimensions;
+    if (typeWord & EwkbMFlag) ++dimensions;
+    if (typeWord & EwkbSridFlag) {
+        quint32 srid;
+        if (!readUInt32(srid, littleEndian)) {
+            return false;
+        }
+    }
+
+    // ISO WKB encodes Z/M as thousands: 1000 Z, 2000 M, 3000 ZM
+    quint32 type = typeWord & 0x0FFFFFFF;
+    const quint32 isoDimensions = type / 1000;
+    type %= 1000;
+    if (isoDimensions == 1 || isoDimensions == 2) dimensions = qMax(dimensions, 3);
+    if (isoDimensions == 3) dimensions = 4;
+
+    switch (type) {
+    case WkbPolygonType: {
+        Polygon polygon;
+        if (!readPolygonBody(polygon, littleEndian, dimensions)) {
+            return false;
+        }
+        if (!polygon.isEmpty()) {
+            polygons.append(std::move(polygon));
+        }
+        return true;
+    }
+    case WkbMultiPolygonType:
+    case WkbGeometryCollectionType: {
+        quint32 count;
+        if (!readUInt32(count, littleEndian)) {
+            return false;
+        }
+        // Every member needs at least a header; reject counts the buffer cannot hold
+        if (count > (m_size - m_pos) / 5) {
+            return false;
+        }
+        polygons.reserve(polygons.size() + static_cast<int>(count));
+        for (quint32 i = 0; i < count; ++i) {
+            if (!readGeometry(polygons, depth + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+bool WkbReader::readPolygonBody(Polygon& polygon, bool littleEndian, int dimensions)
+{
+    quint32 ringCount;
+    if (!readUInt32(ringCount, littleEndian) || ringCount > (m_size - m_pos) / 4) {
+        return false;
+    }
+
+    polygon.resize(static_cast<int>(ringCount));
+    for (QPolygonF& ring : polygon) {
+        if (!readRing(ring, littleEndian, dimensions)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WkbReader::readRing(QPolygonF& ring, bool littleEndian, int dimensions)
+{
+    quint32 pointCount;
+    if (!readUInt32(pointCount, littleEndian)) {
+        return false;
+    }
+
+    const std::size_t pointBytes = static_cast<std::size_t>(dimensions) * sizeof(double);
+    if (pointCount > (m_size - m_pos) / pointBytes) {
+        return false;
+    }
+
+    ring.resize(static_cast<int>(pointCount));
+    const char* source = m_data + m_pos;
+
+    if (dimensions == 2 && littleEndian == HostIsLittleEndian) {
+        // Native 2D layout matches QPointF: one block copy into the polygon storage
+        std::memcpy(ring.data(), source, pointCount * pointBytes);
+    } else {
+        for (quint32 i = 0; i < pointCount; ++i) {
+            const char* point = source + i * pointBytes;
+            quint64 bits[2];
+            std::memcpy(bits, point, sizeof(bits));
+            if (littleEndian != HostIsLittleEndian) {
+                bits[0] = qbswap(bits[0]);
+                bits[1] = qbswap(bits[1]);
+            }
+            double x, y;
+            std::memcpy(&x, &bits[0], sizeof(x));
+            std::memcpy(&y, &bits[1], sizeof(y));
+            ring[static_cast<int>(i)] = QPointF(x, y);
+        }
+    }
+
+    m_pos += pointCount * pointBytes;
+    return true;
+}
+
+bool WkbReader::readUInt32(quint32& value, bool littleEndian)
+{
+    if (m_size - m_pos < sizeof(quint32)) {
+        return false;
+    }
+    value = littleEndian ? qFromLittleEndian<quint32>(m_data + m_pos)
+                         : qFromBigEndian<quint32>(m_data + m_pos);
+    m_pos += sizeof(quint32);
+    return true;
+}
+
+QByteArray WkbWriter::writePolygons(const QVector<WkbReader::Polygon>& polygons)
+{
+    QByteArray out;
+    if (polygons.isEmpty()) {
+        return out;
+    }
+
+    if (polygons.size() == 1) {
+        appendPolygon(out, polygons.first());
+        return out;
+    }
+
+    out.append(char(1));
+    appendUInt32(out, WkbMultiPolygonType);
+    appendUInt32(out, static_cast<quint32>(polygons.size()));
+    for (const WkbReader::Polygon& polygon : polygons) {
+        appendPolygon(out, polygon);
+    }
+    return out;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <QByteArray>
+#include <QPolygonF>
+#include <QVector>
+#include <cstddef>
+
+/**
+ * @brief Decoder for polygonal WKB and PostGIS EWKB geometry
+ *
+ * Reads the binary buffer in place and writes coordinates straight into
+ * QPolygonF storage; nothing is formatted or parsed as text. Polygon,
+ * MultiPolygon and GeometryCollections of those are supported, with holes.
+ * Z/M ordinates (ISO or EWKB flags) are skipped and an EWKB SRID is ignored.
+ */
+class WkbReader {
+public:
+    // Exterior ring followed by its holes
+    using Polygon = QVector<QPolygonF>;
+
+    WkbReader(const char* data, std::size_t size);
+
+    // Appends every polygon of the geometry; false on malformed or non-polygonal input
+    bool readPolygons(QVector<Polygon>& polygons);
+
+    // Decodes the text form of a bytea value ("\x0103...") into buffer, reusing its capacity
+    static bool decodeByteaHex(const char* text, std::size_t length, QByteArray& buffer);
+
+private:
+    bool readGeometry(QVector<Polygon>& polygons, int depth);
+    bool readPolygonBody(Polygon& polygon, bool littleEndian, int dimensions);
+    bool readRing(QPolygonF& ring, bool littleEndian, int dimensions);
+    bool readUInt32(quint32& value, bool littleEndian);
+
+    const char* m_data;
+    std::size_t m_size;
+    std::size_t m_pos = 0;
+};
+
+/**
+ * @brief Encoder producing ISO WKB for polygon geometry
+ *
+ * One polygon is written as a Polygon, several as a MultiPolygon.
+ */
+class WkbWriter {
+public:
+    static QByteArray writePolygons(const QVector<WkbReader::Polygon>& polygons);
+};
@@ -1,10 +1,13 @@
 #include "aircraftlayer.h"
 #include "../models/aircraft.h"
 #include "../models/polygonobject.h"
+#include "../managers/geofencemanager.h"
+#include "../managers/aircraftmanager.h"
 #include "../core/viewtransform.h"
 #include "../core/configmanager.h"
 #include <QPainter>
 #include <QMouseEvent>
+#include <QSet>
 #include <QDebug>
 
 AircraftLayer::AircraftLayer(QObject* parent)
@@ -73,9 +76,7 @@ void AircraftLayer::addAircraft(Aircraft* aircraft)
     
     m_aircrafts.append(aircraft);
     
-    // Connect signals
-    connect(aircraft, &Aircraft::positionChanged, 
-            this, &AircraftLayer::onAircraftPositionChanged);
+    // Position changes arrive batched through onTickCompleted()
     
     // Start movement if not already moving
     if (!aircraft->isMoving()) {
@@ -86,6 +87,30 @@ void AircraftLayer::addAircraft(Aircraft* aircraft)
     qDebug() << "Added aircraft to layer, total:" << m_aircrafts.size();
 }
 
+void AircraftLayer::addAircraftBatch(const QVector<Aircraft*>& aircraft)
+{
+    QSet<Aircraft*> known(m_aircrafts.cbegin(), m_aircrafts.cend());
+    int added = 0;
+    
+    for (Aircraft* ac : aircraft) {
+        if (!ac || known.contains(ac)) {
+            continue;
+        }
+        known.insert(ac);
+        m_aircrafts.append(ac);
+        ++added;
+        
+        if (!ac->isMoving()) {
+            ac->startMovement();
+        }
+    }
+    
+    if (added > 0) {
+        emit layerChanged();
+        qDebug() << "Added" << added << "aircraft to layer, total:" << m_aircrafts.size();
+    }
+}
+
 void AircraftLayer::removeAircraft(Aircraft* aircraft)
 {
     if (!aircraft) return;
@@ -99,6 +124,10 @@ void AircraftLayer::removeAircraft(Aircraft* aircraft)
     disconnect(aircraft, nullptr, this, nullptr);
     
     m_aircrafts.removeAll(aircraft);
+    m_regionCells.remove(aircraft);
+    if (m_geofenceManager) {
+        m_geofenceManager->removeAircraft(aircraft);
+    }
     emit layerChanged();
     
     qDebug() << "Removed aircraft from layer, remaining:" << m_aircrafts.size();
@@ -115,27 +144,65 @@ void AircraftLayer::clearAircrafts()
     
     m_selectedAircraft = nullptr;
     m_aircrafts.clear();
+    m_regionCells.clear();
+    if (m_geofenceManager) {
+        m_geofenceManager->clearAircraft();
+    }
     emit layerChanged();
     emit aircraftDeselected();
 }
 
 void AircraftLayer::setPolygonRegion(PolygonObject* polygon)
 {
+    if (m_polygonRegion) {
+        disconnect(m_polygonRegion, nullptr, this, nullptr);
+    }
+    
     m_polygonRegion = polygon;
-    updateAircraftStates();
+    
+    if (m_polygonRegion) {
+        connect(m_polygonRegion, &GeometryObject::objectChanged,
+                this, &AircraftLayer::onPolygonRegionChanged);
+    }
+    
+    onPolygonRegionChanged();
 }
 
-void AircraftLayer::onAircraftPositionChanged(const QPointF& newPosition)
+void AircraftLayer::setGeofenceManager(GeofenceManager* geofence)
 {
-    Aircraft* aircraft = qobject_cast<Aircraft*>(sender());
-    if (!aircraft) return;
+    if (m_geofenceManager) {
+        disconnect(m_geofenceManager, nullptr, this, nullptr);
+    }
+    
+    m_geofenceManager = geofence;
+    
+    if (m_geofenceManager) {
+        connect(m_geofenceManager, &GeofenceManager::regionsChanged,
+                this, &AircraftLayer::updateAircraftStates);
+    }
     
-    // Update aircraft state based on region
     updateAircraftStates();
+}
+
+void AircraftLayer::onTickCompleted(const AircraftTick& tick)
+{
+    // Only aircraft that moved need their region state re-evaluated
+    for (const AircraftTick::Change& change : tick.changes) {
+        if (change.fields & Aircraft::PositionDirty) {
+            updateAircraftState(change.aircraft);
+        }
+    }
     
     emit layerChanged();
 }
 
+void AircraftLayer::onPolygonRegionChanged()
+{
+    // Cached cells refer to the old polygon grid
+    m_regionCells.clear();
+    updateAircraftStates();
+}
+
 Aircraft* AircraftLayer::getAircraftAt(const QPointF& screenPoint, const ViewTransform& transform)
 {
     QPointF geoPoint = transform.screenToGeo(screenPoint);
@@ -158,6 +225,8 @@ void AircraftLayer::selectAircraft(Aircraft* aircraft)
     // Deselect previous aircraft
     if (m_selectedAircraft) {
         m_selectedAircraft->setSelected(false);
+        m_regionCells.remove(m_selectedAircraft);
+        updateAircraftState(m_selectedAircraft);
     }
     
     // Select new aircraft
@@ -175,6 +244,11 @@ void AircraftLayer::deselectAircraft()
 {
     if (m_selectedAircraft) {
         m_selectedAircraft->setSelected(false);
+        
+        // Selection reset the state to Normal; restore the region state
+        m_regionCells.remove(m_selectedAircraft);
+        updateAircraftState(m_selectedAircraft);
+        
         m_selectedAircraft = nullptr;
         emit aircraftDeselected();
         emit layerChanged();
@@ -184,20 +258,48 @@ void AircraftLayer::deselectAircraft()
 
 void AircraftLayer::updateAircraftStates()
 {
-    if (!m_polygonRegion) return;
-    
     for (Aircraft* aircraft : m_aircrafts) {
-        if (!aircraft) continue;
-        
-        bool inRegion = m_polygonRegion->containsPoint(aircraft->position());
-        
-        // Update state only if not selected (selected state takes priority)
+        if (aircraft) {
+            updateAircraftState(aircraft);
+        }
+    }
+}
+
+void AircraftLayer::updateAircraftState(Aircraft* aircraft)
+{
+    // Geofence memberships are tracked for every aircraft, selected or not
+    if (m_geofenceManager && m_geofenceManager->regionCount() > 0) {
+        bool inRegion = m_geofenceManager->updateAircraft(aircraft);
         if (aircraft->state() != Aircraft::Selected) {
-            Aircraft::State newState = inRegion ? Aircraft::InRegion : Aircraft::Normal;
-            if (aircraft->state() != newState) {
-                aircraft->setState(newState);
-                qDebug() << "Aircraft state changed to" << (inRegion ? "InRegion" : "Normal");
-            }
+            applyRegionState(aircraft, inRegion);
         }
+        return;
+    }
+    
+    if (!m_polygonRegion) return;
+    
+    // Selected state takes priority over region state
+    if (aircraft->state() == Aircraft::Selected) return;
+    
+    const PreparedPolygon& region = m_polygonRegion->prepared();
+    int cell = region.cellAt(aircraft->position());
+    
+    // Temporal coherence: same fully classified cell as last time means same answer
+    auto cached = m_regionCells.find(aircraft);
+    if (cached != m_regionCells.end() && cached.value() == cell &&
+        cell >= 0 && region.cellClass(cell) != PreparedPolygon::Boundary) {
+        return;
+    }
+    m_regionCells.insert(aircraft, cell);
+    
+    applyRegionState(aircraft, region.containsPoint(aircraft->position()));
+}
+
+void AircraftLayer::applyRegionState(Aircraft* aircraft, bool inRegion)
+{
+    Aircraft::State newState = inRegion ? Aircraft::InRegion : Aircraft::Normal;
+    if (aircraft->state() != newState) {
+        aircraft->setState(newState);
+        qDebug() << "Aircraft state changed to" << (inRegion ? "InRegion" : "Normal");
     }
 }
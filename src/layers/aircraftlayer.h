@@ -2,8 +2,11 @@
 #include "maplayer.h"
 #include "../models/aircraft.h"
 #include <QVector>
+#include <QHash>
 
 class PolygonObject;
+class GeofenceManager;
+struct AircraftTick;
 
 /**
  * @brief Layer for managing and rendering aircraft objects
@@ -20,6 +23,7 @@ public:
 
     // Aircraft management
     void addAircraft(Aircraft* aircraft);
+    void addAircraftBatch(const QVector<Aircraft*>& aircraft);
     void removeAircraft(Aircraft* aircraft);
     void clearAircrafts();
     
@@ -29,6 +33,14 @@ public:
     // Region management for state detection
     void setPolygonRegion(PolygonObject* polygon);
     PolygonObject* polygonRegion() const { return m_polygonRegion; }
+    
+    // When the geofence has regions, it decides InRegion instead of the single polygon
+    void setGeofenceManager(GeofenceManager* geofence);
+    GeofenceManager* geofenceManager() const { return m_geofenceManager; }
+
+public slots:
+    // Single pass over everything that changed during one AircraftManager tick
+    void onTickCompleted(const AircraftTick& tick);
 
 signals:
     void aircraftSelected(Aircraft* aircraft);
@@ -36,15 +48,22 @@ signals:
     void aircraftClicked(Aircraft* aircraft, const QPointF& position);
 
 private slots:
-    void onAircraftPositionChanged(const QPointF& newPosition);
+    void onPolygonRegionChanged();
 
 private:
     void updateAircraftStates();
+    void updateAircraftState(Aircraft* aircraft);
     Aircraft* getAircraftAt(const QPointF& screenPoint, const ViewTransform& transform);
+    void applyRegionState(Aircraft* aircraft, bool inRegion);
     void selectAircraft(Aircraft* aircraft);
     void deselectAircraft();
     
     QVector<Aircraft*> m_aircrafts;
     Aircraft* m_selectedAircraft = nullptr;
     PolygonObject* m_polygonRegion = nullptr;
+    GeofenceManager* m_geofenceManager = nullptr;
+    
+    // Last grid cell of the prepared region per aircraft; an aircraft still in the
+    // same fully inside/outside cell keeps its state without a new containment test
+    QHash<Aircraft*, int> m_regionCells;
 };
@@ -0,0 +1,225 @@
+#include "layerregistry.h"
+#include "vectorlayer.h"
+#include "ogrcelllayer.h"
+#include "postgislayer.h"
+#include "postgispointlayer.h"
+#include "../core/configmanager.h"
+#include <QColor>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+// Default z-orders when an entry has no "z_order": files below database tables
+constexpr int FileLayerBaseZ = 0;
+constexpr int PostgisLayerBaseZ = 100;
+constexpr int ZOrderStep = 10;
+
+} // namespace
+
+LayerRegistry::LayerRegistry(QObject* parent)
+    : QObject(parent)
+{
+}
+
+LayerRegistry::~LayerRegistry() = default;
+
+void LayerRegistry::loadFromConfig()
+{
+    m_layers.clear();
+
+    ConfigManager& config = ConfigManager::instance();
+    const QVector<QJsonObject> files = config.getShapefileConfigs();
+    for (int i = 0; i < files.size(); ++i) {
+        if (!files[i]["enabled"].toBool(true)) continue;
+        createFileLayer(files[i], FileLayerBaseZ + i * ZOrderStep);
+    }
+
+    const QVector<QJsonObject> tables = config.getPostgisLayerConfigs();
+    for (int i = 0; i < tables.size(); ++i) {
+        if (!tables[i]["enabled"].toBool(true)) continue;
+        createPostgisLayer(tables[i], PostgisLayerBaseZ + i * ZOrderStep);
+    }
+
+    sortLayers();
+    qDebug() << "Layer registry built" << m_layers.size() << "layers from data sources";
+    emit layersChanged();
+    emit repaintNeeded();
+}
+
+MapLayer* LayerRegistry::createFileLayer(const QJsonObject& config, int zOrder)
+{
+    const QString name = config["name"].toString(config["layer_name"].toString());
+    const QString path = config["path"].toString();
+    if (name.isEmpty() || path.isEmpty()) {
+        qWarning() << "Skipping data source without name or path:" << config;
+        return nullptr;
+    }
+
+    MapLayer* layer = addFileLayer(name, path, zOrder);
+    applyCommonSettings(layer, config, zOrder);
+    return layer;
+}
+
+MapLayer* LayerRegistry::createPostgisLayer(const QJsonObject& config, int zOrder)
+{
+    ConfigManager& settings = ConfigManager::instance();
+    if (config["geometry_type"].toString() == "point") {
+        return createPostgisPointLayer(config, zOrder);
+    }
+
+    const QString name = config["name"].toString(config["table"].toString());
+    const QString table = config["table"].toString(settings.getDatabasePolygonsTableName());
+
+    auto postgisLayer = std::make_unique<PostgisLayer>(
+        name, table,
+        config["geometry_column"].toString(settings.getDatabasePolygonsGeometryColumn()),
+        config["id_column"].toString(settings.getDatabasePolygonsIdColumn()));
+    if (config.contains("color")) {
+        postgisLayer->setColor(QColor(config["color"].toString()));
+    }
+
+    MapLayer* layer = addLayer(std::move(postgisLayer));
+    applyCommonSettings(layer, config, zOrder);
+    return layer;
+}
+
+MapLayer* LayerRegistry::createPostgisPointLayer(const QJsonObject& config, int zOrder)
+{
+    ConfigManager& settings = ConfigManager::instance();
+    const QString table = config["table"].toString(settings.getDatabasePointsTableName());
+    const QString name = config["name"].toString(table);
+
+    auto pointLayer = std::make_unique<PostgisPointLayer>(
+        name, table,
+        config["geometry_column"].toString(settings.getDatabasePointsGeometryColumn()),
+        config["id_column"].toString(settings.getDatabasePointsIdColumn()),
+        config["name_column"].toString(settings.getDatabasePointsNameColumn()));
+    if (config.contains("color")) {
+        pointLayer->setColor(QColor(config["color"].toString()));
+    }
+
+    MapLayer* layer = addLayer(std::move(pointLayer));
+    applyCommonSettings(layer, config, zOrder);
+    return layer;
+}
+
+void LayerRegistry::applyCommonSettings(MapLayer* layer, const QJsonObject& config, int zOrder)
+{
+    if (!layer) return;
+
+    layer->setZOrder(config["z_order"].toInt(zOrder));
+    layer->setVisible(config["visible"].toBool(true));
+    if (config.contains("opacity")) {
+        layer->setOpacity(config["opacity"].toDouble(1.0));
+    }
+    if (config.contains("color")) {
+        const QColor color(config["color"].toString());
+        if (auto* vectorLayer = qobject_cast<VectorLayer*>(layer)) {
+            vectorLayer->setColor(color);
+        } else if (auto* cellLayer = qobject_cast<OgrCellLayer*>(layer)) {
+            cellLayer->setColor(color);
+        }
+    }
+}
+
+MapLayer* LayerRegistry::addFileLayer(const QString& name, const QString& path, int zOrder)
+{
+    std::unique_ptr<MapLayer> layer;
+    if (OgrCellLayer::supportsPath(path)) {
+        layer = std::make_unique<OgrCellLayer>(name, path);
+    } else {
+        auto vectorLayer = std::make_unique<VectorLayer>(name, path);
+        connect(vectorLayer.get(), &VectorLayer::loadProgress, this, [this, name](qint64 read, qint64 total) {
+            emit loadProgress(name, read, total);
+        });
+        connect(vectorLayer.get(), &VectorLayer::loadFinished, this, [this, name](qint64 features, qint64 polygons) {
+            emit layerLoaded(name, features, polygons);
+        });
+        connect(vectorLayer.get(), &VectorLayer::loadFailed, this, [this, name](const QString& error) {
+            emit layerLoadFailed(name, error);
+        });
+        layer = std::move(vectorLayer);
+    }
+
+    layer->setZOrder(zOrder);
+    return addLayer(std::move(layer));
+}
+
+MapLayer* LayerRegistry::addLayer(std::unique_ptr<MapLayer> layer)
+{
+    // Replacing a layer destroys it, which cancels its loads
+    removeLayer(layer->name());
+
+    MapLayer* added = layer.get();
+    connect(added, &MapLayer::layerChanged, this, [this, added]() {
+        // A z-order change moves the layer; anything else only needs a repaint
+        auto it = std::find_if(m_layers.begin(), m_layers.end(),
+                               [added](const std::unique_ptr<MapLayer>& l) { return l.get() == added; });
+        if (it != m_layers.end()) {
+            const bool ordered = (it == m_layers.begin() || (*(it - 1))->zOrder() <= added->zOrder())
+                              && (it + 1 == m_layers.end() || added->zOrder() <= (*(it + 1))->zOrder());
+            if (!ordered) {
+                sortLayers();
+                emit layersChanged();
+            }
+        }
+        emit repaintNeeded();
+    });
+
+    m_layers.push_back(std::move(layer));
+    sortLayers();
+    emit layersChanged();
+    emit repaintNeeded();
+    return added;
+}
+
+bool LayerRegistry::removeLayer(const QString& name)
+{
+    auto it = std::find_if(m_layers.begin(), m_layers.end(),
+                           [&name](const std::unique_ptr<MapLayer>& layer) { return layer->name() == name; });
+    if (it == m_layers.end()) return false;
+
+    m_layers.erase(it);
+    emit layersChanged();
+    emit repaintNeeded();
+    return true;
+}
+
+MapLayer* LayerRegistry::layer(const QString& name) const
+{
+    for (const auto& layer : m_layers) {
+        if (layer->name() == name) {
+            return layer.get();
+        }
+    }
+    return nullptr;
+}
+
+QVector<MapLayer*> LayerRegistry::layers() const
+{
+    QVector<MapLayer*> result;
+    result.reserve(int(m_layers.size()));
+    for (const auto& layer : m_layers) {
+        result.append(layer.get());
+    }
+    return result;
+}
+
+void LayerRegistry::render(QPainter& painter, const ViewTransform& transform)
+{
+    for (const auto& layer : m_layers) {
+        if (layer->isVisible()) {
+            layer->render(painter, transform);
+        }
+    }
+}
+
+void LayerRegistry::sortLayers()
+{
+    // Stable, so equal z-orders keep configuration order
+    std::stable_sort(m_layers.begin(), m_layers.end(),
+                     [](const std::unique_ptr<MapLayer>& a, const std::unique_ptr<MapLayer>& b) {
+        return a->zOrder() < b->zOrder();
+    });
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "maplayer.h"
+#include <QObject>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+class ViewTransform;
+
+/**
+ * @brief Owns the data layers configured in data_sources.json and renders them in z-order
+ *
+ * Every enabled entry becomes one MapLayer: whole-file vector sources a
+ * VectorLayer, GeoPackage and FlatGeobuf sources an OgrCellLayer, PostGIS
+ * polygon tables a PostgisLayer and PostGIS point tables ("geometry_type":
+ * "point") a PostgisPointLayer. Each keeps its own cache and level-of-detail
+ * data. Disabled entries are not created at all, and layers only read data
+ * when rendered while visible, so a layer that is switched off costs nothing.
+ */
+class LayerRegistry : public QObject {
+    Q_OBJECT
+public:
+    explicit LayerRegistry(QObject* parent = nullptr);
+    ~LayerRegistry();
+
+    // Replaces all layers with those of the data_sources.json entries
+    void loadFromConfig();
+
+    // Takes ownership; a layer with the same name is replaced
+    MapLayer* addLayer(std::unique_ptr<MapLayer> layer);
+    // Vector file layer for path, an OgrCellLayer when the format has a spatial index
+    MapLayer* addFileLayer(const QString& name, const QString& path, int zOrder);
+    bool removeLayer(const QString& name);
+
+    MapLayer* layer(const QString& name) const;
+    QVector<MapLayer*> layers() const;  // Ascending z-order
+    template<typename T> QVector<T*> layersOfType() const;
+
+    // Draws visible layers, lowest z-order first
+    void render(QPainter& painter, const ViewTransform& transform);
+
+signals:
+    void layersChanged();   // Added, removed or reordered
+    void repaintNeeded();
+    // Progress of whole-file layers
+    void loadProgress(const QString& layerName, qint64 featuresRead, qint64 totalFeatures);
+    void layerLoaded(const QString& layerName, qint64 features, qint64 polygons);
+    void layerLoadFailed(const QString& layerName, const QString& error);
+
+private:
+    MapLayer* createFileLayer(const QJsonObject& config, int zOrder);
+    MapLayer* createPostgisLayer(const QJsonObject& config, int zOrder);
+    MapLayer* createPostgisPointLayer(const QJsonObject& config, int zOrder);
+    void applyCommonSettings(MapLayer* layer, const QJsonObject& config, int zOrder);
+    void sortLayers();
+
+    std::vector<std::unique_ptr<MapLayer>> m_layers;  // Kept sorted by z-order
+};
+
+template<typename T>
+QVector<T*> LayerRegistry::layersOfType() const
+{
+    QVector<T*> result;
+    for (const auto& layer : m_layers) {
+        if (T* typed = qobject_cast<T*>(layer.get())) {
+            result.append(typed);
+        }
+    }
+    return result;
+}
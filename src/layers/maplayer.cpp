@@ -12,6 +12,7 @@ void MapLayer::setVisible(bool visible)
 {
     if (m_visible != visible) {
         m_visible = visible;
+        emit visibilityChanged(visible);
         emit layerChanged();
     }
 }
@@ -21,6 +22,7 @@ void MapLayer::setOpacity(double opacity)
     opacity = qBound(0.0, opacity, 1.0);
     if (qAbs(m_opacity - opacity) > 0.001) {
         m_opacity = opacity;
+        emit opacityChanged(opacity);
         emit layerChanged();
     }
 }
@@ -32,3 +34,11 @@ void MapLayer::setName(const QString& name)
         emit layerChanged();
     }
 }
+
+void MapLayer::setZOrder(int order)
+{
+    if (m_zOrder != order) {
+        m_zOrder = order;
+        emit layerChanged();
+    }
+}
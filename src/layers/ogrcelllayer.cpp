@@ -0,0 +1,364 @@
+#include "ogrcelllayer.h"
+#include "../core/viewtransform.h"
+#include "../core/configmanager.h"
+#include "../core/cellgrid.h"
+#include <QFileInfo>
+#include <QPainter>
+#include <QPainterPath>
+#include <QDebug>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <gdal.h>
+#include <gdal_priv.h>
+#include <ogrsf_frmts.h>
+
+struct OgrCellLayer::Source {
+    GDALDataset* dataset = nullptr;
+    OGRLayer* layer = nullptr;
+    // Both null when the layer is already in WGS84 longitude/latitude
+    OGRCoordinateTransformation* toLayer = nullptr;
+    OGRCoordinateTransformation* toWgs84 = nullptr;
+
+    ~Source()
+    {
+        OGRCoordinateTransformation::DestroyCT(toLayer);
+        OGRCoordinateTransformation::DestroyCT(toWgs84);
+        if (dataset) {
+            GDALClose(dataset);
+        }
+    }
+};
+
+namespace {
+
+// Drops vertices within tolerance of the last kept one; the end point always stays
+QPolygonF thin(const OGRSimpleCurve* curve, double tolerance)
+{
+    QPolygonF points;
+    const int count = curve->getNumPoints();
+    points.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const QPointF point(curve->getX(i), curve->getY(i));
+        if (!points.isEmpty() && i != count - 1
+            && qAbs(point.x() - points.last().x()) < tolerance
+            && qAbs(point.y() - points.last().y()) < tolerance) {
+            continue;
+        }
+        points << point;
+    }
+    return points;
+}
+
+void collectParts(const OGRGeometry* geometry, double tolerance, QVector<QPolygonF>& rings, QVector<QPolygonF>& lines)
+{
+    switch (wkbFlatten(geometry->getGeometryType())) {
+    case wkbPolygon: {
+        const OGRPolygon* polygon = geometry->toPolygon();
+        for (int i = 0; i < polygon->getNumInteriorRings() + 1; ++i) {
+            const OGRLinearRing* ring = i == 0 ? polygon->getExteriorRing() : polygon->getInteriorRing(i - 1);
+            if (!ring) continue;
+            QPolygonF points = thin(ring, tolerance);
+            if (points.size() >= 4) {
+                rings.append(points);
+            } else if (i == 0) {
+                return; // Exterior collapsed below a pixel, so are its holes
+            }
+        }
+        break;
+    }
+    case wkbLineString: {
+        QPolygonF points = thin(geometry->toLineString(), tolerance);
+        if (points.size() >= 2) {
+            lines.append(points);
+        }
+        break;
+    }
+    case wkbMultiPolygon:
+    case wkbMultiLineString:
+    case wkbGeometryCollection: {
+        const OGRGeometryCollection* collection = geometry->toGeometryCollection();
+        for (int i = 0; i < collection->getNumGeometries(); ++i) {
+            collectParts(collection->getGeometryRef(i), tolerance, rings, lines);
+        }
+        break;
+    }
+    default:
+        break; // Points are not drawn by this layer
+    }
+}
+
+// Cell bounds in the layer's coordinates, from points sampled along the edges
+QRectF transformBounds(const QRectF& bounds, OGRCoordinateTransformation* transform)
+{
+    constexpr int Steps = 8;
+    double xs[4 * Steps];
+    double ys[4 * Steps];
+    for (int i = 0; i < Steps; ++i) {
+        const double t = double(i) / Steps;
+        xs[i] = bounds.left() + t * bounds.width();                 ys[i] = bounds.top();
+        xs[Steps + i] = bounds.right();                             ys[Steps + i] = bounds.top() + t * bounds.height();
+        xs[2 * Steps + i] = bounds.right() - t * bounds.width();    ys[2 * Steps + i] = bounds.bottom();
+        xs[3 * Steps + i] = bounds.left();                          ys[3 * Steps + i] = bounds.bottom() - t * bounds.height();
+    }
+
+    int success[4 * Steps];
+    transform->Transform(4 * Steps, xs, ys, nullptr, success);
+
+    double minX = std::numeric_limits<double>::max();
+    double minY = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest();
+    double maxY = std::numeric_limits<double>::lowest();
+    for (int i = 0; i < 4 * Steps; ++i) {
+        if (!success[i]) continue;
+        minX = qMin(minX, xs[i]);
+        minY = qMin(minY, ys[i]);
+        maxX = qMax(maxX, xs[i]);
+        maxY = qMax(maxY, ys[i]);
+    }
+    return minX <= maxX ? QRectF(QPointF(minX, minY), QPointF(maxX, maxY)) : QRectF();
+}
+
+} // namespace
+
+OgrCellLayer::OgrCellLayer(const QString& name, const QString& path, QObject* parent)
+    : MapLayer(name, parent)
+    , m_path(path)
+    , m_cache(qMax(16, ConfigManager::instance().getIndexedCellCacheSize()))
+{
+    static std::once_flag gdalRegistered;
+    std::call_once(gdalRegistered, []() { GDALAllRegister(); });
+
+    ConfigManager& config = ConfigManager::instance();
+    m_minCellZoom = config.getIndexedCellMinZoom();
+    m_maxCellZoom = qMax(m_minCellZoom, config.getIndexedCellMaxZoom());
+    m_maxFeaturesPerCell = qMax(1, config.getIndexedMaxFeaturesPerCell());
+    m_tolerancePx = qMax(0.0, config.getIndexedSimplifyTolerance());
+    m_workers.setMaxThreadCount(qMax(1, config.getIndexedFetchThreads()));
+
+    // A hidden layer keeps no features; reads still running are dropped on arrival
+    connect(this, &MapLayer::visibilityChanged, this, [this](bool visible) {
+        if (!visible) {
+            clear();
+        }
+    });
+}
+
+OgrCellLayer::~OgrCellLayer()
+{
+    // Workers touch the source list; once they are done every source is idle
+    m_workers.clear();
+    m_workers.waitForDone();
+    qDeleteAll(m_idleSources);
+}
+
+bool OgrCellLayer::supportsPath(const QString& path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    return suffix == "gpkg" || suffix == "fgb";
+}
+
+void OgrCellLayer::render(QPainter& painter, const ViewTransform& transform)
+{
+    if (!isVisible()) return;
+
+    const QRectF visible = transform.visibleBounds().normalized();
+    const int zoom = transform.zoom();
+    const int z = qMin(zoom, m_maxCellZoom);
+    const bool complete = requestVisibleCells(visible, zoom);
+
+    painter.save();
+    painter.setPen(QPen(m_color, 2));
+
+    // The last complete zoom stays underneath until this one has arrived
+    if (!complete && m_drawnZoom >= 0 && m_drawnZoom != z) {
+        drawFeatures(painter, m_cache.items(m_drawnZoom), visible, transform);
+    }
+    if (zoom >= m_minCellZoom) {
+        drawFeatures(painter, m_cache.items(z), visible, transform);
+        if (complete) {
+            m_drawnZoom = z;
+        }
+    }
+
+    painter.restore();
+}
+
+void OgrCellLayer::drawFeatures(QPainter& painter, const FeatureMap& features, const QRectF& visible,
+                                const ViewTransform& transform)
+{
+    auto toScreen = [&transform](const QPolygonF& geo) {
+        QPolygonF screen;
+        screen.reserve(geo.size());
+        for (const QPointF& point : geo) {
+            screen << transform.geoToScreen(point);
+        }
+        return screen;
+    };
+
+    for (const Feature& feature : features) {
+        if (!feature.bounds.intersects(visible)) continue;
+
+        if (!feature.rings.isEmpty()) {
+            QPainterPath path;
+            path.setFillRule(Qt::OddEvenFill);
+            for (const QPolygonF& ring : feature.rings) {
+                path.addPolygon(toScreen(ring));
+            }
+            painter.setOpacity(0.3 * opacity());
+            painter.fillPath(path, m_color);
+            painter.setOpacity(opacity());
+            painter.strokePath(path, painter.pen());
+        }
+
+        painter.setOpacity(opacity());
+        for (const QPolygonF& line : feature.lines) {
+            painter.drawPolyline(toScreen(line));
+        }
+    }
+}
+
+bool OgrCellLayer::handleMouseEvent(QMouseEvent* event, const ViewTransform& transform)
+{
+    Q_UNUSED(event)
+    Q_UNUSED(transform)
+    return false;
+}
+
+void OgrCellLayer::setColor(const QColor& color)
+{
+    if (m_color != color) {
+        m_color = color;
+        emit layerChanged();
+    }
+}
+
+void OgrCellLayer::clear()
+{
+    // Also bumps the cache generation, so reads still running are dropped on arrival
+    m_cache.clear();
+    m_drawnZoom = -1;
+    emit layerChanged();
+}
+
+bool OgrCellLayer::requestVisibleCells(const QRectF& visible, int zoom)
+{
+    // Zoomed out past the minimum a cell would cover too much of the file
+    if (zoom < m_minCellZoom) {
+        return false;
+    }
+
+    const int z = qMin(zoom, m_maxCellZoom);
+    return m_cache.requestVisible(visible, z, z, [this](quint64 key, int cellZoom, const QRectF& bounds) {
+        fetchCell(key, cellZoom, bounds);
+    });
+}
+
+void OgrCellLayer::fetchCell(quint64 key, int z, const QRectF& bounds)
+{
+    // Pixels shrink in longitude with latitude; use the cell's middle latitude
+    const double tolerance = CellGrid::toleranceForZoom(z, m_tolerancePx)
+                           * std::cos(qDegreesToRadians(bounds.center().y()));
+
+    // The destructor waits for the workers, so this stays valid while they run
+    m_cache.fetch(m_workers, this, key,
+        [this, bounds, tolerance](FeatureCache::Fetched& features) {
+            return readCell(bounds, tolerance, features);
+        },
+        [this]() { emit layerChanged(); });
+}
+
+OgrCellLayer::Source* OgrCellLayer::acquireSource()
+{
+    {
+        QMutexLocker locker(&m_sourceMutex);
+        if (!m_idleSources.isEmpty()) {
+            return m_idleSources.takeLast();
+        }
+        if (m_openFailed) {
+            return nullptr;
+        }
+    }
+
+    std::unique_ptr<Source> source(new Source());
+    source->dataset = static_cast<GDALDataset*>(
+        GDALOpenEx(m_path.toLocal8Bit().constData(), GDAL_OF_VECTOR | GDAL_OF_READONLY, nullptr, nullptr, nullptr));
+    source->layer = source->dataset ? source->dataset->GetLayer(0) : nullptr;
+    if (!source->layer) {
+        qDebug() << "Cannot open indexed vector source" << m_path << ":" << CPLGetLastErrorMsg();
+        QMutexLocker locker(&m_sourceMutex);
+        m_openFailed = true;
+        return nullptr;
+    }
+
+    if (!source->layer->TestCapability(OLCFastSpatialFilter)) {
+        qDebug() << "Vector source" << m_path << "has no spatial index; cell reads will scan it";
+    }
+
+    // Cells are requested in longitude/latitude; reproject when the layer is in another CRS
+    if (const OGRSpatialReference* layerSrs = source->layer->GetSpatialRef()) {
+        OGRSpatialReference wgs84;
+        wgs84.SetWellKnownGeogCS("WGS84");
+#if GDAL_VERSION_MAJOR >= 3
+        wgs84.SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+#endif
+        if (!layerSrs->IsSame(&wgs84)) {
+            source->toLayer = OGRCreateCoordinateTransformation(&wgs84, layerSrs);
+            source->toWgs84 = OGRCreateCoordinateTransformation(layerSrs, &wgs84);
+        }
+    }
+    return source.release();
+}
+
+void OgrCellLayer::releaseSource(Source* source)
+{
+    QMutexLocker locker(&m_sourceMutex);
+    m_idleSources.append(source);
+}
+
+bool OgrCellLayer::readCell(const QRectF& bounds, double tolerance, FeatureCache::Fetched& features)
+{
+    Source* source = acquireSource();
+    if (!source) return false;
+
+    OGRLayer* layer = source->layer;
+    const QRectF filter = source->toLayer ? transformBounds(bounds, source->toLayer) : bounds;
+    if (filter.isNull()) {
+        releaseSource(source);
+        return true; // The cell lies outside the layer CRS's area of use
+    }
+    layer->SetSpatialFilterRect(filter.left(), filter.top(), filter.right(), filter.bottom());
+    layer->ResetReading();
+
+    OGRFeature* feature;
+    while ((feature = layer->GetNextFeature()) != nullptr) {
+        OGRGeometry* geometry = feature->GetGeometryRef();
+        if (geometry && (!source->toWgs84 || geometry->transform(source->toWgs84) == OGRERR_NONE)) {
+            OGREnvelope envelope;
+            geometry->getEnvelope(&envelope);
+
+            // Smaller than the tolerance: nothing visible would be drawn
+            if (qMax(envelope.MaxX - envelope.MinX, envelope.MaxY - envelope.MinY) >= tolerance) {
+                Feature fetched;
+                // Padded so straight horizontal or vertical lines still intersect the view
+                const double pad = qMax(tolerance, 1e-9);
+                fetched.bounds = QRectF(QPointF(envelope.MinX - pad, envelope.MinY - pad),
+                                        QPointF(envelope.MaxX + pad, envelope.MaxY + pad));
+                collectParts(geometry, tolerance, fetched.rings, fetched.lines);
+                if (!fetched.rings.isEmpty() || !fetched.lines.isEmpty()) {
+                    features.append(qMakePair(qint64(feature->GetFID()), std::move(fetched)));
+                }
+            }
+        }
+        OGRFeature::DestroyFeature(feature);
+
+        if (features.size() >= m_maxFeaturesPerCell) {
+            qDebug() << "Cell of" << m_path << "truncated at" << features.size() << "features";
+            break;
+        }
+    }
+
+    layer->SetSpatialFilter(nullptr);
+    releaseSource(source);
+    return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "maplayer.h"
+#include "../core/cellgrid.h"
+#include <QColor>
+#include <QHash>
+#include <QMutex>
+#include <QPolygonF>
+#include <QRectF>
+#include <QThreadPool>
+#include <QVector>
+
+/**
+ * @brief Vector layer read lazily per viewport cell from a spatially indexed OGR source
+ *
+ * Meant for GeoPackage and FlatGeobuf files too large to load whole, such as
+ * country-scale roads or buildings. Visible cells (web map tiles at the view
+ * zoom, clamped to a configured range) are read on worker threads with
+ * OGRLayer::SetSpatialFilterRect(), so the file's R-tree selects the
+ * features and only those are parsed. Vertices closer than a fraction of a
+ * pixel at the cell zoom are dropped on the way in, as are features smaller
+ * than that.
+ *
+ * Caching is the CellCache PostgisLayer uses: cells are kept per (z, x, y)
+ * and evicted least recently used first, and features spanning several cells
+ * are stored once, keyed by FID. Each worker borrows its own dataset handle, because
+ * OGR datasets must not be shared between threads.
+ */
+class OgrCellLayer : public MapLayer {
+    Q_OBJECT
+public:
+    OgrCellLayer(const QString& name, const QString& path, QObject* parent = nullptr);
+    ~OgrCellLayer() override;
+
+    // GeoPackage and FlatGeobuf carry a spatial index OGR can filter with
+    static bool supportsPath(const QString& path);
+
+    // MapLayer interface
+    void render(QPainter& painter, const ViewTransform& transform) override;
+    bool handleMouseEvent(QMouseEvent* event, const ViewTransform& transform) override;
+
+    void setColor(const QColor& color);
+    QColor color() const { return m_color; }
+
+    QString path() const { return m_path; }
+    // Drop every cached cell and feature; visible cells are read again on the next render
+    void clear();
+    int cachedCellCount() const { return m_cache.cellCount(); }
+    int featureCount() const { return m_cache.itemCount(); }
+
+private:
+    struct Feature {
+        QVector<QPolygonF> rings;  // Polygon rings, exterior and holes; odd-even filled
+        QVector<QPolygonF> lines;
+        QRectF bounds;
+        int cellRefs = 0;
+    };
+
+    using FeatureCache = CellCache<Feature>;
+    using FeatureMap = FeatureCache::Items;
+
+    bool requestVisibleCells(const QRectF& visible, int zoom);
+    void fetchCell(quint64 key, int z, const QRectF& bounds);
+    void drawFeatures(QPainter& painter, const FeatureMap& features, const QRectF& visible,
+                      const ViewTransform& transform);
+
+    struct Source;
+
+    // Run on worker threads
+    bool readCell(const QRectF& bounds, double tolerance, FeatureCache::Fetched& features);
+    Source* acquireSource();
+    void releaseSource(Source* source);
+
+    QString m_path;
+    QColor m_color = QColor("#AA5500");
+
+    FeatureCache m_cache;   // Grouped per cell zoom; vertices are thinned per zoom
+    int m_drawnZoom = -1;
+
+    QThreadPool m_workers;
+
+    QMutex m_sourceMutex;
+    QVector<Source*> m_idleSources;
+    bool m_openFailed = false;  // Guarded by m_sourceMutex; the file is not retried
+
+    int m_minCellZoom;
+    int m_maxCellZoom;
+    int m_maxFeaturesPerCell;
+    double m_tolerancePx;
+};
@@ -0,0 +1,206 @@
+#include "postgislayer.h"
+#include "../core/viewtransform.h"
+#include "../core/configmanager.h"
+#include "../core/cellgrid.h"
+#include "../services/databaseservice.h"
+#include "../services/databasemetrics.h"
+#include "../services/preparedstatements.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QtMath>
+#include <QDebug>
+#include <pqxx/pqxx>
+
+namespace {
+
+QRectF partsBounds(const QVector<WkbReader::Polygon>& parts)
+{
+    QRectF bounds;
+    for (const WkbReader::Polygon& part : parts) {
+        // The exterior ring bounds its holes
+        QRectF ring = part.first().boundingRect();
+        bounds = bounds.isNull() ? ring : bounds.united(ring);
+    }
+    return bounds;
+}
+
+} // namespace
+
+PostgisLayer::PostgisLayer(const QString& name, const QString& tableName, const QString& geometryColumn,
+                           const QString& idColumn, QObject* parent)
+    : MapLayer(name, parent)
+    , m_tableName(tableName)
+    , m_geometryColumn(geometryColumn)
+    , m_idColumn(idColumn)
+    , m_cache(qMax(16, ConfigManager::instance().getPolygonCellCacheSize()))
+{
+    ConfigManager& config = ConfigManager::instance();
+    m_minCellZoom = config.getPolygonCellMinZoom();
+    m_maxCellZoom = qMax(m_minCellZoom, config.getPolygonCellMaxZoom());
+    m_tolerancePx = qMax(0.0, config.getPolygonSimplifyTolerance());
+
+    // Workers hold pooled connections while they run; keep them well under the pool size
+    m_workers.setMaxThreadCount(qBound(1, config.getPolygonFetchThreads(),
+                                       qMax(1, config.getDatabaseMaxConnections() / 2)));
+
+    // A hidden layer keeps no features and issues no queries
+    connect(this, &MapLayer::visibilityChanged, this, [this](bool visible) {
+        if (!visible) {
+            invalidate();
+        }
+    });
+}
+
+PostgisLayer::~PostgisLayer()
+{
+    // Pending results are delivered through a guarded pointer; just wait for the queries
+    m_workers.clear();
+    m_workers.waitForDone();
+}
+
+void PostgisLayer::render(QPainter& painter, const ViewTransform& transform)
+{
+    if (!isVisible()) return;
+
+    const QRectF visible = transform.visibleBounds().normalized();
+    const int zoom = transform.zoom();
+    const int z = qMin(zoom, m_maxCellZoom);
+    const bool complete = requestVisibleCells(visible, zoom);
+
+    painter.save();
+    painter.setPen(QPen(m_color, 3));
+
+    // Until the cells of this zoom have all arrived, the last complete
+    // generalization stays underneath so panning and zooming never blank the layer
+    if (!complete && m_drawnZoom >= 0 && m_drawnZoom != z) {
+        drawFeatures(painter, m_cache.items(m_drawnZoom), visible, transform);
+    }
+    if (zoom >= m_minCellZoom) {
+        drawFeatures(painter, m_cache.items(z), visible, transform);
+        if (complete) {
+            m_drawnZoom = z;
+        }
+    }
+
+    painter.restore();
+}
+
+void PostgisLayer::drawFeatures(QPainter& painter, const FeatureMap& features, const QRectF& visible,
+                                const ViewTransform& transform)
+{
+    for (const Feature& feature : features) {
+        if (!feature.bounds.intersects(visible)) continue;
+
+        // Holes and extra parts are subtracted by the odd-even fill
+        QPainterPath path;
+        path.setFillRule(Qt::OddEvenFill);
+        for (const WkbReader::Polygon& part : feature.parts) {
+            for (const QPolygonF& ring : part) {
+                QPolygonF screenRing;
+                screenRing.reserve(ring.size());
+                for (const QPointF& point : ring) {
+                    screenRing << transform.geoToScreen(point);
+                }
+                path.addPolygon(screenRing);
+            }
+        }
+
+        painter.setOpacity(0.3 * opacity());
+        painter.fillPath(path, m_color);
+        painter.setOpacity(opacity());
+        painter.strokePath(path, painter.pen());
+    }
+}
+
+bool PostgisLayer::handleMouseEvent(QMouseEvent* event, const ViewTransform& transform)
+{
+    Q_UNUSED(event)
+    Q_UNUSED(transform)
+    return false;
+}
+
+void PostgisLayer::setColor(const QColor& color)
+{
+    if (m_color != color) {
+        m_color = color;
+        emit layerChanged();
+    }
+}
+
+void PostgisLayer::invalidate()
+{
+    m_cache.clear();
+    m_drawnZoom = -1;
+    emit layerChanged();
+}
+
+bool PostgisLayer::requestVisibleCells(const QRectF& visible, int zoom)
+{
+    // Zoomed out past the minimum a cell would cover too much of the table
+    if (zoom < m_minCellZoom || !DatabaseService::instance().isAvailable()) {
+        return false;
+    }
+
+    const int z = qMin(zoom, m_maxCellZoom);
+    return m_cache.requestVisible(visible, z, z, [this](quint64 key, int cellZoom, const QRectF& bounds) {
+        fetchCell(key, cellZoom, bounds);
+    });
+}
+
+void PostgisLayer::fetchCell(quint64 key, int z, const QRectF& bounds)
+{
+    // Generalized for the cell zoom on the server; features below the tolerance are skipped
+    const QString sql = QString(R"(
+        SELECT id, ST_AsBinary(g) FROM (
+            SELECT %3::bigint AS id, ST_SimplifyPreserveTopology(%2, $5) AS g
+            FROM %1
+            WHERE %2 && ST_MakeEnvelope($1, $2, $3, $4, 4326)
+              AND GREATEST(ST_XMax(%2) - ST_XMin(%2), ST_YMax(%2) - ST_YMin(%2)) >= $5
+        ) generalized
+        WHERE NOT ST_IsEmpty(g)
+    )").arg(m_tableName, m_geometryColumn, m_idColumn);
+
+    // Pixels shrink in longitude with latitude; use the cell's middle latitude
+    const double tolerance = CellGrid::toleranceForZoom(z, m_tolerancePx)
+                           * std::cos(qDegreesToRadians(bounds.center().y()));
+
+    m_cache.fetch(m_workers, this, key,
+        [sql, bounds, tolerance](FeatureCache::Fetched& features) {
+            return queryCell(sql, bounds, tolerance, features);
+        },
+        [this]() { emit layerChanged(); });
+}
+
+bool PostgisLayer::queryCell(const QString& sql, const QRectF& bounds, double tolerance,
+                             FeatureCache::Fetched& features)
+{
+    try {
+        PooledConnection c = DatabaseService::instance().acquireConnection();
+        DatabaseMetrics::Timer metrics("postgis_cell");
+        pqxx::read_transaction txn(*c);
+
+        pqxx::result result = txn.exec_params(sql.toStdString(),
+            bounds.left(), bounds.top(), bounds.right(), bounds.bottom(), tolerance);
+        metrics.finish(static_cast<quint64>(result.size()), PreparedStatements::resultBytes(result));
+
+        features.reserve(static_cast<int>(result.size()));
+        QByteArray wkbBuffer;
+        for (const auto& row : result) {
+            if (row[0].is_null() || row[1].is_null()) continue;
+            // Text-format result (libpqxx 7 has no binary results): hex bytea, one decoding pass
+            if (!WkbReader::decodeByteaHex(row[1].c_str(), row[1].size(), wkbBuffer)) continue;
+
+            Feature feature;
+            WkbReader reader(wkbBuffer.constData(), static_cast<std::size_t>(wkbBuffer.size()));
+            if (!reader.readPolygons(feature.parts) || feature.parts.isEmpty()) continue;
+
+            feature.bounds = partsBounds(feature.parts);
+            features.append(qMakePair(row[0].as<qint64>(), std::move(feature)));
+        }
+        return true;
+
+    } catch (const std::exception &e) {
+        qDebug() << "PostGIS cell query failed:" << e.what();
+        return false;
+    }
+}
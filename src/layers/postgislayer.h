@@ -0,0 +1,78 @@
+#pragma once
+#include "maplayer.h"
+#include "../core/wkbreader.h"
+#include "../core/cellgrid.h"
+#include <QColor>
+#include <QHash>
+#include <QRectF>
+#include <QThreadPool>
+#include <QVector>
+
+/**
+ * @brief Polygon layer streamed from a PostGIS table per viewport
+ *
+ * The map is divided into cells (web map tiles at the view zoom, clamped to a
+ * configured range). Each visible cell is fetched once with a bounding box
+ * predicate (geom && ST_MakeEnvelope) so the GiST index does the filtering,
+ * on a worker thread. Geometry is generalized on the server for the cell zoom
+ * (ST_SimplifyPreserveTopology with a tolerance of a fraction of a pixel) and
+ * features smaller than that tolerance are not sent at all.
+ *
+ * Fetched cells stay cached per (z, x, y) in a CellCache until evicted least
+ * recently used first; features spanning several cells of a zoom are stored
+ * once, keyed by id.
+ */
+class PostgisLayer : public MapLayer {
+    Q_OBJECT
+public:
+    PostgisLayer(const QString& name, const QString& tableName, const QString& geometryColumn,
+                 const QString& idColumn, QObject* parent = nullptr);
+    ~PostgisLayer() override;
+
+    // MapLayer interface
+    void render(QPainter& painter, const ViewTransform& transform) override;
+    bool handleMouseEvent(QMouseEvent* event, const ViewTransform& transform) override;
+
+    void setColor(const QColor& color);
+    QColor color() const { return m_color; }
+
+    // Drop every cached cell and feature; the current view is fetched again
+    void invalidate();
+
+    int cachedCellCount() const { return m_cache.cellCount(); }
+    int featureCount() const { return m_cache.itemCount(); }
+
+private:
+    struct Feature {
+        QVector<WkbReader::Polygon> parts;
+        QRectF bounds;
+        int cellRefs = 0; // Cached cells that returned this feature
+    };
+
+    using FeatureCache = CellCache<Feature>;
+    using FeatureMap = FeatureCache::Items;
+
+    // Returns true once every visible cell of the zoom is loaded
+    bool requestVisibleCells(const QRectF& visible, int zoom);
+    void fetchCell(quint64 key, int z, const QRectF& bounds);
+    void drawFeatures(QPainter& painter, const FeatureMap& features, const QRectF& visible,
+                      const ViewTransform& transform);
+
+    // Runs on a worker thread
+    static bool queryCell(const QString& sql, const QRectF& bounds, double tolerance,
+                          FeatureCache::Fetched& features);
+
+    QString m_tableName;
+    QString m_geometryColumn;
+    QString m_idColumn;
+    QColor m_color = Qt::green;
+
+    FeatureCache m_cache;           // Grouped per cell zoom; geometry is generalized per zoom
+    int m_drawnZoom = -1;           // Last cell zoom whose visible cells were all loaded
+
+    QThreadPool m_workers;
+
+    int m_minCellZoom;
+    int m_maxCellZoom;
+    double m_tolerancePx;
+};
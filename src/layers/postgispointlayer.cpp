@@ -0,0 +1,316 @@
+#include "postgispointlayer.h"
+#include "../core/viewtransform.h"
+#include "../core/configmanager.h"
+#include "../core/cellgrid.h"
+#include "../services/databaseservice.h"
+#include "../services/databasemetrics.h"
+#include "../services/preparedstatements.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QPainter>
+#include <QPointer>
+#include <QtMath>
+#include <QDebug>
+#include <cmath>
+#include <pqxx/pqxx>
+
+PostgisPointLayer::PostgisPointLayer(const QString& name, const QString& tableName, const QString& geometryColumn,
+                                     const QString& idColumn, const QString& nameColumn, QObject* parent)
+    : MapLayer(name, parent)
+    , m_tableName(tableName)
+    , m_geometryColumn(geometryColumn)
+    , m_idColumn(idColumn)
+    , m_nameColumn(nameColumn)
+    , m_cache(qMax(16, ConfigManager::instance().getPointCellCacheSize()))
+{
+    ConfigManager& config = ConfigManager::instance();
+    m_minCellZoom = qMax(0, config.getPointCellMinZoom());
+    // Aggregate ids pack the cell address, zoom and row into 63 bits, which holds up to zoom 21
+    m_maxCellZoom = qBound(m_minCellZoom, config.getPointCellMaxZoom(), 21);
+    m_rowLimit = qMax(1, config.getDatabasePointsLimit());
+    m_clusterRadiusPx = qMax(1, config.getPointClusterRadius());
+    m_clusterMaxZoom = qMax(m_minCellZoom, config.getPointClusterMaxZoom());
+    m_aggregateMaxZoom = qMin(config.getPointAggregateMaxZoom(), m_clusterMaxZoom);
+
+    // Workers hold pooled connections while they run; keep them well under the pool size
+    m_workers.setMaxThreadCount(qBound(1, config.getPointFetchThreads(),
+                                       qMax(1, config.getDatabaseMaxConnections() / 2)));
+
+    // A hidden layer keeps no points and issues no queries
+    connect(this, &MapLayer::visibilityChanged, this, [this](bool visible) {
+        if (!visible) {
+            invalidate();
+        }
+    });
+}
+
+PostgisPointLayer::~PostgisPointLayer()
+{
+    // Pending results are delivered through a guarded pointer; just wait for the queries
+    m_workers.clear();
+    m_workers.waitForDone();
+}
+
+void PostgisPointLayer::render(QPainter& painter, const ViewTransform& transform)
+{
+    if (!isVisible()) return;
+
+    const int zoom = transform.zoom();
+    const bool complete = requestVisibleCells(transform.visibleBounds().normalized(), zoom);
+
+    // One build at a time, on the thread pool; until it is handed over the previous
+    // clusters are drawn. A new zoom's cells replace the old ones only once they have
+    // all arrived, so zooming never blanks the layer
+    const int group = groupForZoom(zoom);
+    const bool stale = group != m_clusteredGroup || m_cache.revision() != m_clusteredRevision;
+    if (stale && !m_clusterBuildRunning && (group == m_clusteredGroup || complete || !m_clusters)) {
+        startClusterBuild(group);
+    }
+
+    const PointClusters::Level* level = m_clusters ? m_clusters->levelForZoom(zoom) : nullptr;
+    if (!level || level->clusters.isEmpty()) return;
+
+    // World (zoom-0) units to screen pixels
+    const double scale = double(1 << zoom);
+    const QPointF halfView(transform.viewSize().width() / 2.0, transform.viewSize().height() / 2.0);
+    const QPointF centerWorld = ViewTransform::projectToWorld(transform.center());
+    const QPointF offset = halfView - centerWorld * scale;
+
+    // Markers reach past their centre; keep those just outside the view
+    const QPointF margin(m_clusterRadiusPx / scale, m_clusterRadiusPx / scale);
+    const QRectF visible(centerWorld - halfView / scale - margin, centerWorld + halfView / scale + margin);
+    const bool labels = zoom > m_clusterMaxZoom;
+
+    painter.save();
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setOpacity(opacity());
+    QFont font = painter.font();
+    font.setBold(true);
+    painter.setFont(font);
+
+    level->index.query(visible, [&](int index) {
+        const Cluster& cluster = level->clusters[index];
+        drawCluster(painter, cluster, cluster.world * scale + offset, labels);
+    });
+
+    painter.restore();
+}
+
+void PostgisPointLayer::drawCluster(QPainter& painter, const Cluster& cluster, const QPointF& screen, bool labels)
+{
+    if (cluster.count == 1) {
+        painter.setPen(QPen(Qt::white, 1.5));
+        painter.setBrush(m_color);
+        painter.drawEllipse(screen, 5.0, 5.0);
+
+        if (labels) {
+            const PointCache::Items& points = m_cache.items(PointGroup);
+            auto point = points.constFind(cluster.pointId);
+            if (point != points.cend() && !point->name.isEmpty()) {
+                painter.setPen(m_color.darker(150));
+                painter.drawText(screen + QPointF(8, 4), point->name);
+            }
+        }
+        return;
+    }
+
+    // Grows with the order of magnitude, capped so neighbouring clusters stay apart
+    const double radius = qMin(m_clusterRadiusPx / 2.0, 10.0 + 4.0 * std::log10(double(cluster.count)));
+    painter.setPen(QPen(Qt::white, 2));
+    painter.setBrush(m_color);
+    painter.drawEllipse(screen, radius, radius);
+
+    const QString text = cluster.count >= 1000
+        ? QString("%1k").arg(cluster.count / 1000.0, 0, 'f', cluster.count >= 10000 ? 0 : 1)
+        : QString::number(cluster.count);
+    painter.setPen(Qt::white);
+    painter.drawText(QRectF(screen.x() - radius, screen.y() - radius, 2 * radius, 2 * radius),
+                     Qt::AlignCenter, text);
+}
+
+bool PostgisPointLayer::handleMouseEvent(QMouseEvent* event, const ViewTransform& transform)
+{
+    Q_UNUSED(event)
+    Q_UNUSED(transform)
+    return false;
+}
+
+void PostgisPointLayer::setColor(const QColor& color)
+{
+    if (m_color != color) {
+        m_color = color;
+        emit layerChanged();
+    }
+}
+
+void PostgisPointLayer::invalidate()
+{
+    // A build still running was started from the old cache; its result is dropped
+    m_cache.clear();
+    m_clusters.reset();
+    m_clusteredGroup = NoGroup;
+    emit layerChanged();
+}
+
+int PostgisPointLayer::groupForZoom(int zoom) const
+{
+    const int z = qMin(zoom, m_maxCellZoom);
+    return z <= m_aggregateMaxZoom ? z : PointGroup;
+}
+
+void PostgisPointLayer::startClusterBuild(int group)
+{
+    m_clusteredGroup = group;
+    m_clusteredRevision = m_cache.revision();
+
+    const PointCache::Items& items = m_cache.items(group);
+    if (items.isEmpty()) {
+        m_clusters.reset();
+        return;
+    }
+
+    // Copying the leaves is all the GUI thread does
+    QVector<Cluster> leaves;
+    leaves.reserve(items.size());
+    for (auto it = items.cbegin(); it != items.cend(); ++it) {
+        leaves.append(Cluster{it->world, it->count, it.key()});
+    }
+
+    // Point cells feed every zoom past the aggregated ones; an aggregated cell only its own
+    const int minZoom = group == PointGroup ? qMax(m_minCellZoom, m_aggregateMaxZoom + 1) : group;
+    const int maxZoom = group == PointGroup ? m_clusterMaxZoom : group;
+    const double radiusPx = m_clusterRadiusPx;
+    const int generation = m_cache.generation();
+    const QString layerName = name();
+    QPointer<PostgisPointLayer> guard(this);
+    m_clusterBuildRunning = true;
+
+    QThreadPool::globalInstance()->start([guard, leaves, minZoom, maxZoom, radiusPx, generation, layerName]() {
+        QElapsedTimer timer;
+        timer.start();
+        auto clusters = std::make_shared<const PointClusters>(leaves, minZoom, maxZoom, radiusPx);
+        qDebug() << "Clustered" << leaves.size() << "items of" << layerName << "into"
+                 << clusters->levelForZoom(minZoom)->clusters.size() << "clusters at zoom" << minZoom
+                 << "in" << timer.elapsed() << "ms";
+
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, clusters, generation]() {
+            if (!guard) return;
+            guard->m_clusterBuildRunning = false;
+            if (generation == guard->m_cache.generation()) {
+                guard->m_clusters = clusters;
+            }
+            // Draws the new set, and starts the next build if the cache moved on meanwhile
+            emit guard->layerChanged();
+        }, Qt::QueuedConnection);
+    });
+}
+
+bool PostgisPointLayer::requestVisibleCells(const QRectF& visible, int zoom)
+{
+    // Zoomed out past the minimum a cell would cover too much of the table
+    if (zoom < m_minCellZoom || !DatabaseService::instance().isAvailable()) {
+        return false;
+    }
+
+    const int z = qMin(zoom, m_maxCellZoom);
+    return m_cache.requestVisible(visible, z, groupForZoom(zoom), [this](quint64 key, int cellZoom, const QRectF& bounds) {
+        fetchCell(key, cellZoom, bounds);
+    });
+}
+
+void PostgisPointLayer::fetchCell(quint64 key, int z, const QRectF& bounds)
+{
+    CellQuery query;
+    query.pointsSql = QString(R"(
+        SELECT %3::bigint, ST_X(%2), ST_Y(%2), %4::text
+        FROM %1
+        WHERE %2 && ST_MakeEnvelope($1, $2, $3, $4, 4326)
+        LIMIT $5
+    )").arg(m_tableName, m_geometryColumn, m_idColumn, m_nameColumn);
+
+    // One weighted centroid per grid cell; the half-open bounds put a point on a
+    // cell edge in one cell only, so no count is taken twice
+    query.aggregateSql = QString(R"(
+        SELECT count(*), avg(ST_X(%2)), avg(ST_Y(%2))
+        FROM %1
+        WHERE %2 && ST_MakeEnvelope($1, $2, $3, $4, 4326)
+          AND ST_X(%2) >= $1 AND ST_X(%2) < $3
+          AND ST_Y(%2) >= $2 AND ST_Y(%2) < $4
+        GROUP BY ST_SnapToGrid(%2, $5)
+    )").arg(m_tableName, m_geometryColumn);
+
+    query.bounds = bounds;
+    query.z = z;
+    query.x = static_cast<int>((key >> 24) & 0xFFFFFF);
+    query.y = static_cast<int>(key & 0xFFFFFF);
+    query.aggregate = z <= m_aggregateMaxZoom;
+    query.limit = m_rowLimit;
+    // Half the cluster grid of the cell zoom; merging on this side settles the final clusters
+    query.gridSize = CellGrid::toleranceForZoom(z, m_clusterRadiusPx / 2.0);
+
+    m_cache.fetch(m_workers, this, key,
+        [query](PointCache::Fetched& points) { return queryCell(query, points); },
+        [this]() { emit layerChanged(); });
+}
+
+bool PostgisPointLayer::queryCell(const CellQuery& query, PointCache::Fetched& points)
+{
+    try {
+        PooledConnection c = DatabaseService::instance().acquireConnection();
+        pqxx::read_transaction txn(*c);
+        const QRectF& bounds = query.bounds;
+
+        if (!query.aggregate) {
+            DatabaseMetrics::Timer metrics("postgis_points_cell");
+            // One row past the limit tells a cell that is too dense from one that holds exactly the limit
+            pqxx::result result = txn.exec_params(query.pointsSql.toStdString(),
+                bounds.left(), bounds.top(), bounds.right(), bounds.bottom(), query.limit + 1);
+            metrics.finish(static_cast<quint64>(result.size()), PreparedStatements::resultBytes(result));
+
+            if (static_cast<int>(result.size()) <= query.limit) {
+                points.reserve(static_cast<int>(result.size()));
+                for (const auto& row : result) {
+                    if (row[0].is_null() || row[1].is_null() || row[2].is_null()) continue;
+
+                    // Projected here, off the GUI thread
+                    Point point;
+                    point.world = ViewTransform::projectToWorld(QPointF(row[1].as<double>(), row[2].as<double>()));
+                    if (!row[3].is_null()) {
+                        point.name = QString::fromStdString(row[3].as<std::string>());
+                    }
+                    points.append(qMakePair(row[0].as<qint64>(), std::move(point)));
+                }
+                return true;
+            }
+
+            // Counts for the whole cell rather than an arbitrary subset of its points
+            qDebug() << "Point cell at zoom" << query.z << "holds more than" << query.limit
+                     << "points, fetching counts instead";
+        }
+
+        DatabaseMetrics::Timer metrics("postgis_points_aggregate");
+        pqxx::result result = txn.exec_params(query.aggregateSql.toStdString(),
+            bounds.left(), bounds.top(), bounds.right(), bounds.bottom(), query.gridSize);
+        metrics.finish(static_cast<quint64>(result.size()), PreparedStatements::resultBytes(result));
+
+        // Negative, so never a table id; the cell address keeps cells apart and the
+        // low 16 bits number the rows of one cell
+        const qint64 cellBase = (((qint64(query.x) << query.z) | query.y) * 32 + query.z) << 16;
+        points.reserve(static_cast<int>(result.size()));
+        int rowNumber = 0;
+        for (const auto& row : result) {
+            if (row[0].is_null() || row[1].is_null() || row[2].is_null()) continue;
+            if (++rowNumber > 0xFFFF) break;
+
+            Point point;
+            point.count = row[0].as<int>();
+            point.world = ViewTransform::projectToWorld(QPointF(row[1].as<double>(), row[2].as<double>()));
+            points.append(qMakePair(-(cellBase + rowNumber), std::move(point)));
+        }
+        return true;
+
+    } catch (const std::exception &e) {
+        qDebug() << "PostGIS point cell query failed:" << e.what();
+        return false;
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include "maplayer.h"
+#include "../core/cellgrid.h"
+#include "../core/pointclusters.h"
+#include <QColor>
+#include <QHash>
+#include <QPointF>
+#include <QRectF>
+#include <QThreadPool>
+#include <QVector>
+#include <memory>
+
+/**
+ * @brief Point layer streamed from a PostGIS table per viewport and drawn as grid clusters
+ *
+ * Cells are fetched exactly like PostgisLayer fetches polygons (bounding box
+ * predicate on a worker thread, the same CellCache). Up to aggregate_max_zoom a
+ * cell is fetched as counts: the server groups its points by ST_SnapToGrid at
+ * the cluster grid of the cell zoom and sends one weighted centroid per group,
+ * so the rows per cell stay bounded however dense the table is. Finer cells
+ * fetch the points themselves, shared between cells and zooms by id; a cell
+ * holding more than the row limit is fetched as counts instead of being cut off.
+ *
+ * Clusters (see PointClusters) are rebuilt on the global thread pool when the
+ * cached items change; frames keep drawing the previous set until the new one
+ * is handed over, so paint events never pay for a rebuild.
+ */
+class PostgisPointLayer : public MapLayer {
+    Q_OBJECT
+public:
+    PostgisPointLayer(const QString& name, const QString& tableName, const QString& geometryColumn,
+                      const QString& idColumn, const QString& nameColumn, QObject* parent = nullptr);
+    ~PostgisPointLayer() override;
+
+    // MapLayer interface
+    void render(QPainter& painter, const ViewTransform& transform) override;
+    bool handleMouseEvent(QMouseEvent* event, const ViewTransform& transform) override;
+
+    void setColor(const QColor& color);
+    QColor color() const { return m_color; }
+
+    // Drop every cached cell, point and cluster; the current view is fetched again
+    void invalidate();
+
+    int cachedCellCount() const { return m_cache.cellCount(); }
+    int pointCount() const { return m_cache.itemCount(); }
+
+private:
+    struct Point {
+        QPointF world;  // Zoom-0 Web Mercator
+        QString name;
+        int count = 1;  // Points a server-side aggregate stands for
+        int cellRefs = 0;
+    };
+
+    using PointCache = CellCache<Point>;
+    using Cluster = PointClusters::Cluster;
+
+    // Points do not depend on the cell zoom, so every point cell shares one group;
+    // aggregated cells are grouped by their zoom (>= 0)
+    static constexpr int PointGroup = -1;
+    static constexpr int NoGroup = -2;
+
+    struct CellQuery {
+        QString pointsSql;
+        QString aggregateSql;
+        QRectF bounds;
+        int z = 0;
+        int x = 0;
+        int y = 0;
+        bool aggregate = false;
+        int limit = 0;
+        double gridSize = 0.0;  // Degrees
+    };
+
+    int groupForZoom(int zoom) const;
+    // Returns true once every visible cell is loaded
+    bool requestVisibleCells(const QRectF& visible, int zoom);
+    void fetchCell(quint64 key, int z, const QRectF& bounds);
+
+    void startClusterBuild(int group);
+    void drawCluster(QPainter& painter, const Cluster& cluster, const QPointF& screen, bool labels);
+
+    // Runs on a worker thread
+    static bool queryCell(const CellQuery& query, PointCache::Fetched& points);
+
+    QString m_tableName;
+    QString m_geometryColumn;
+    QString m_idColumn;
+    QString m_nameColumn;
+    QColor m_color = QColor("#D35400");
+
+    PointCache m_cache;
+    std::shared_ptr<const PointClusters> m_clusters;
+    int m_clusteredGroup = NoGroup;     // Cache group and revision m_clusters was built from
+    quint64 m_clusteredRevision = 0;
+    bool m_clusterBuildRunning = false;
+
+    QThreadPool m_workers;
+
+    int m_minCellZoom;
+    int m_maxCellZoom;
+    int m_rowLimit;
+    double m_clusterRadiusPx;
+    int m_clusterMaxZoom;
+    int m_aggregateMaxZoom;
+};
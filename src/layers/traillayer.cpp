@@ -0,0 +1,258 @@
+#include "traillayer.h"
+#include "aircraftlayer.h"
+#include "../models/aircraft.h"
+#include "../core/viewtransform.h"
+#include "../core/configmanager.h"
+#include <QPainter>
+#include <QSet>
+#include <QTimer>
+#include <QDebug>
+#include <cmath>
+
+TrailLayer::TrailLayer(AircraftLayer* aircraftLayer, QObject* parent)
+    : MapLayer("Trail Layer", parent)
+    , m_aircraftLayer(aircraftLayer)
+    , m_decayTimer(new QTimer(this))
+{
+    ConfigManager& config = ConfigManager::instance();
+    m_decayFactor = qBound(0, qRound(config.getTrailFadeFactor() * 255.0), 254);
+
+    // Rounded blending leaves the faintest pixels at a few alpha levels for good;
+    // a rebuild once the newest segment would have faded out clears that residue
+    const double stepFactor = m_decayFactor / 255.0;
+    m_residueSteps = stepFactor > 0.0
+        ? qMax(1, static_cast<int>(std::ceil(std::log(1.0 / (MAX_TRAIL_ALPHA * 255.0)) / std::log(stepFactor))))
+        : 1;
+
+    connect(m_decayTimer, &QTimer::timeout, this, &TrailLayer::decayOverlay);
+    m_decayTimer->start(config.getTrailFadeInterval());
+    m_clock.start();
+
+    // Nothing to fade while hidden; the rebuild on return applies the elapsed decay
+    connect(this, &MapLayer::visibilityChanged, this, [this](bool visible) {
+        if (visible) {
+            m_needsRebuild = true;
+            m_decayTimer->start();
+        } else {
+            m_decayTimer->stop();
+        }
+    });
+}
+
+void TrailLayer::render(QPainter& painter, const ViewTransform& transform)
+{
+    if (!isVisible() || !m_aircraftLayer) return;
+
+    if (m_needsRebuild || viewChanged(transform)) {
+        rebuild(transform);
+    } else {
+        rasterizeNewSegments(transform);
+    }
+
+    // One blit per frame regardless of the number of trails
+    painter.save();
+    painter.setOpacity(opacity());
+    painter.drawImage(0, 0, m_overlay);
+    painter.restore();
+}
+
+bool TrailLayer::handleMouseEvent(QMouseEvent* event, const ViewTransform& transform)
+{
+    Q_UNUSED(event)
+    Q_UNUSED(transform)
+    return false; // Trails are not interactive
+}
+
+void TrailLayer::invalidate()
+{
+    m_needsRebuild = true;
+    emit layerChanged();
+}
+
+void TrailLayer::removeAircraft(const Aircraft* aircraft)
+{
+    if (m_trailStates.remove(aircraft) > 0) {
+        disconnect(aircraft, &QObject::destroyed, this, nullptr);
+        m_needsRebuild = true;
+    }
+}
+
+TrailLayer::TrailState& TrailLayer::stateFor(const Aircraft* aircraft)
+{
+    auto state = m_trailStates.find(aircraft);
+    if (state == m_trailStates.end()) {
+        state = m_trailStates.insert(aircraft, TrailState());
+
+        // Deleted without removeAircraft(): a new aircraft at the same address must start fresh
+        connect(aircraft, &QObject::destroyed, this, [this, aircraft]() {
+            m_trailStates.remove(aircraft);
+        });
+    }
+    return state.value();
+}
+
+bool TrailLayer::viewChanged(const ViewTransform& transform) const
+{
+    return transform.zoom() != m_viewZoom
+        || transform.viewSize() != m_viewSize
+        || transform.center() != m_viewCenter;
+}
+
+void TrailLayer::rebuild(const ViewTransform& transform)
+{
+    m_viewCenter = transform.center();
+    m_viewZoom = transform.zoom();
+    m_viewSize = transform.viewSize();
+    m_needsRebuild = false;
+    m_stepsSinceRebuild = 0;
+
+    if (m_overlay.size() != m_viewSize) {
+        m_overlay = QImage(m_viewSize, QImage::Format_ARGB32_Premultiplied);
+    }
+    m_overlay.fill(Qt::transparent);
+
+    // States of aircraft no longer in the layer are dropped here at the latest
+    const QVector<Aircraft*> aircrafts = m_aircraftLayer->aircrafts();
+    const QSet<const Aircraft*> current(aircrafts.cbegin(), aircrafts.cend());
+    for (const Aircraft* tracked : m_trailStates.keys()) {
+        if (!current.contains(tracked)) {
+            m_trailStates.remove(tracked);
+            disconnect(tracked, &QObject::destroyed, this, nullptr);
+        }
+    }
+
+    QPainter painter(&m_overlay);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    const qint64 now = m_clock.elapsed();
+    for (Aircraft* aircraft : aircrafts) {
+        if (!aircraft) continue;
+
+        const TrailBuffer& trail = aircraft->trail();
+        TrailState& state = stateFor(aircraft);
+        if (state.generation != trail.generation()) {
+            state.generation = trail.generation();
+            state.drawnUpTo = trail.totalAppended() - trail.size();
+        }
+        markSeen(state, trail, now);
+
+        if (aircraft->isTrailEnabled() && trail.size() > 1) {
+            drawAgedTrail(painter, aircraft, state, transform, now);
+        }
+    }
+}
+
+void TrailLayer::rasterizeNewSegments(const ViewTransform& transform)
+{
+    const qint64 now = m_clock.elapsed();
+    QPainter painter(&m_overlay);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    for (Aircraft* aircraft : m_aircraftLayer->aircrafts()) {
+        if (!aircraft) continue;
+
+        const TrailBuffer& trail = aircraft->trail();
+        TrailState& state = stateFor(aircraft);
+
+        if (state.generation != trail.generation()) {
+            // Trail was cleared; older pixels fade out with the rest of the layer
+            state.generation = trail.generation();
+            state.drawnUpTo = trail.totalAppended() - trail.size();
+        }
+
+        quint64 newPoints = trail.totalAppended() - state.drawnUpTo;
+        if (newPoints == 0) continue;
+        markSeen(state, trail, now);
+
+        if (!aircraft->isTrailEnabled() || trail.size() < 2) continue;
+
+        // Start one point earlier so the first new segment connects to the old trail
+        int firstIndex = qMax(0, trail.size() - 1 - static_cast<int>(qMin<quint64>(newPoints, trail.size())));
+        drawTrail(painter, aircraft, transform, firstIndex);
+    }
+}
+
+void TrailLayer::drawTrail(QPainter& painter, const Aircraft* aircraft, const ViewTransform& transform, int firstIndex)
+{
+    const TrailBuffer& trail = aircraft->trail();
+
+    QPolygonF screenPoints;
+    screenPoints.reserve(trail.size() - firstIndex);
+    for (int i = firstIndex; i < trail.size(); ++i) {
+        screenPoints << transform.geoToScreen(trail.at(i));
+    }
+
+    QColor trailColor = aircraft->getStateColor();
+    trailColor.setAlphaF(MAX_TRAIL_ALPHA);
+    painter.setPen(QPen(trailColor, 2));
+    painter.drawPolyline(screenPoints);
+}
+
+void TrailLayer::drawAgedTrail(QPainter& painter, const Aircraft* aircraft, const TrailState& state,
+                               const ViewTransform& transform, qint64 now)
+{
+    const TrailBuffer& trail = aircraft->trail();
+    const quint64 first = trail.totalAppended() - trail.size();
+    const int interval = qMax(1, m_decayTimer->interval());
+    const double stepFactor = m_decayFactor / 255.0;
+
+    // Consecutive segments of equal alpha share one polyline; a trail spans only a few steps
+    QColor trailColor = aircraft->getStateColor();
+    QPolygonF run;
+    int runAlpha = -1;
+    auto flush = [&]() {
+        if (run.size() > 1 && runAlpha > 0) {
+            trailColor.setAlpha(runAlpha);
+            painter.setPen(QPen(trailColor, 2));
+            painter.drawPolyline(run);
+        }
+        run.clear();
+    };
+
+    QPointF previous = transform.geoToScreen(trail.at(0));
+    for (int i = 1; i < trail.size(); ++i) {
+        const QPointF current = transform.geoToScreen(trail.at(i));
+
+        // A segment is as old as the point that ended it; whole decay steps, as decayOverlay() applies them
+        const qint64 steps = (now - state.seenAtMs[int((first + i) % quint64(trail.capacity()))]) / interval;
+        const int alpha = static_cast<int>(MAX_TRAIL_ALPHA * 255.0 * std::pow(stepFactor, double(steps)));
+        if (alpha != runAlpha) {
+            flush();
+            runAlpha = alpha;
+            run << previous;
+        }
+        run << current;
+        previous = current;
+    }
+    flush();
+}
+
+void TrailLayer::markSeen(TrailState& state, const TrailBuffer& trail, qint64 now)
+{
+    if (state.seenAtMs.size() != trail.capacity()) {
+        state.seenAtMs.fill(now, trail.capacity());
+    }
+
+    // Points appended since the last call were first drawn now
+    const quint64 firstStored = trail.totalAppended() - trail.size();
+    for (quint64 index = qMax(state.drawnUpTo, firstStored); index < trail.totalAppended(); ++index) {
+        state.seenAtMs[int(index % quint64(trail.capacity()))] = now;
+    }
+    state.drawnUpTo = trail.totalAppended();
+}
+
+void TrailLayer::decayOverlay()
+{
+    if (m_overlay.isNull()) return;
+
+    // One composited fill scales every premultiplied channel by the step factor
+    QPainter painter(&m_overlay);
+    painter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
+    painter.fillRect(m_overlay.rect(), QColor(0, 0, 0, m_decayFactor));
+    painter.end();
+
+    if (++m_stepsSinceRebuild >= m_residueSteps) {
+        m_needsRebuild = true;
+    }
+    emit layerChanged();
+}
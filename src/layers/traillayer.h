@@ -0,0 +1,76 @@
+#pragma once
+#include "maplayer.h"
+#include <QElapsedTimer>
+#include <QImage>
+#include <QHash>
+#include <QPointF>
+#include <QSize>
+#include <QVector>
+
+class AircraftLayer;
+class Aircraft;
+class TrailBuffer;
+class QTimer;
+
+/**
+ * @brief Persistent raster overlay for aircraft flight trails
+ *
+ * Trails are drawn into an off-screen image that survives between frames.
+ * Each frame only the segments added since the previous frame are rasterized,
+ * and the whole image fades periodically instead of using per-segment alpha.
+ * The image is rebuilt from the trail buffers only when the view pans or zooms;
+ * the rebuild draws each segment at the alpha the decay steps since it was
+ * first drawn would have left it at, so a pan does not revive faded trails.
+ */
+class TrailLayer : public MapLayer {
+    Q_OBJECT
+public:
+    explicit TrailLayer(AircraftLayer* aircraftLayer, QObject* parent = nullptr);
+
+    // MapLayer interface
+    void render(QPainter& painter, const ViewTransform& transform) override;
+    bool handleMouseEvent(QMouseEvent* event, const ViewTransform& transform) override;
+
+    // Discard the overlay and redraw all trails on the next frame
+    void invalidate();
+
+    // Forget an aircraft leaving the map; its pixels go with the next rebuild
+    void removeAircraft(const Aircraft* aircraft);
+
+private slots:
+    void decayOverlay();
+
+private:
+    struct TrailState {
+        quint64 drawnUpTo = 0; // TrailBuffer::totalAppended() at last rasterization
+        int generation = 0;
+        QVector<qint64> seenAtMs; // When each stored point was first drawn, by totalAppended() % capacity
+    };
+
+    TrailState& stateFor(const Aircraft* aircraft);
+    bool viewChanged(const ViewTransform& transform) const;
+    void rebuild(const ViewTransform& transform);
+    void rasterizeNewSegments(const ViewTransform& transform);
+    void drawTrail(QPainter& painter, const Aircraft* aircraft, const ViewTransform& transform, int firstIndex);
+    void drawAgedTrail(QPainter& painter, const Aircraft* aircraft, const TrailState& state,
+                       const ViewTransform& transform, qint64 now);
+    static void markSeen(TrailState& state, const TrailBuffer& trail, qint64 now);
+
+    AircraftLayer* m_aircraftLayer;
+    QImage m_overlay;
+    QHash<const Aircraft*, TrailState> m_trailStates;
+
+    // View state the overlay was rasterized for
+    QPointF m_viewCenter;
+    int m_viewZoom = -1;
+    QSize m_viewSize;
+    bool m_needsRebuild = true;
+
+    QTimer* m_decayTimer;
+    QElapsedTimer m_clock;
+    int m_decayFactor = 230; // Alpha multiplier out of 255 applied per decay step
+    int m_residueSteps = 1;  // Decay steps after which a rebuild clears rounding residue
+    int m_stepsSinceRebuild = 0;
+
+    static constexpr double MAX_TRAIL_ALPHA = 0.8; // Newest segments; decay fades them from there
+};
@@ -0,0 +1,134 @@
+#include "vectorlayer.h"
+#include "../core/viewtransform.h"
+#include <QPainter>
+
+VectorLayer::VectorLayer(const QString& name, const QString& path, QObject* parent)
+    : MapLayer(name, parent)
+    , m_path(path)
+{
+    // Switched off costs nothing: no reads, no mapping, no batches
+    connect(this, &MapLayer::visibilityChanged, this, [this](bool visible) {
+        if (!visible) {
+            unload();
+        }
+    });
+}
+
+void VectorLayer::acquireSource()
+{
+    m_source = VectorSource::acquire(m_path);
+    VectorLoader* loader = m_source->loader();
+    connect(loader, &VectorLoader::batchLoaded, this, [this]() {
+        emit layerChanged();
+    });
+    connect(loader, &VectorLoader::cacheReady, this, [this]() {
+        emit layerChanged();
+    });
+    connect(loader, &VectorLoader::progress, this, &VectorLayer::loadProgress);
+    connect(loader, &VectorLoader::loadFinished, this, [this](const QString&, qint64 features, qint64 polygons) {
+        emit loadFinished(features, polygons);
+    });
+    connect(loader, &VectorLoader::loadFailed, this, [this](const QString&, const QString& error) {
+        emit loadFailed(error);
+    });
+
+    // No-op when another reader has loaded it already; it is drawn from what the source holds
+    m_source->load();
+}
+
+void VectorLayer::unload()
+{
+    if (!m_source) return;
+
+    m_source->loader()->disconnect(this);
+    m_source.reset();
+}
+
+void VectorLayer::render(QPainter& painter, const ViewTransform& transform)
+{
+    if (!isVisible()) return;
+
+    if (!m_source) {
+        acquireSource();
+    }
+
+    painter.save();
+    painter.setPen(QPen(m_color, 3));
+    if (m_source->cache()) {
+        renderCache(painter, transform);
+    } else {
+        renderFeatures(painter, transform);
+    }
+    painter.restore();
+}
+
+void VectorLayer::renderCache(QPainter& painter, const ViewTransform& transform)
+{
+    // World (zoom-0) units to screen pixels
+    const double scale = double(1 << transform.zoom());
+    const QPointF halfView(transform.viewSize().width() / 2.0, transform.viewSize().height() / 2.0);
+    const QPointF centerWorld = ViewTransform::projectToWorld(transform.center());
+    const QPointF offset = halfView - centerWorld * scale;
+    const QRectF visible(centerWorld - halfView / scale, centerWorld + halfView / scale);
+
+    const GeometryCache& cache = *m_source->cache();
+    const int lod = cache.lodForZoom(transform.zoom());
+
+    for (int feature = 0; feature < cache.featureCount(); ++feature) {
+        if (!cache.featureBounds(feature).intersects(visible)) continue;
+
+        const int rings = cache.ringCount(feature, lod);
+        for (int r = 0; r < rings; ++r) {
+            const GeometryCache::Ring& ring = cache.ring(feature, lod, r);
+            const GeometryCache::Point* points = cache.points(ring);
+
+            m_screenPoints.resize(int(ring.pointCount));
+            for (quint32 i = 0; i < ring.pointCount; ++i) {
+                m_screenPoints[int(i)] = QPointF(points[i].x * scale + offset.x(),
+                                                 points[i].y * scale + offset.y());
+            }
+            drawRing(painter);
+        }
+    }
+}
+
+void VectorLayer::renderFeatures(QPainter& painter, const ViewTransform& transform)
+{
+    const QRectF visible = transform.visibleBounds().normalized();
+    for (const GeometryCache::SourceFeature& feature : m_source->features()) {
+        for (const QPolygonF& ring : feature.rings) {
+            if (!ring.boundingRect().intersects(visible)) continue;
+
+            m_screenPoints.resize(ring.size());
+            for (int i = 0; i < ring.size(); ++i) {
+                m_screenPoints[i] = transform.geoToScreen(ring[i]);
+            }
+            drawRing(painter);
+        }
+    }
+}
+
+void VectorLayer::drawRing(QPainter& painter)
+{
+    painter.setBrush(QBrush(m_color, Qt::SolidPattern));
+    painter.setOpacity(0.3 * opacity());
+    painter.drawPolygon(m_screenPoints.constData(), m_screenPoints.size());
+    painter.setBrush(Qt::NoBrush);
+    painter.setOpacity(opacity());
+    painter.drawPolygon(m_screenPoints.constData(), m_screenPoints.size());
+}
+
+bool VectorLayer::handleMouseEvent(QMouseEvent* event, const ViewTransform& transform)
+{
+    Q_UNUSED(event)
+    Q_UNUSED(transform)
+    return false;
+}
+
+void VectorLayer::setColor(const QColor& color)
+{
+    if (m_color != color) {
+        m_color = color;
+        emit layerChanged();
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "maplayer.h"
+#include "../core/geometrycache.h"
+#include "../services/vectorsource.h"
+#include <QColor>
+#include <QVector>
+#include <QPointF>
+#include <QPolygonF>
+#include <memory>
+
+/**
+ * @brief Polygon layer for a whole-file vector source, drawn from its GeometryCache
+ *
+ * Nothing is read until the layer is first rendered while visible. The layer
+ * then acquires the file's shared VectorSource, which maps the compiled cache
+ * or streams the features in batches (drawn as they arrive) and compiles one.
+ * Hiding the layer lets go of the source; the load is cancelled and the data
+ * released unless another reader, such as the reverse geocoder, still holds it.
+ *
+ * Cached features are culled by their stored world bounds and drawn at the
+ * cache's level of detail for the view zoom. Points are already projected,
+ * so each frame only scales and translates them into a reused scratch buffer.
+ */
+class VectorLayer : public MapLayer {
+    Q_OBJECT
+public:
+    VectorLayer(const QString& name, const QString& path, QObject* parent = nullptr);
+
+    // MapLayer interface
+    void render(QPainter& painter, const ViewTransform& transform) override;
+    bool handleMouseEvent(QMouseEvent* event, const ViewTransform& transform) override;
+
+    QString path() const { return m_path; }
+    std::shared_ptr<const GeometryCache> cache() const { return m_source ? m_source->cache() : nullptr; }
+
+    void setColor(const QColor& color);
+    QColor color() const { return m_color; }
+
+    // Drop loaded data; the next visible render loads the source again
+    void unload();
+
+signals:
+    // Forwarded from the source while the layer holds it
+    void loadProgress(qint64 featuresRead, qint64 totalFeatures);
+    void loadFinished(qint64 features, qint64 polygons);
+    void loadFailed(const QString& error);
+
+private:
+    void acquireSource();
+    void renderCache(QPainter& painter, const ViewTransform& transform);
+    void renderFeatures(QPainter& painter, const ViewTransform& transform);
+    void drawRing(QPainter& painter);
+
+    QString m_path;
+    QColor m_color = Qt::blue;
+
+    std::shared_ptr<VectorSource> m_source;  // Held while the layer is shown
+    QVector<QPointF> m_screenPoints;         // Reused between rings and frames
+};
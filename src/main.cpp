@@ -1,5 +1,8 @@
 #include "ui/mainwindow.h"
 #include "core/configmanager.h"
+#include "services/persistenceworker.h"
+#include "services/changelistener.h"
+#include "services/databasemetrics.h"
 #include <QApplication>
 
 int main(int argc, char *argv[])
@@ -9,7 +12,20 @@ int main(int argc, char *argv[])
     // Initialize configuration manager
     ConfigManager::instance().loadConfigs();
     
-    MainWindow w;
-    w.show();
-    return a.exec();
+    int result;
+    {
+        MainWindow w;
+        w.show();
+        result = a.exec();
+    } // Window teardown may still queue final aircraft states
+    
+    // Stop taking remote changes, then write everything still queued before the process exits
+    ChangeListener::instance().shutdown();
+    PersistenceWorker::instance().shutdown();
+    
+    QString metricsPath = ConfigManager::instance().getDatabaseMetricsDumpPath();
+    if (!metricsPath.isEmpty()) {
+        DatabaseMetrics::instance().writeJson(metricsPath);
+    }
+    return result;
 }
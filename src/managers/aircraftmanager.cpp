@@ -3,12 +3,17 @@
 #include "../models/polygonobject.h"
 #include "../core/configmanager.h"
 #include <QRandomGenerator>
+#include <QSet>
 #include <QDebug>
 
 AircraftManager::AircraftManager(QObject* parent)
     : QObject(parent)
     , m_polygonRegion(nullptr)
+    , m_tickTimer(new QTimer(this))
 {
+    m_clock.start();
+    connect(m_tickTimer, &QTimer::timeout, this, &AircraftManager::onTick);
+    m_tickTimer->start(ConfigManager::instance().getAircraftTickInterval());
 }
 
 AircraftManager::~AircraftManager()
@@ -69,6 +74,37 @@ void AircraftManager::addExistingAircraft(Aircraft* aircraft)
              << "Total:" << m_aircrafts.size();
 }
 
+void AircraftManager::addExistingAircraftBatch(const QVector<Aircraft*>& aircraft)
+{
+    // One lookup set instead of a linear contains() per aircraft
+    QSet<Aircraft*> known(m_aircrafts.cbegin(), m_aircrafts.cend());
+    
+    QVector<Aircraft*> added;
+    added.reserve(aircraft.size());
+    for (Aircraft* ac : aircraft) {
+        if (!ac || known.contains(ac)) {
+            continue;
+        }
+        known.insert(ac);
+        
+        connect(ac, &QObject::destroyed, 
+                this, &AircraftManager::onAircraftDestroyed);
+        ac->setParent(this);
+        added.append(ac);
+    }
+    
+    if (added.isEmpty()) {
+        return;
+    }
+    
+    m_aircrafts += added;
+    
+    emit aircraftBatchAdded(added);
+    emit aircraftCountChanged(m_aircrafts.size());
+    
+    qDebug() << "Added" << added.size() << "existing aircraft, total:" << m_aircrafts.size();
+}
+
 void AircraftManager::removeAircraft(Aircraft* aircraft)
 {
     if (!aircraft || !m_aircrafts.contains(aircraft)) {
@@ -135,6 +171,26 @@ void AircraftManager::setAllUpdateInterval(int milliseconds)
     qDebug() << "Set update interval to" << milliseconds << "ms for all aircraft";
 }
 
+void AircraftManager::onTick()
+{
+    m_tick.changes.resize(0);
+    m_tick.timestamp = m_clock.elapsed();
+    
+    // Edits made between ticks (dialogs, selection) are picked up through the dirty flags too
+    for (Aircraft* aircraft : m_aircrafts) {
+        aircraft->advance(m_tick.timestamp);
+        
+        Aircraft::DirtyFields fields = aircraft->takeDirtyFields();
+        if (fields != Aircraft::NoChanges) {
+            m_tick.changes.append(AircraftTick::Change{aircraft, fields});
+        }
+    }
+    
+    if (!m_tick.changes.isEmpty()) {
+        emit tickCompleted(m_tick);
+    }
+}
+
 void AircraftManager::onAircraftDestroyed()
 {
     // Remove destroyed aircraft from list
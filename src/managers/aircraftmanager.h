@@ -2,14 +2,31 @@
 #include <QObject>
 #include <QVector>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QPointF>
+#include "../models/aircraft.h"
 
-class Aircraft;
 class PolygonObject;
 
+/**
+ * @brief Aircraft changed during one AircraftManager tick
+ */
+struct AircraftTick {
+    struct Change {
+        Aircraft* aircraft;
+        Aircraft::DirtyFields fields;
+    };
+
+    QVector<Change> changes;
+    qint64 timestamp = 0; // Tick clock time in ms
+};
+
 /**
  * @brief Manages multiple aircraft objects
  * Handles creation, lifecycle, and coordination of aircraft
+ *
+ * A single shared timer advances every moving aircraft and publishes all
+ * changes of that tick in one tickCompleted() notification.
  */
 class AircraftManager : public QObject {
     Q_OBJECT
@@ -20,6 +37,7 @@ public:
     // Aircraft management
     Aircraft* createAircraft(const QPointF& startPosition = QPointF());
     void addExistingAircraft(Aircraft* aircraft);  // Add existing aircraft from database
+    void addExistingAircraftBatch(const QVector<Aircraft*>& aircraft);  // Bulk load, one notification
     void removeAircraft(Aircraft* aircraft);
     void clearAllAircraft();
     
@@ -37,11 +55,14 @@ public:
 
 signals:
     void aircraftCreated(Aircraft* aircraft);
+    void aircraftBatchAdded(const QVector<Aircraft*>& aircraft);
     void aircraftRemoved(Aircraft* aircraft);
     void aircraftCountChanged(int count);
+    void tickCompleted(const AircraftTick& tick);
 
 private slots:
     void onAircraftDestroyed();
+    void onTick();
 
 private:
     QVector<Aircraft*> m_aircrafts;
@@ -50,6 +71,11 @@ private:
     // Default properties for new aircraft
     int m_defaultUpdateInterval = 1000;
     
+    // Shared movement tick
+    QTimer* m_tickTimer;
+    QElapsedTimer m_clock;
+    AircraftTick m_tick; // Reused between ticks to keep its capacity
+    
     // Helper methods
     QPointF generateRandomPosition();
     QPointF generateRandomVelocity();
@@ -0,0 +1,252 @@
+#include "geofencemanager.h"
+#include "../models/aircraft.h"
+#include "../core/configmanager.h"
+#include <QTimer>
+#include <QVarLengthArray>
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+
+GeofenceManager::GeofenceManager(QObject* parent)
+    : QObject(parent)
+    , m_batchTimer(new QTimer(this))
+    , m_dwellTimer(new QTimer(this))
+{
+    ConfigManager& config = ConfigManager::instance();
+    m_dwellMs = static_cast<qint64>(config.getGeofenceDwellSeconds()) * 1000;
+
+    m_batchTimer->setSingleShot(true);
+    m_batchTimer->setInterval(config.getGeofenceEventBatchInterval());
+    connect(m_batchTimer, &QTimer::timeout, this, &GeofenceManager::flushEvents);
+
+    m_dwellTimer->setSingleShot(true);
+    connect(m_dwellTimer, &QTimer::timeout, this, &GeofenceManager::checkDwell);
+}
+
+void GeofenceManager::setRegions(const QVector<DatabaseService::PolygonRegion>& regions)
+{
+    QVector<Region> oldRegions = std::move(m_regions);
+    m_regions.clear();
+    m_regionIndex.clear();
+
+    QVector<RTree<int>::Entry> entries;
+    entries.reserve(regions.size());
+
+    for (const DatabaseService::PolygonRegion& source : regions) {
+        if (source.id.isEmpty() || m_regionIndex.contains(source.id)) continue;
+
+        Region region;
+        region.id = source.id;
+        region.name = source.name;
+        if (source.parts.isEmpty()) {
+            region.polygon = PreparedPolygon(source.polygon);
+        } else {
+            // Holes and extra parts combine with the even-odd rule
+            QVector<QPolygonF> rings;
+            for (const WkbReader::Polygon& part : source.parts) {
+                rings += part;
+            }
+            region.polygon = PreparedPolygon(rings);
+        }
+        if (region.polygon.isEmpty()) continue;
+
+        int index = m_regions.size();
+        entries.append(RTree<int>::Entry{region.polygon.boundingRect(), index});
+        m_regionIndex.insert(region.id, index);
+        m_regions.append(std::move(region));
+    }
+    m_regionTree.build(std::move(entries));
+
+    // Carry memberships over by region id; regions that disappeared count as exits
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (auto it = m_memberships.begin(); it != m_memberships.end();) {
+        QVector<Membership>& list = it.value();
+        for (int i = list.size() - 1; i >= 0; --i) {
+            const QString& regionId = oldRegions[list[i].region].id;
+            int newIndex = m_regionIndex.value(regionId, -1);
+            if (newIndex < 0) {
+                queueEvent(GeofenceEvent::Exit, it.key()->getAircraftId(), regionId, now);
+                list.removeAt(i);
+            } else {
+                list[i].region = newIndex;
+                m_regions[newIndex].members.insert(it.key());
+            }
+        }
+
+        if (list.isEmpty()) {
+            it = m_memberships.erase(it);
+        } else {
+            std::sort(list.begin(), list.end(), [](const Membership& a, const Membership& b) {
+                return a.region < b.region;
+            });
+            ++it;
+        }
+    }
+
+    qDebug() << "Geofence indexed" << m_regions.size() << "regions";
+    emit regionsChanged();
+}
+
+bool GeofenceManager::updateAircraft(Aircraft* aircraft)
+{
+    if (!aircraft) return false;
+
+    const QPointF position = aircraft->position();
+
+    // Candidates come from the R-tree; only those get an exact containment test
+    QVarLengthArray<int, 16> inside;
+    m_regionTree.query(position, [&](int region) {
+        if (m_regions[region].polygon.containsPoint(position)) {
+            inside.append(region);
+        }
+    });
+
+    auto existing = m_memberships.find(aircraft);
+    if (existing == m_memberships.end()) {
+        if (inside.isEmpty()) return false; // Common case: outside everything, nothing to track
+        existing = m_memberships.insert(aircraft, QVector<Membership>());
+    }
+    std::sort(inside.begin(), inside.end());
+
+    // Merge the sorted previous and current region lists to find transitions
+    const QVector<Membership> previous = existing.value();
+    QVector<Membership> current;
+    current.reserve(inside.size());
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    int i = 0;
+    int j = 0;
+    while (i < previous.size() || j < inside.size()) {
+        if (j >= inside.size() || (i < previous.size() && previous[i].region < inside[j])) {
+            Region& region = m_regions[previous[i].region];
+            region.members.remove(aircraft);
+            queueEvent(GeofenceEvent::Exit, aircraft->getAircraftId(), region.id, now);
+            ++i;
+        } else if (i >= previous.size() || inside[j] < previous[i].region) {
+            Region& region = m_regions[inside[j]];
+            region.members.insert(aircraft);
+            current.append(Membership{inside[j], now, false});
+            queueEvent(GeofenceEvent::Enter, aircraft->getAircraftId(), region.id, now);
+            scheduleDwellCheck(m_dwellMs);
+            ++j;
+        } else {
+            Membership membership = previous[i];
+            if (!membership.dwellReported && m_dwellMs > 0 && now - membership.enteredAt >= m_dwellMs) {
+                membership.dwellReported = true;
+                queueEvent(GeofenceEvent::Dwell, aircraft->getAircraftId(), m_regions[membership.region].id, now);
+            }
+            current.append(membership);
+            ++i;
+            ++j;
+        }
+    }
+
+    if (current.isEmpty()) {
+        m_memberships.erase(existing);
+        return false;
+    }
+
+    existing.value() = current;
+    return true;
+}
+
+void GeofenceManager::removeAircraft(Aircraft* aircraft)
+{
+    auto existing = m_memberships.find(aircraft);
+    if (existing == m_memberships.end()) return;
+
+    for (const Membership& membership : existing.value()) {
+        m_regions[membership.region].members.remove(aircraft);
+    }
+    m_memberships.erase(existing);
+}
+
+void GeofenceManager::clearAircraft()
+{
+    for (Region& region : m_regions) {
+        region.members.clear();
+    }
+    m_memberships.clear();
+}
+
+QStringList GeofenceManager::regionsContaining(Aircraft* aircraft) const
+{
+    QStringList regionIds;
+    for (const Membership& membership : m_memberships.value(aircraft)) {
+        regionIds.append(m_regions[membership.region].id);
+    }
+    return regionIds;
+}
+
+QVector<Aircraft*> GeofenceManager::aircraftInRegion(const QString& regionId) const
+{
+    int index = m_regionIndex.value(regionId, -1);
+    if (index < 0) {
+        return QVector<Aircraft*>();
+    }
+
+    const QSet<Aircraft*>& members = m_regions[index].members;
+    return QVector<Aircraft*>(members.begin(), members.end());
+}
+
+QString GeofenceManager::regionName(const QString& regionId) const
+{
+    int index = m_regionIndex.value(regionId, -1);
+    return index < 0 ? QString() : m_regions[index].name;
+}
+
+void GeofenceManager::flushEvents()
+{
+    m_batchTimer->stop();
+    if (m_pendingEvents.isEmpty()) return;
+
+    QVector<GeofenceEvent> events;
+    events.swap(m_pendingEvents);
+    emit geofenceEvents(events);
+}
+
+void GeofenceManager::checkDwell()
+{
+    if (m_dwellMs <= 0) return;
+
+    // Aircraft that stopped inside a region get no position updates to report from
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 nextDeadline = -1;
+    for (auto it = m_memberships.begin(); it != m_memberships.end(); ++it) {
+        for (Membership& membership : it.value()) {
+            if (membership.dwellReported) continue;
+
+            const qint64 deadline = membership.enteredAt + m_dwellMs;
+            if (deadline <= now) {
+                membership.dwellReported = true;
+                queueEvent(GeofenceEvent::Dwell, it.key()->getAircraftId(), m_regions[membership.region].id, now);
+            } else if (nextDeadline < 0 || deadline < nextDeadline) {
+                nextDeadline = deadline;
+            }
+        }
+    }
+
+    if (nextDeadline >= 0) {
+        scheduleDwellCheck(nextDeadline - now);
+    }
+}
+
+void GeofenceManager::scheduleDwellCheck(qint64 delayMs)
+{
+    if (m_dwellMs <= 0) return;
+
+    // Keep whichever deadline comes first
+    if (!m_dwellTimer->isActive() || m_dwellTimer->remainingTime() > delayMs) {
+        m_dwellTimer->start(static_cast<int>(qMin<qint64>(delayMs, std::numeric_limits<int>::max())));
+    }
+}
+
+void GeofenceManager::queueEvent(GeofenceEvent::Type type, const QString& aircraftId, const QString& regionId, qint64 timestamp)
+{
+    m_pendingEvents.append(GeofenceEvent{type, aircraftId, regionId, QDateTime::fromMSecsSinceEpoch(timestamp)});
+
+    // First event of a batch arms the timer; later ones ride along
+    if (!m_batchTimer->isActive()) {
+        m_batchTimer->start();
+    }
+}
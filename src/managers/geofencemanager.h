@@ -0,0 +1,96 @@
+#pragma once
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QDateTime>
+#include <QStringList>
+#include "../core/preparedpolygon.h"
+#include "../core/rtree.h"
+#include "../services/databaseservice.h"
+
+class Aircraft;
+class QTimer;
+
+/**
+ * @brief Region membership change reported by the geofence engine
+ */
+struct GeofenceEvent {
+    enum Type {
+        Enter,
+        Exit,
+        Dwell   // Aircraft stayed inside the region for the configured dwell time
+    };
+
+    Type type;
+    QString aircraftId;
+    QString regionId;
+    QDateTime timestamp;
+};
+
+/**
+ * @brief Tracks which polygon regions contain which aircraft
+ *
+ * Region bounding boxes are indexed in an R-tree, so each update only runs
+ * point-in-polygon tests against the few regions whose bounds contain the
+ * aircraft, and those tests use prepared polygons. Membership changes are
+ * collected and emitted in batches rather than one signal per transition.
+ * Dwell is also checked on a timer armed for the earliest pending deadline,
+ * so an aircraft that stops inside a region still reports it.
+ */
+class GeofenceManager : public QObject {
+    Q_OBJECT
+public:
+    explicit GeofenceManager(QObject* parent = nullptr);
+
+    // Replace the indexed regions; memberships of regions that still exist are kept
+    void setRegions(const QVector<DatabaseService::PolygonRegion>& regions);
+    int regionCount() const { return m_regions.size(); }
+
+    // Re-evaluate one aircraft; returns true if it is inside any region
+    bool updateAircraft(Aircraft* aircraft);
+    void removeAircraft(Aircraft* aircraft);
+    void clearAircraft();
+
+    // Queries
+    QStringList regionsContaining(Aircraft* aircraft) const;
+    QVector<Aircraft*> aircraftInRegion(const QString& regionId) const;
+    QString regionName(const QString& regionId) const;
+
+    // Emit queued events now instead of waiting for the batch timer
+    void flushEvents();
+
+signals:
+    void geofenceEvents(const QVector<GeofenceEvent>& events);
+    void regionsChanged();
+
+private:
+    struct Region {
+        QString id;
+        QString name;
+        PreparedPolygon polygon;
+        QSet<Aircraft*> members;
+    };
+
+    struct Membership {
+        int region;
+        qint64 enteredAt;   // ms since epoch
+        bool dwellReported;
+    };
+
+    void queueEvent(GeofenceEvent::Type type, const QString& aircraftId, const QString& regionId, qint64 timestamp);
+    void checkDwell();
+    void scheduleDwellCheck(qint64 delayMs);
+
+    QVector<Region> m_regions;
+    QHash<QString, int> m_regionIndex;
+    RTree<int> m_regionTree;
+
+    // Regions each aircraft is currently inside, sorted by region index
+    QHash<Aircraft*, QVector<Membership>> m_memberships;
+
+    QVector<GeofenceEvent> m_pendingEvents;
+    QTimer* m_batchTimer;
+    QTimer* m_dwellTimer;
+    qint64 m_dwellMs;
+};
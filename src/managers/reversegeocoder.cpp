@@ -0,0 +1,181 @@
+#include "reversegeocoder.h"
+#include "aircraftmanager.h"
+#include "../models/aircraft.h"
+#include "../core/configmanager.h"
+#include "../core/geometrycache.h"
+#include "../services/vectorsource.h"
+#include <QElapsedTimer>
+#include <QDebug>
+
+ReverseGeocoder::ReverseGeocoder(QObject* parent)
+    : QObject(parent)
+{
+    m_nameField = ConfigManager::instance().getReverseGeocodingNameField();
+}
+
+ReverseGeocoder::~ReverseGeocoder() = default;
+
+void ReverseGeocoder::loadSource(const QString& path)
+{
+    if (m_source) {
+        m_source->loader()->disconnect(this);
+    }
+    m_source = VectorSource::acquire(path);
+
+    // A mapped cache arriving last replaces a store built from the streamed features
+    VectorLoader* loader = m_source->loader();
+    connect(loader, &VectorLoader::cacheReady, this, [this]() {
+        buildStore();
+    });
+    connect(loader, &VectorLoader::loadFinished, this, [this]() {
+        if (!m_source->cache()) {
+            buildStore();
+        }
+    });
+    connect(loader, &VectorLoader::loadFailed, this, [](const QString& path, const QString& error) {
+        qWarning() << "Reverse geocoding unavailable, cannot read" << path << ":" << error;
+    });
+
+    // The boundary layer may have read it already
+    if (m_source->state() == VectorSource::Ready) {
+        buildStore();
+    } else {
+        m_source->load();
+    }
+}
+
+void ReverseGeocoder::buildStore()
+{
+    QElapsedTimer timer;
+    timer.start();
+    std::shared_ptr<const FeatureStore> store = m_source->cache()
+        ? FeatureStore::fromCache(*m_source->cache(), m_nameField)
+        : FeatureStore::fromFeatures(m_source->features(), m_nameField);
+    qDebug() << "Province index built in" << timer.elapsed() << "ms";
+    setStore(std::move(store));
+}
+
+void ReverseGeocoder::setStore(std::shared_ptr<const FeatureStore> store)
+{
+    m_store = std::move(store);
+
+    // Indices of the previous store mean nothing now: locate everyone from scratch
+    m_provinces.relocateAll(m_store ? m_store->size() : 0, [this](Aircraft* aircraft) {
+        const int province = m_store ? m_store->locate(aircraft->position()) : -1;
+        aircraft->setProvince(m_store ? m_store->name(province) : QString());
+        return province;
+    });
+
+    qDebug() << "Reverse geocoding" << (m_store ? m_store->size() : 0) << "provinces for"
+             << m_provinces.size() << "aircraft";
+    emit storeChanged();
+    emit provincesChanged();
+}
+
+bool ReverseGeocoder::updateAircraft(Aircraft* aircraft)
+{
+    if (!aircraft) return false;
+
+    const int hint = m_provinces.regionOf(aircraft);
+    const int province = isReady() ? m_store->locate(aircraft->position(), hint) : -1;
+    return assign(aircraft, province);
+}
+
+bool ReverseGeocoder::assign(Aircraft* aircraft, int province)
+{
+    if (!m_provinces.contains(aircraft)) {
+        // Aircraft deleted without going through the manager must not leave stale counts
+        connect(aircraft, &QObject::destroyed, this, [this, aircraft]() {
+            const int last = m_provinces.regionOf(aircraft);
+            m_provinces.remove(aircraft);
+            if (last >= 0) {
+                emit provincesChanged();
+            }
+        });
+    } else if (m_provinces.regionOf(aircraft) == province) {
+        return false;
+    }
+
+    const bool changed = m_provinces.assign(aircraft, province);
+    aircraft->setProvince(isReady() ? m_store->name(province) : QString());
+    return changed;
+}
+
+void ReverseGeocoder::removeAircraft(Aircraft* aircraft)
+{
+    if (!m_provinces.remove(aircraft)) return;
+
+    disconnect(aircraft, &QObject::destroyed, this, nullptr);
+    emit provincesChanged();
+}
+
+void ReverseGeocoder::clearAircraft()
+{
+    m_provinces.forEachKey([this](Aircraft* aircraft) {
+        disconnect(aircraft, &QObject::destroyed, this, nullptr);
+    });
+    m_provinces.clear();
+    emit provincesChanged();
+}
+
+QString ReverseGeocoder::provinceOf(Aircraft* aircraft) const
+{
+    return isReady() ? m_store->name(m_provinces.regionOf(aircraft)) : QString();
+}
+
+QVector<Aircraft*> ReverseGeocoder::aircraftInProvince(const QString& province) const
+{
+    return m_provinces.keysIn(isReady() ? m_store->indexOf(province) : -1);
+}
+
+QHash<QString, int> ReverseGeocoder::provinceCounts() const
+{
+    QVector<int> perFeature(m_provinces.regionCount());
+    for (int index = 0; index < perFeature.size(); ++index) {
+        perFeature[index] = m_provinces.count(index);
+    }
+    return countsByName(perFeature);
+}
+
+QHash<QString, int> ReverseGeocoder::countByProvince(const QVector<Aircraft*>& aircraft) const
+{
+    if (!isReady()) return QHash<QString, int>();
+
+    // Tracked aircraft start from their known province, so most need no tree walk
+    QVector<int> perFeature(m_store->size(), 0);
+    for (Aircraft* item : aircraft) {
+        if (!item) continue;
+        const int province = m_store->locate(item->position(), m_provinces.regionOf(item));
+        if (province >= 0) {
+            ++perFeature[province];
+        }
+    }
+
+    return countsByName(perFeature);
+}
+
+QHash<QString, int> ReverseGeocoder::countsByName(const QVector<int>& perFeature) const
+{
+    // Several features may share a name (islands of one province)
+    QHash<QString, int> counts;
+    for (int index = 0; index < perFeature.size(); ++index) {
+        if (perFeature[index] > 0) {
+            counts[m_store->name(index)] += perFeature[index];
+        }
+    }
+    return counts;
+}
+
+void ReverseGeocoder::onTickCompleted(const AircraftTick& tick)
+{
+    bool changed = false;
+    for (const AircraftTick::Change& change : tick.changes) {
+        if (change.fields & Aircraft::PositionDirty) {
+            changed |= updateAircraft(change.aircraft);
+        }
+    }
+
+    if (changed) {
+        emit provincesChanged();
+    }
+}
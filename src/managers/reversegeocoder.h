@@ -0,0 +1,70 @@
+#pragma once
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QString>
+#include <memory>
+#include "../core/featurestore.h"
+#include "../core/regiontally.h"
+
+class Aircraft;
+class VectorSource;
+struct AircraftTick;
+
+/**
+ * @brief Tags aircraft with the province they are over
+ *
+ * Provinces come from the configured boundary source, shared with the
+ * boundary layer when both read the same file, so it is parsed once. The
+ * store is built from the mapped GeometryCache, or from the streamed
+ * features when caching is off, and does not depend on the layer being
+ * shown. Each
+ * tracked aircraft remembers its province, and a position update first tests
+ * that province's prepared polygon, so staying inside costs one grid lookup
+ * and only a crossing walks the R-tree. Aircraft counts per province are kept
+ * up to date as aircraft move, are added or go away.
+ */
+class ReverseGeocoder : public QObject {
+    Q_OBJECT
+public:
+    explicit ReverseGeocoder(QObject* parent = nullptr);
+    ~ReverseGeocoder();
+
+    // Reads the province source; the store is replaced once the source has loaded
+    void loadSource(const QString& path);
+    void setStore(std::shared_ptr<const FeatureStore> store);
+    std::shared_ptr<const FeatureStore> store() const { return m_store; }
+    bool isReady() const { return m_store && !m_store->isEmpty(); }
+
+    // Tracks the aircraft; returns true if its province changed
+    bool updateAircraft(Aircraft* aircraft);
+    void removeAircraft(Aircraft* aircraft);
+    void clearAircraft();
+
+    // Queries over tracked aircraft; aircraft outside every province have no province
+    QString provinceOf(Aircraft* aircraft) const;
+    QVector<Aircraft*> aircraftInProvince(const QString& province) const;
+    QHash<QString, int> provinceCounts() const;
+
+    // Locates a batch without tracking it, e.g. a filtered selection
+    QHash<QString, int> countByProvince(const QVector<Aircraft*>& aircraft) const;
+
+public slots:
+    // Re-locates only the aircraft that moved during the tick
+    void onTickCompleted(const AircraftTick& tick);
+
+signals:
+    void storeChanged();
+    void provincesChanged();  // At most once per tick, when any count changed
+
+private:
+    // Moves the aircraft between counts; returns true if the province changed
+    bool assign(Aircraft* aircraft, int province);
+    QHash<QString, int> countsByName(const QVector<int>& perFeature) const;
+    void buildStore();
+
+    std::shared_ptr<VectorSource> m_source;
+    std::shared_ptr<const FeatureStore> m_store;
+    QString m_nameField;
+    RegionTally<Aircraft*> m_provinces;  // Store index per tracked aircraft
+};
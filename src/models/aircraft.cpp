@@ -1,6 +1,10 @@
 #include "aircraft.h"
 #include "../core/viewtransform.h"
 #include "../core/configmanager.h"
+#include "../services/databaseservice.h"
+#include "../services/persistenceworker.h"
+#include "../services/preparedstatements.h"
+#include "../services/databasemetrics.h"
 #include <QPainter>
 #include <QTransform>
 #include <QtMath>
@@ -8,6 +12,7 @@
 #include <QUuid>
 #include <QRandomGenerator>
 #include <pqxx/pqxx>
+#include <optional>
 
 Aircraft::Aircraft(const QPointF& position, QObject* parent)
     : GeometryObject(parent)
@@ -19,17 +24,13 @@ Aircraft::Aircraft(const QPointF& position, QObject* parent)
     , m_state(Normal)
     , m_isMoving(false)
     , m_updateInterval(1000)
-    , m_updateTimer(new QTimer(this))
     , m_trailEnabled(true)  // Enable trail by default
-    , m_maxTrailPoints(50)  // Keep last 50 position points
     , m_createdAt(QDateTime::currentDateTime())
     , m_updatedAt(QDateTime::currentDateTime())
 {
     generateAircraftId();
     setCallSign(QString("AC%1").arg(QRandomGenerator::global()->bounded(1000, 9999)));
-    
-    connect(m_updateTimer, &QTimer::timeout, this, &Aircraft::updatePosition);
-    m_updateTimer->setInterval(m_updateInterval);
+    initializeTrail();
 }
 
 Aircraft::Aircraft(QObject* parent)
@@ -41,45 +42,28 @@ Aircraft::Aircraft(QObject* parent)
 Aircraft::Aircraft(const QString& aircraftId, QObject* parent)
     : GeometryObject(parent)
     , m_aircraftId(aircraftId)
-    , m_updateTimer(new QTimer(this))
     , m_createdAt(QDateTime::currentDateTime())
     , m_updatedAt(QDateTime::currentDateTime())
 {
-    connect(m_updateTimer, &QTimer::timeout, this, &Aircraft::updatePosition);
-    m_updateTimer->setInterval(m_updateInterval);
+    initializeTrail();
     
     // Try to load from database
     loadFromDatabase(aircraftId);
 }
 
+Aircraft::Aircraft(const QString& aircraftId, const QDateTime& createdAt, QObject* parent)
+    : GeometryObject(parent)
+    , m_aircraftId(aircraftId)
+    , m_createdAt(createdAt)
+{
+    initializeTrail();
+}
+
 void Aircraft::render(QPainter& painter, const ViewTransform& transform)
 {
+    // Flight trails are rasterized separately by TrailLayer
     QPointF pixelPos = transform.geoToScreen(m_position);
     
-    // Draw flight trail if enabled
-    if (m_trailEnabled && m_flightTrail.size() > 1) {
-        QPen trailPen(getStateColor(), 2);
-        trailPen.setStyle(Qt::DashLine);
-        painter.setPen(trailPen);
-        
-        // Draw trail with fading effect
-        for (int i = 1; i < m_flightTrail.size(); ++i) {
-            QPointF startPixel = transform.geoToScreen(m_flightTrail[i-1]);
-            QPointF endPixel = transform.geoToScreen(m_flightTrail[i]);
-            
-            // Calculate fade alpha (newer points more opaque)
-            double fadeRatio = static_cast<double>(i) / m_flightTrail.size();
-            QColor trailColor = getStateColor();
-            trailColor.setAlphaF(fadeRatio * 0.8); // Max 80% opacity
-            
-            QPen fadedPen(trailColor, 2);
-            fadedPen.setStyle(Qt::DashLine);
-            painter.setPen(fadedPen);
-            
-            painter.drawLine(startPixel, endPixel);
-        }
-    }
-    
     // Create aircraft icon based on current state
     QColor color = getStateColor();
     bool highlighted = isSelected() || (m_state == Selected);
@@ -110,7 +94,7 @@ void Aircraft::render(QPainter& painter, const ViewTransform& transform)
             .arg(static_cast<int>(m_speed));
         
         if (m_trailEnabled) {
-            infoText += QString("\nTrail: %1 pts").arg(m_flightTrail.size());
+            infoText += QString("\nTrail: %1 pts").arg(m_trail.size());
         }
         
         painter.drawText(textRect, Qt::AlignLeft | Qt::AlignTop, infoText);
@@ -137,7 +121,7 @@ QRectF Aircraft::boundingBox() const
 
 QString Aircraft::getInfo() const
 {
-    return QString("Aircraft ID: %1\nCall Sign: %2\nType: %3\nPosition: %4, %5\nAltitude: %6m\nSpeed: %7 m/s\nHeading: %8°")
+    QString info = QString("Aircraft ID: %1\nCall Sign: %2\nType: %3\nPosition: %4, %5\nAltitude: %6m\nSpeed: %7 m/s\nHeading: %8°")
         .arg(m_aircraftId)
         .arg(m_callSign)
         .arg(m_aircraftType)
@@ -146,6 +130,10 @@ QString Aircraft::getInfo() const
         .arg(static_cast<int>(m_altitude))
         .arg(static_cast<int>(m_speed))
         .arg(static_cast<int>(m_heading));
+    if (!m_province.isEmpty()) {
+        info += QString("\nProvince: %1").arg(m_province);
+    }
+    return info;
 }
 
 void Aircraft::setPosition(const QPointF& position)
@@ -153,9 +141,12 @@ void Aircraft::setPosition(const QPointF& position)
     if (m_position != position) {
         m_position = position;
         updateTimestamp();
-        emit positionChanged(position);
+        markDirty(PositionDirty);
+        if (m_changeSignalsEnabled) {
+            emit positionChanged(position);
+        }
         
-        // Auto-save to database if moving
+        // Auto-save to database if moving (queued, never blocks the tick)
         if (m_isMoving) {
             updateInDatabase();
         }
@@ -174,7 +165,10 @@ void Aircraft::setHeading(double heading)
     if (qAbs(m_heading - heading) > 0.1) {
         m_heading = heading;
         updateTimestamp();
-        emit headingChanged(heading);
+        markDirty(HeadingDirty);
+        if (m_changeSignalsEnabled) {
+            emit headingChanged(heading);
+        }
     }
 }
 
@@ -183,7 +177,10 @@ void Aircraft::setAltitude(double altitude)
     if (qAbs(m_altitude - altitude) > 1.0) {
         m_altitude = altitude;
         updateTimestamp();
-        emit altitudeChanged(altitude);
+        markDirty(AltitudeDirty);
+        if (m_changeSignalsEnabled) {
+            emit altitudeChanged(altitude);
+        }
     }
 }
 
@@ -192,7 +189,10 @@ void Aircraft::setSpeed(double speed)
     if (qAbs(m_speed - speed) > 0.1) {
         m_speed = speed;
         updateTimestamp();
-        emit speedChanged(speed);
+        markDirty(SpeedDirty);
+        if (m_changeSignalsEnabled) {
+            emit speedChanged(speed);
+        }
     }
 }
 
@@ -201,7 +201,10 @@ void Aircraft::setState(State state)
     if (m_state != state) {
         m_state = state;
         updateTimestamp();
-        emit stateChanged(state);
+        markDirty(StateDirty);
+        if (m_changeSignalsEnabled) {
+            emit stateChanged(state);
+        }
     }
 }
 
@@ -209,7 +212,7 @@ void Aircraft::startMovement()
 {
     if (!m_isMoving) {
         m_isMoving = true;
-        m_updateTimer->start();
+        m_lastAdvanceMs = -1; // First step happens one interval after the next tick
         qDebug() << "Aircraft" << m_callSign << "started movement";
     }
 }
@@ -218,7 +221,6 @@ void Aircraft::stopMovement()
 {
     if (m_isMoving) {
         m_isMoving = false;
-        m_updateTimer->stop();
         updateInDatabase(); // Save final position
         qDebug() << "Aircraft" << m_callSign << "stopped movement";
     }
@@ -227,111 +229,71 @@ void Aircraft::stopMovement()
 void Aircraft::setUpdateInterval(int milliseconds)
 {
     m_updateInterval = milliseconds;
-    m_updateTimer->setInterval(milliseconds);
+}
+
+bool Aircraft::advance(qint64 nowMs)
+{
+    if (!m_isMoving) return false;
+    
+    if (m_lastAdvanceMs < 0) {
+        m_lastAdvanceMs = nowMs;
+        return false;
+    }
+    if (nowMs - m_lastAdvanceMs < m_updateInterval) {
+        return false;
+    }
+    m_lastAdvanceMs = nowMs;
+    
+    QPointF newPosition = m_position + m_velocity;
+    
+    // Add current position to trail before updating
+    if (m_trailEnabled) {
+        addTrailPoint(m_position);
+    }
+    
+    setPosition(newPosition);
+    return true;
+}
+
+Aircraft::DirtyFields Aircraft::takeDirtyFields()
+{
+    DirtyFields fields = m_dirtyFields;
+    m_dirtyFields = NoChanges;
+    return fields;
 }
 
 void Aircraft::setSelected(bool selected)
 {
     GeometryObject::setSelected(selected);
+    
+    // Only the selected aircraft keeps per-field signals for live UI updates;
+    // on deselect they stay on until listeners have seen the return to Normal
     if (selected) {
+        m_changeSignalsEnabled = true;
         setState(Selected);
     } else {
         setState(Normal); // Will be updated by position checking
+        m_changeSignalsEnabled = false;
     }
 }
 
 void Aircraft::saveToDatabase()
 {
-    try {
-        ConfigManager& config = ConfigManager::instance();
-        
-        QString connString = QString("host=%1 port=%2 dbname=%3 user=%4 password=%5 connect_timeout=%6")
-            .arg(config.getDatabaseHost())
-            .arg(config.getDatabasePort())
-            .arg(config.getDatabaseName())
-            .arg(config.getDatabaseUsername())
-            .arg(config.getDatabasePassword())
-            .arg(config.getDatabaseConnectionTimeout());
-        
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        // Insert or update aircraft (upsert)
-        QString upsertQuery = R"(
-            INSERT INTO aircraft 
-            (aircraft_id, call_sign, aircraft_type, longitude, latitude, altitude, speed, heading, 
-             velocity_x, velocity_y, state, flight_route_id, is_moving, created_at, updated_at)
-            VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12, $13, $14, $15)
-            ON CONFLICT (aircraft_id)
-            DO UPDATE SET
-                call_sign = EXCLUDED.call_sign,
-                aircraft_type = EXCLUDED.aircraft_type,
-                longitude = EXCLUDED.longitude,
-                latitude = EXCLUDED.latitude,
-                altitude = EXCLUDED.altitude,
-                speed = EXCLUDED.speed,
-                heading = EXCLUDED.heading,
-                velocity_x = EXCLUDED.velocity_x,
-                velocity_y = EXCLUDED.velocity_y,
-                state = EXCLUDED.state,
-                flight_route_id = EXCLUDED.flight_route_id,
-                is_moving = EXCLUDED.is_moving,
-                updated_at = CURRENT_TIMESTAMP
-        )";
-        
-        txn.exec_params(upsertQuery.toStdString(),
-            m_aircraftId.toStdString(),
-            m_callSign.toStdString(),
-            m_aircraftType.toStdString(),
-            m_position.x(),
-            m_position.y(),
-            m_altitude,
-            m_speed,
-            m_heading,
-            m_velocity.x(),
-            m_velocity.y(),
-            static_cast<int>(m_state),
-            m_flightRouteId.toStdString(),
-            m_isMoving,
-            m_createdAt.toString(Qt::ISODate).toStdString(),
-            m_updatedAt.toString(Qt::ISODate).toStdString()
-        );
-        
-        txn.commit();
-        
-        qDebug() << "Successfully saved aircraft to database:" << m_aircraftId;
-        emit databaseOperationCompleted(true, "Aircraft saved successfully");
-        
-    } catch (const std::exception &e) {
-        qDebug() << "Error saving aircraft to database:" << e.what();
-        emit databaseOperationCompleted(false, QString("Error saving aircraft: %1").arg(e.what()));
-    }
+    // Same path as updates, but written now instead of with the next batch;
+    // the merge-upsert inserts the row if it is new
+    PersistenceWorker& worker = PersistenceWorker::instance();
+    worker.enqueue(snapshot());
+    worker.requestFlush();
 }
 
 void Aircraft::loadFromDatabase(const QString& aircraftId)
 {
     try {
-        ConfigManager& config = ConfigManager::instance();
-        
-        QString connString = QString("host=%1 port=%2 dbname=%3 user=%4 password=%5 connect_timeout=%6")
-            .arg(config.getDatabaseHost())
-            .arg(config.getDatabasePort())
-            .arg(config.getDatabaseName())
-            .arg(config.getDatabaseUsername())
-            .arg(config.getDatabasePassword())
-            .arg(config.getDatabaseConnectionTimeout());
+        PooledConnection c = DatabaseService::instance().acquireConnection();
+        pqxx::work txn(*c);
         
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        QString query = R"(
-            SELECT call_sign, aircraft_type, longitude, latitude, altitude, speed, heading,
-                   velocity_x, velocity_y, state, flight_route_id, is_moving, created_at, updated_at
-            FROM aircraft 
-            WHERE aircraft_id = $1
-        )";
-        
-        pqxx::result result = txn.exec_params(query.toStdString(), aircraftId.toStdString());
+        pqxx::result result = PreparedStatements::exec(txn, PreparedStatements::AircraftLoad,
+                                                       aircraftId.toStdString());
         
         if (result.empty()) {
             qDebug() << "Aircraft not found in database:" << aircraftId;
@@ -367,136 +329,177 @@ void Aircraft::loadFromDatabase(const QString& aircraftId)
 
 void Aircraft::updateInDatabase()
 {
-    try {
-        ConfigManager& config = ConfigManager::instance();
-        
-        QString connString = QString("host=%1 port=%2 dbname=%3 user=%4 password=%5 connect_timeout=%6")
-            .arg(config.getDatabaseHost())
-            .arg(config.getDatabasePort())
-            .arg(config.getDatabaseName())
-            .arg(config.getDatabaseUsername())
-            .arg(config.getDatabasePassword())
-            .arg(config.getDatabaseConnectionTimeout());
-        
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        QString updateQuery = R"(
-            UPDATE aircraft SET 
-                call_sign = $2, aircraft_type = $3, longitude = $4, latitude = $5,
-                altitude = $6, speed = $7, heading = $8, velocity_x = $9, velocity_y = $10,
-                state = $11, flight_route_id = $12, is_moving = $13, updated_at = $14
-            WHERE aircraft_id = $1
-        )";
-        
-        txn.exec_params(updateQuery.toStdString(),
-            m_aircraftId.toStdString(),
-            m_callSign.toStdString(),
-            m_aircraftType.toStdString(),
-            m_position.x(),
-            m_position.y(),
-            m_altitude,
-            m_speed,
-            m_heading,
-            m_velocity.x(),
-            m_velocity.y(),
-            static_cast<int>(m_state),
-            m_flightRouteId.toStdString(),
-            m_isMoving,
-            QDateTime::currentDateTime().toString(Qt::ISODate).toStdString()
-        );
-        
-        txn.commit();
-        
-    } catch (const std::exception &e) {
-        qDebug() << "Error updating aircraft in database:" << e.what();
-    }
+    // Write-behind: the persistence thread coalesces and writes it with the next batch
+    PersistenceWorker::instance().enqueue(snapshot());
+}
+
+AircraftSnapshot Aircraft::snapshot() const
+{
+    AircraftSnapshot snapshot;
+    snapshot.aircraftId = m_aircraftId;
+    snapshot.callSign = m_callSign;
+    snapshot.aircraftType = m_aircraftType;
+    snapshot.position = m_position;
+    snapshot.altitude = m_altitude;
+    snapshot.speed = m_speed;
+    snapshot.heading = m_heading;
+    snapshot.velocity = m_velocity;
+    snapshot.state = static_cast<int>(m_state);
+    snapshot.flightRouteId = m_flightRouteId;
+    snapshot.isMoving = m_isMoving;
+    snapshot.updatedAt = QDateTime::currentDateTime();
+    return snapshot;
 }
 
 void Aircraft::deleteFromDatabase()
 {
-    try {
-        ConfigManager& config = ConfigManager::instance();
-        
-        QString connString = QString("host=%1 port=%2 dbname=%3 user=%4 password=%5 connect_timeout=%6")
-            .arg(config.getDatabaseHost())
-            .arg(config.getDatabasePort())
-            .arg(config.getDatabaseName())
-            .arg(config.getDatabaseUsername())
-            .arg(config.getDatabasePassword())
-            .arg(config.getDatabaseConnectionTimeout());
-        
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        QString deleteQuery = "DELETE FROM aircraft WHERE aircraft_id = $1";
-        txn.exec_params(deleteQuery.toStdString(), m_aircraftId.toStdString());
-        
-        txn.commit();
-        
-        qDebug() << "Successfully deleted aircraft from database:" << m_aircraftId;
-        emit databaseOperationCompleted(true, "Aircraft deleted successfully");
-        
-    } catch (const std::exception &e) {
-        qDebug() << "Error deleting aircraft from database:" << e.what();
-        emit databaseOperationCompleted(false, QString("Error deleting aircraft: %1").arg(e.what()));
-    }
+    // Ordered after any queued update of this aircraft, so the row stays deleted
+    PersistenceWorker::instance().enqueueDelete(m_aircraftId);
 }
 
 QVector<Aircraft*> Aircraft::loadAllFromDatabase(QObject* parent)
 {
     QVector<Aircraft*> aircraft;
+    streamAllFromDatabase(parent, ConfigManager::instance().getAircraftLoadBatchSize(),
+                          [&aircraft](const QVector<Aircraft*>& batch) { aircraft += batch; });
+    return aircraft;
+}
+
+int Aircraft::streamAllFromDatabase(QObject* parent, int batchSize,
+                                    const std::function<void(const QVector<Aircraft*>&)>& onBatch)
+{
+    return streamFromDatabase(parent, batchSize, nullptr, onBatch);
+}
+
+QVector<Aircraft*> Aircraft::loadByIdsFromDatabase(const QStringList& aircraftIds, QObject* parent)
+{
+    QVector<Aircraft*> aircraft;
+    if (aircraftIds.isEmpty()) {
+        return aircraft;
+    }
+    
+    streamFromDatabase(parent, aircraftIds.size(), &aircraftIds,
+                       [&aircraft](const QVector<Aircraft*>& batch) { aircraft += batch; });
+    return aircraft;
+}
+
+int Aircraft::streamFromDatabase(QObject* parent, int batchSize, const QStringList* aircraftIds,
+                                 const std::function<void(const QVector<Aircraft*>&)>& onBatch)
+{
+    batchSize = qMax(1, batchSize);
+    QVector<Aircraft*> batch;
+    batch.reserve(batchSize);
+    int loaded = 0;
     
     try {
-        ConfigManager& config = ConfigManager::instance();
-        
-        QString connString = QString("host=%1 port=%2 dbname=%3 user=%4 password=%5 connect_timeout=%6")
-            .arg(config.getDatabaseHost())
-            .arg(config.getDatabasePort())
-            .arg(config.getDatabaseName())
-            .arg(config.getDatabaseUsername())
-            .arg(config.getDatabasePassword())
-            .arg(config.getDatabaseConnectionTimeout());
-        
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        QString query = "SELECT aircraft_id FROM aircraft ORDER BY created_at";
-        pqxx::result result = txn.exec(query.toStdString());
+        PooledConnection c = DatabaseService::instance().acquireConnection();
+        DatabaseMetrics::Timer metrics("aircraft_stream");
+        pqxx::work txn(*c);
+        
+        // COPY takes no parameters, so an id filter is quoted inline
+        std::string where;
+        if (aircraftIds) {
+            QStringList quoted;
+            quoted.reserve(aircraftIds->size());
+            for (const QString& id : *aircraftIds) {
+                quoted << QString::fromStdString(txn.quote(id.toStdString()));
+            }
+            where = QString("WHERE aircraft_id IN (%1)").arg(quoted.join(", ")).toStdString();
+        }
         
-        for (const auto& row : result) {
-            QString aircraftId = QString::fromStdString(row["aircraft_id"].as<std::string>());
-            Aircraft* ac = new Aircraft(aircraftId, parent);
-            aircraft.append(ac);
+        // One COPY stream for all rows instead of an id query plus a SELECT per aircraft
+        auto rows = txn.stream<std::string, std::optional<std::string>, std::optional<std::string>,
+                               double, double, double, double, double, double, double, int,
+                               std::optional<std::string>, bool, std::string, std::string>(R"(
+            SELECT aircraft_id, call_sign, aircraft_type, longitude, latitude, altitude, speed,
+                   heading, velocity_x, velocity_y, state, flight_route_id, is_moving,
+                   created_at, updated_at
+            FROM aircraft
+        )" + where + " ORDER BY created_at");
+        
+        for (auto [aircraftId, callSign, aircraftType, longitude, latitude, altitude, speed,
+                   heading, velocityX, velocityY, state, flightRouteId, isMoving,
+                   createdAt, updatedAt] : rows) {
+            Aircraft* ac = new Aircraft(
+                QString::fromStdString(aircraftId),
+                QDateTime::fromString(QString::fromStdString(createdAt), Qt::ISODate),
+                parent);
+            ac->m_callSign = QString::fromStdString(callSign.value_or(std::string()));
+            ac->m_aircraftType = QString::fromStdString(aircraftType.value_or("Unknown"));
+            ac->m_position = QPointF(longitude, latitude);
+            ac->m_altitude = altitude;
+            ac->m_speed = speed;
+            ac->m_heading = heading;
+            ac->m_velocity = QPointF(velocityX, velocityY);
+            ac->m_state = static_cast<State>(state);
+            ac->m_flightRouteId = QString::fromStdString(flightRouteId.value_or(std::string()));
+            ac->m_isMoving = isMoving;
+            ac->m_updatedAt = QDateTime::fromString(QString::fromStdString(updatedAt), Qt::ISODate);
+            
+            batch.append(ac);
+            if (batch.size() >= batchSize) {
+                loaded += batch.size();
+                onBatch(batch);
+                batch.resize(0);
+            }
         }
         
-        qDebug() << "Loaded" << aircraft.size() << "aircraft from database";
+        txn.commit();
+        metrics.finish(static_cast<quint64>(loaded + batch.size()));
         
     } catch (const std::exception &e) {
         qDebug() << "Error loading aircraft from database:" << e.what();
     }
     
-    return aircraft;
+    // Rows read before a failure are still handed out
+    if (!batch.isEmpty()) {
+        loaded += batch.size();
+        onBatch(batch);
+    }
+    
+    qDebug() << "Loaded" << loaded << "aircraft from database";
+    return loaded;
+}
+
+void Aircraft::applyRemoteState(const Aircraft& remote)
+{
+    // Assign fields directly rather than through setPosition(): a change that came
+    // from the database must not be queued back to it
+    if (m_position != remote.m_position) {
+        if (m_trailEnabled) {
+            addTrailPoint(remote.m_position);
+        }
+        m_position = remote.m_position;
+        markDirty(PositionDirty);
+        if (m_changeSignalsEnabled) {
+            emit positionChanged(m_position);
+        }
+    }
+    
+    setHeading(remote.m_heading);
+    setAltitude(remote.m_altitude);
+    setSpeed(remote.m_speed);
+    m_velocity = remote.m_velocity;
+    m_callSign = remote.m_callSign;
+    m_aircraftType = remote.m_aircraftType;
+    m_flightRouteId = remote.m_flightRouteId;
+    m_updatedAt = remote.m_updatedAt;
+    
+    // The writing client drives a moving aircraft; only follow it when it stops.
+    // State stays local, it reflects this client's geofence and selection.
+    if (!remote.m_isMoving) {
+        m_isMoving = false;
+    }
 }
 
 bool Aircraft::existsInDatabase(const QString& aircraftId)
 {
     try {
-        ConfigManager& config = ConfigManager::instance();
-        
-        QString connString = QString("host=%1 port=%2 dbname=%3 user=%4 password=%5 connect_timeout=%6")
-            .arg(config.getDatabaseHost())
-            .arg(config.getDatabasePort())
-            .arg(config.getDatabaseName())
-            .arg(config.getDatabaseUsername())
-            .arg(config.getDatabasePassword())
-            .arg(config.getDatabaseConnectionTimeout());
+        PooledConnection c = DatabaseService::instance().acquireConnection();
+        pqxx::work txn(*c);
         
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        QString query = "SELECT COUNT(*) FROM aircraft WHERE aircraft_id = $1";
-        pqxx::result result = txn.exec_params(query.toStdString(), aircraftId.toStdString());
+        pqxx::result result = PreparedStatements::exec(txn, PreparedStatements::AircraftExists,
+                                                       aircraftId.toStdString());
         
         return result[0][0].as<int>() > 0;
         
@@ -506,22 +509,6 @@ bool Aircraft::existsInDatabase(const QString& aircraftId)
     }
 }
 
-void Aircraft::updatePosition()
-{
-    if (!m_isMoving) return;
-    
-    QPointF newPosition = m_position + m_velocity;
-    
-    // Add current position to trail before updating
-    if (m_trailEnabled) {
-        addTrailPoint(m_position);
-    }
-    
-    setPosition(newPosition);
-    
-    qDebug() << "Aircraft" << m_aircraftId << "moved to" << newPosition;
-}
-
 void Aircraft::updateHeadingFromVelocity()
 {
     if (m_velocity.x() != 0 || m_velocity.y() != 0) {
@@ -579,12 +566,36 @@ void Aircraft::updateTimestamp()
     m_updatedAt = QDateTime::currentDateTime();
 }
 
+void Aircraft::setTrailDecimation(double minDistancePx, double minHeadingChange)
+{
+    // Store the distance in zoom-0 world pixels so the check needs no zoom lookup
+    int referenceZoom = ConfigManager::instance().getTrailReferenceZoom();
+    m_trailMinDistanceWorld = qMax(0.0, minDistancePx) / (1 << referenceZoom);
+    m_trailMinHeadingChange = qMax(0.0, minHeadingChange);
+}
+
+void Aircraft::initializeTrail()
+{
+    ConfigManager& config = ConfigManager::instance();
+    m_trail.setCapacity(config.getTrailMaxPoints());
+    setTrailDecimation(config.getTrailMinDistancePx(), config.getTrailMinHeadingChange());
+}
+
 void Aircraft::addTrailPoint(const QPointF& position)
 {
-    m_flightTrail.append(position);
-    
-    // Limit trail length
-    if (m_flightTrail.size() > m_maxTrailPoints) {
-        m_flightTrail.removeFirst();
+    if (!m_trail.isEmpty()) {
+        QPointF delta = ViewTransform::projectToWorld(position) - ViewTransform::projectToWorld(m_trail.last());
+        double distance = qSqrt(delta.x() * delta.x() + delta.y() * delta.y());
+        
+        double headingChange = qAbs(m_heading - m_lastTrailHeading);
+        if (headingChange > 180.0) headingChange = 360.0 - headingChange;
+        
+        if (distance < m_trailMinDistanceWorld && headingChange < m_trailMinHeadingChange) {
+            return; // Not enough visible change to be worth a point
+        }
     }
+    
+    // Ring buffer overwrites the oldest point once full
+    m_trail.append(position);
+    m_lastTrailHeading = m_heading;
 }
@@ -1,10 +1,14 @@
 #pragma once
 #include "../core/geometryobject.h"
-#include <QTimer>
+#include "../core/trailbuffer.h"
 #include <QPointF>
 #include <QColor>
 #include <QPixmap>
 #include <QDateTime>
+#include <QStringList>
+#include <functional>
+
+struct AircraftSnapshot;
 
 /**
  * @brief Represents an aircraft object that moves on the map
@@ -18,6 +22,17 @@ public:
         Selected     // Selected by user, highlighted
     };
 
+    // Fields changed since the last AircraftManager tick
+    enum DirtyField {
+        NoChanges     = 0x00,
+        PositionDirty = 0x01,
+        HeadingDirty  = 0x02,
+        AltitudeDirty = 0x04,
+        SpeedDirty    = 0x08,
+        StateDirty    = 0x10
+    };
+    Q_DECLARE_FLAGS(DirtyFields, DirtyField)
+
     explicit Aircraft(const QPointF& startPosition, QObject* parent = nullptr);
     explicit Aircraft(QObject* parent = nullptr);
     explicit Aircraft(const QString& aircraftId, QObject* parent = nullptr);
@@ -56,6 +71,7 @@ public:
     
     void setState(State state);
     State state() const { return m_state; }
+    QColor getStateColor() const;
     
     void startMovement();
     void stopMovement();
@@ -63,11 +79,28 @@ public:
     
     void setUpdateInterval(int milliseconds);
     int updateInterval() const { return m_updateInterval; }
+    
+    // Advance one movement step if the update interval has elapsed since the last
+    // step; driven by the shared AircraftManager tick. Returns true if it moved.
+    bool advance(qint64 nowMs);
+    
+    // Change tracking for batched updates
+    DirtyFields dirtyFields() const { return m_dirtyFields; }
+    DirtyFields takeDirtyFields();
+    
+    // Per-field change signals are only emitted while enabled (the selected
+    // aircraft); all other changes are reported through AircraftManager::tickCompleted
+    void setChangeSignalsEnabled(bool enabled) { m_changeSignalsEnabled = enabled; }
+    bool changeSignalsEnabled() const { return m_changeSignalsEnabled; }
 
     // Flight route
     QString getFlightRouteId() const { return m_flightRouteId; }
     void setFlightRouteId(const QString& routeId) { m_flightRouteId = routeId; }
 
+    // Province under the aircraft, set by ReverseGeocoder; not persisted
+    QString province() const { return m_province; }
+    void setProvince(const QString& province) { m_province = province; }
+
     // Timestamps
     QDateTime getCreatedAt() const { return m_createdAt; }
     QDateTime getUpdatedAt() const { return m_updatedAt; }
@@ -78,19 +111,34 @@ public:
     // Flight trail tracking
     void setTrailEnabled(bool enabled) { m_trailEnabled = enabled; }
     bool isTrailEnabled() const { return m_trailEnabled; }
-    void setMaxTrailPoints(int maxPoints) { m_maxTrailPoints = maxPoints; }
-    int maxTrailPoints() const { return m_maxTrailPoints; }
-    QVector<QPointF> getTrail() const { return m_flightTrail; }
-    void clearTrail() { m_flightTrail.clear(); }
+    // At most trail.max_points: every trail lives in a pool slot of that size
+    void setMaxTrailPoints(int maxPoints) { m_trail.setCapacity(maxPoints); }
+    int maxTrailPoints() const { return m_trail.capacity(); }
+    const TrailBuffer& trail() const { return m_trail; }
+    void clearTrail() { m_trail.clear(); }
+    
+    // Trail decimation: a point is recorded only after moving at least
+    // minDistancePx (at the reference zoom) or turning by minHeadingChange degrees
+    void setTrailDecimation(double minDistancePx, double minHeadingChange);
 
     // Database operations
-    void saveToDatabase();
+    void saveToDatabase();     // Queued like updates, but flushed right away
     void loadFromDatabase(const QString& aircraftId);
-    void updateInDatabase();
-    void deleteFromDatabase();
+    void updateInDatabase();   // Queued on the persistence thread, returns immediately
+    void deleteFromDatabase(); // Queued behind any pending update of this aircraft
+    AircraftSnapshot snapshot() const;
     
     static QVector<Aircraft*> loadAllFromDatabase(QObject* parent = nullptr);
+    // Streams every stored aircraft through one query, handing them out in batches
+    // of batchSize; onBatch runs while the stream is open. Returns the number loaded.
+    static int streamAllFromDatabase(QObject* parent, int batchSize,
+                                     const std::function<void(const QVector<Aircraft*>&)>& onBatch);
+    // Loads the given aircraft in one query; ids that no longer exist are skipped
+    static QVector<Aircraft*> loadByIdsFromDatabase(const QStringList& aircraftIds, QObject* parent = nullptr);
     static bool existsInDatabase(const QString& aircraftId);
+    
+    // Take over a row written by another client without writing it back
+    void applyRemoteState(const Aircraft& remote);
 
 signals:
     void positionChanged(const QPointF& newPosition);
@@ -100,15 +148,19 @@ signals:
     void speedChanged(double newSpeed);
     void databaseOperationCompleted(bool success, const QString& message);
 
-private slots:
-    void updatePosition();
-
 private:
+    // Bare aircraft for the bulk loader, which fills in the stored fields itself
+    Aircraft(const QString& aircraftId, const QDateTime& createdAt, QObject* parent);
+    // Shared by the bulk loaders; a null aircraftIds streams every row
+    static int streamFromDatabase(QObject* parent, int batchSize, const QStringList* aircraftIds,
+                                  const std::function<void(const QVector<Aircraft*>&)>& onBatch);
+
     void updateHeadingFromVelocity();
     QPixmap createAircraftIcon(const QColor& color, bool highlighted = false);
-    QColor getStateColor() const;
     void generateAircraftId();
     void updateTimestamp();
+    void markDirty(DirtyField field) { m_dirtyFields |= field; }
+    void initializeTrail();
     void addTrailPoint(const QPointF& position);
     
     // Aircraft identification
@@ -126,14 +178,19 @@ private:
     
     // Flight planning
     QString m_flightRouteId;
+    QString m_province;
     
     // Timestamps
     QDateTime m_createdAt;
     QDateTime m_updatedAt;
     
-    QTimer* m_updateTimer;
     bool m_isMoving = false;
     int m_updateInterval = 1000; // 1 second
+    qint64 m_lastAdvanceMs = -1; // Tick clock time of the last step, -1 until the first tick
+    
+    // Batched change tracking
+    DirtyFields m_dirtyFields = NoChanges;
+    bool m_changeSignalsEnabled = false;
     
     // Visual properties
     static constexpr double AIRCRAFT_SIZE = 20.0; // Size in pixels
@@ -141,6 +198,10 @@ private:
 
     // Flight trail tracking
     bool m_trailEnabled = false;
-    int m_maxTrailPoints = 100;
-    QVector<QPointF> m_flightTrail;
+    TrailBuffer m_trail;
+    double m_trailMinDistanceWorld = 0.0; // Decimation distance in zoom-0 world pixels
+    double m_trailMinHeadingChange = 0.0;
+    double m_lastTrailHeading = 0.0;
 };
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(Aircraft::DirtyFields)
@@ -1,8 +1,27 @@
 #include "flightroute.h"
 #include "../core/configmanager.h"
+#include "../services/databaseservice.h"
+#include "../services/preparedstatements.h"
+#include "../services/databasemetrics.h"
 #include <QtMath>
 #include <QDebug>
+#include <QThreadPool>
 #include <pqxx/pqxx>
+#include <optional>
+
+namespace {
+
+// One thread, so writes of a route reach the database in the order they were made
+QThreadPool& routeWriter()
+{
+    struct Writer : QThreadPool {
+        Writer() { setMaxThreadCount(1); }
+    };
+    static Writer writer;
+    return writer;
+}
+
+} // namespace
 
 FlightRoute::FlightRoute(QObject *parent)
     : QObject(parent)
@@ -128,140 +147,83 @@ QDateTime FlightRoute::getEstimatedDuration() const
 
 void FlightRoute::saveToDatabase()
 {
-    try {
-        ConfigManager& config = ConfigManager::instance();
-        
-        QString connString = QString("host=%1 port=%2 dbname=%3 user=%4 password=%5 connect_timeout=%6")
-            .arg(config.getDatabaseHost())
-            .arg(config.getDatabasePort())
-            .arg(config.getDatabaseName())
-            .arg(config.getDatabaseUsername())
-            .arg(config.getDatabasePassword())
-            .arg(config.getDatabaseConnectionTimeout());
-        
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        // Create flight_routes table if not exists
-        QString createTableQuery = R"(
-            CREATE TABLE IF NOT EXISTS flight_routes (
-                id SERIAL PRIMARY KEY,
-                route_id VARCHAR(255) UNIQUE NOT NULL,
-                route_type INTEGER NOT NULL,
-                description TEXT,
-                color VARCHAR(20),
-                width INTEGER DEFAULT 2,
-                visible BOOLEAN DEFAULT true,
-                active BOOLEAN DEFAULT false,
-                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
-                updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
-            )
-        )";
-        
-        txn.exec(createTableQuery.toStdString());
-        
-        // Create waypoints table if not exists
-        QString createWaypointsQuery = R"(
-            CREATE TABLE IF NOT EXISTS route_waypoints (
-                id SERIAL PRIMARY KEY,
-                route_id VARCHAR(255) REFERENCES flight_routes(route_id) ON DELETE CASCADE,
-                waypoint_order INTEGER NOT NULL,
-                name VARCHAR(255),
-                longitude DOUBLE PRECISION NOT NULL,
-                latitude DOUBLE PRECISION NOT NULL,
-                altitude DOUBLE PRECISION DEFAULT 0,
-                estimated_time TIMESTAMP,
-                description TEXT,
-                UNIQUE(route_id, waypoint_order)
-            )
-        )";
-        
-        txn.exec(createWaypointsQuery.toStdString());
-        
-        // Insert or update route
-        QString upsertRouteQuery = R"(
-            INSERT INTO flight_routes (route_id, route_type, description, color, width, visible, active)
-            VALUES ($1, $2, $3, $4, $5, $6, $7)
-            ON CONFLICT (route_id) 
-            DO UPDATE SET 
-                route_type = EXCLUDED.route_type,
-                description = EXCLUDED.description,
-                color = EXCLUDED.color,
-                width = EXCLUDED.width,
-                visible = EXCLUDED.visible,
-                active = EXCLUDED.active,
-                updated_at = CURRENT_TIMESTAMP
-        )";
+    // Written from a copy on the route writer thread; the editor never waits on it
+    const std::string routeId = m_routeId.toStdString();
+    const int routeType = static_cast<int>(m_routeType);
+    const std::string description = m_description.toStdString();
+    const std::string color = m_color.name().toStdString();
+    const int width = m_width;
+    const bool visible = m_visible;
+    const bool active = m_active;
+    const QVector<Waypoint> waypoints = m_waypoints;
+
+    routeWriter().start([=]() {
+        try {
+            PooledConnection c = DatabaseService::instance().acquireConnection();
+            pqxx::work txn(*c);
+        
+            // Insert or update route (schema is owned by DatabaseService::createTables())
+            PreparedStatements::exec(txn, PreparedStatements::RouteUpsert,
+                routeId,
+                routeType,
+                description,
+                color,
+                width,
+                visible,
+                active
+            );
         
-        txn.exec_params(upsertRouteQuery.toStdString(),
-            m_routeId.toStdString(),
-            static_cast<int>(m_routeType),
-            m_description.toStdString(),
-            m_color.name().toStdString(),
-            m_width,
-            m_visible,
-            m_active
-        );
+            // Delete existing waypoints for this route
+            PreparedStatements::exec(txn, PreparedStatements::WaypointsDelete, routeId);
         
-        // Delete existing waypoints for this route
-        QString deleteWaypointsQuery = "DELETE FROM route_waypoints WHERE route_id = $1";
-        txn.exec_params(deleteWaypointsQuery.toStdString(), m_routeId.toStdString());
+            // Write all waypoints with one COPY so save time stays flat for long routes
+            DatabaseMetrics::Timer metrics("waypoints_copy");
+            auto stream = pqxx::stream_to::table(txn, {"route_waypoints"},
+                {"route_id", "waypoint_order", "name", "longitude", "latitude",
+                 "altitude", "estimated_time", "description"});
         
-        // Insert waypoints
-        for (int i = 0; i < m_waypoints.size(); ++i) {
-            const auto& waypoint = m_waypoints[i];
+            for (int i = 0; i < waypoints.size(); ++i) {
+                const auto& waypoint = waypoints[i];
             
-            QString insertWaypointQuery = R"(
-                INSERT INTO route_waypoints 
-                (route_id, waypoint_order, name, longitude, latitude, altitude, estimated_time, description)
-                VALUES ($1, $2, $3, $4, $5, $6, $7, $8)
-            )";
+                // Waypoints without an ETA are stored as NULL
+                std::optional<std::string> estimatedTime;
+                if (waypoint.estimatedTime.isValid()) {
+                    estimatedTime = waypoint.estimatedTime.toString(Qt::ISODate).toStdString();
+                }
             
-            txn.exec_params(insertWaypointQuery.toStdString(),
-                m_routeId.toStdString(),
-                i,
-                waypoint.name.toStdString(),
-                waypoint.position.x(),
-                waypoint.position.y(),
-                waypoint.altitude,
-                waypoint.estimatedTime.toString(Qt::ISODate).toStdString(),
-                waypoint.description.toStdString()
-            );
-        }
+                stream.write_values(
+                    routeId,
+                    i,
+                    waypoint.name.toStdString(),
+                    waypoint.position.x(),
+                    waypoint.position.y(),
+                    waypoint.altitude,
+                    estimatedTime,
+                    waypoint.description.toStdString()
+                );
+            }
+            stream.complete();
+            metrics.finish(static_cast<quint64>(waypoints.size()));
         
-        txn.commit();
+            txn.commit();
         
-        qDebug() << "Successfully saved flight route to database:" << m_routeId;
+            qDebug() << "Successfully saved flight route to database:" << QString::fromStdString(routeId);
         
-    } catch (const std::exception &e) {
-        qDebug() << "Error saving flight route to database:" << e.what();
-    }
+        } catch (const std::exception &e) {
+            qDebug() << "Error saving flight route to database:" << e.what();
+        }
+    });
 }
 
 void FlightRoute::loadFromDatabase(const QString& routeId)
 {
     try {
-        ConfigManager& config = ConfigManager::instance();
-        
-        QString connString = QString("host=%1 port=%2 dbname=%3 user=%4 password=%5 connect_timeout=%6")
-            .arg(config.getDatabaseHost())
-            .arg(config.getDatabasePort())
-            .arg(config.getDatabaseName())
-            .arg(config.getDatabaseUsername())
-            .arg(config.getDatabasePassword())
-            .arg(config.getDatabaseConnectionTimeout());
-        
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
+        PooledConnection c = DatabaseService::instance().acquireConnection();
+        pqxx::work txn(*c);
         
         // Load route details
-        QString routeQuery = R"(
-            SELECT route_type, description, color, width, visible, active
-            FROM flight_routes 
-            WHERE route_id = $1
-        )";
-        
-        pqxx::result routeResult = txn.exec_params(routeQuery.toStdString(), routeId.toStdString());
+        pqxx::result routeResult = PreparedStatements::exec(txn, PreparedStatements::RouteLoad,
+                                                            routeId.toStdString());
         
         if (routeResult.empty()) {
             qDebug() << "Route not found in database:" << routeId;
@@ -278,14 +240,8 @@ void FlightRoute::loadFromDatabase(const QString& routeId)
         m_active = row["active"].as<bool>();
         
         // Load waypoints
-        QString waypointsQuery = R"(
-            SELECT name, longitude, latitude, altitude, estimated_time, description
-            FROM route_waypoints 
-            WHERE route_id = $1 
-            ORDER BY waypoint_order
-        )";
-        
-        pqxx::result waypointsResult = txn.exec_params(waypointsQuery.toStdString(), routeId.toStdString());
+        pqxx::result waypointsResult = PreparedStatements::exec(txn, PreparedStatements::WaypointsLoad,
+                                                                routeId.toStdString());
         
         m_waypoints.clear();
         for (const auto& waypointRow : waypointsResult) {
@@ -296,10 +252,12 @@ void FlightRoute::loadFromDatabase(const QString& routeId)
                 waypointRow["latitude"].as<double>()
             );
             waypoint.altitude = waypointRow["altitude"].as<double>();
-            waypoint.estimatedTime = QDateTime::fromString(
-                QString::fromStdString(waypointRow["estimated_time"].as<std::string>()), 
-                Qt::ISODate
-            );
+            if (!waypointRow["estimated_time"].is_null()) {
+                waypoint.estimatedTime = QDateTime::fromString(
+                    QString::fromStdString(waypointRow["estimated_time"].as<std::string>()), 
+                    Qt::ISODate
+                );
+            }
             waypoint.description = QString::fromStdString(waypointRow["description"].as<std::string>());
             
             m_waypoints.append(waypoint);
@@ -317,31 +275,24 @@ void FlightRoute::loadFromDatabase(const QString& routeId)
 
 void FlightRoute::deleteFromDatabase()
 {
-    try {
-        ConfigManager& config = ConfigManager::instance();
-        
-        QString connString = QString("host=%1 port=%2 dbname=%3 user=%4 password=%5 connect_timeout=%6")
-            .arg(config.getDatabaseHost())
-            .arg(config.getDatabasePort())
-            .arg(config.getDatabaseName())
-            .arg(config.getDatabaseUsername())
-            .arg(config.getDatabasePassword())
-            .arg(config.getDatabaseConnectionTimeout());
+    // Same writer as saves, so a delete never overtakes an earlier save of the route
+    const QString routeId = m_routeId;
+    routeWriter().start([routeId]() {
+        try {
+            PooledConnection c = DatabaseService::instance().acquireConnection();
+            pqxx::work txn(*c);
         
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
+            // Delete route (waypoints will be cascade deleted)
+            PreparedStatements::exec(txn, PreparedStatements::RouteDelete, routeId.toStdString());
         
-        // Delete route (waypoints will be cascade deleted)
-        QString deleteQuery = "DELETE FROM flight_routes WHERE route_id = $1";
-        txn.exec_params(deleteQuery.toStdString(), m_routeId.toStdString());
+            txn.commit();
         
-        txn.commit();
+            qDebug() << "Successfully deleted flight route from database:" << routeId;
         
-        qDebug() << "Successfully deleted flight route from database:" << m_routeId;
-        
-    } catch (const std::exception &e) {
-        qDebug() << "Error deleting flight route from database:" << e.what();
-    }
+        } catch (const std::exception &e) {
+            qDebug() << "Error deleting flight route from database:" << e.what();
+        }
+    });
 }
 
 double FlightRoute::calculateDistance(const QPointF& point1, const QPointF& point2)
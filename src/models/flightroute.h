@@ -78,9 +78,9 @@ public:
     void setDescription(const QString& description) { m_description = description; }
 
     // Database operations
-    void saveToDatabase();
+    void saveToDatabase();     // Written on a background thread, in call order
     void loadFromDatabase(const QString& routeId);
-    void deleteFromDatabase();
+    void deleteFromDatabase(); // Likewise
 
     // Utility functions
     static double calculateDistance(const QPointF& point1, const QPointF& point2);
@@ -5,7 +5,7 @@
 #include <QBrush>
 
 PolygonObject::PolygonObject(const QPolygonF& polygon, QObject* parent)
-    : GeometryObject(parent), m_polygon(polygon) {
+    : GeometryObject(parent), m_polygon(polygon), m_prepared(polygon) {
 }
 
 PolygonObject::PolygonObject(QObject* parent)
@@ -44,7 +44,7 @@ void PolygonObject::render(QPainter& painter, const ViewTransform& transform) {
 }
 
 bool PolygonObject::containsPoint(const QPointF& geoPoint) {
-    return m_polygon.containsPoint(geoPoint, Qt::OddEvenFill);
+    return m_prepared.containsPoint(geoPoint);
 }
 
 QRectF PolygonObject::boundingBox() const {
@@ -65,6 +65,7 @@ QString PolygonObject::getInfo() const {
 void PolygonObject::setPolygon(const QPolygonF& polygon) {
     if (m_polygon != polygon) {
         m_polygon = polygon;
+        m_prepared = PreparedPolygon(polygon);
         emit objectChanged();
     }
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "../core/geometryobject.h"
+#include "../core/preparedpolygon.h"
 #include <QPolygonF>
 #include <QColor>
 #include <QPen>
@@ -23,6 +24,7 @@ public:
     // Polygon-specific methods
     void setPolygon(const QPolygonF& polygon);
     QPolygonF polygon() const { return m_polygon; }
+    const PreparedPolygon& prepared() const { return m_prepared; }
     
     void setFillColor(const QColor& color);
     void setBorderColor(const QColor& color);
@@ -37,6 +39,7 @@ protected:
 
 private:
     QPolygonF m_polygon;
+    PreparedPolygon m_prepared; // Grid index rebuilt whenever the polygon changes
     QColor m_fillColor = QColor(255, 0, 0, 100); // Semi-transparent red
     QColor m_borderColor = Qt::red;
     int m_borderWidth = 2;
@@ -0,0 +1,117 @@
+#include "changelistener.h"
+#include "../core/configmanager.h"
+#include <QDebug>
+#include <pqxx/pqxx>
+
+namespace {
+
+constexpr long PollIntervalUs = 100 * 1000;
+constexpr int MinReconnectDelayMs = 1000;
+constexpr int MaxReconnectDelayMs = 30000;
+
+} // namespace
+
+class ChangeListener::Receiver : public pqxx::notification_receiver {
+public:
+    Receiver(pqxx::connection& connection, ChangeListener* owner)
+        : pqxx::notification_receiver(connection, ChangeListener::Channel)
+        , m_owner(owner)
+    {
+    }
+
+    void operator()(const std::string& payload, int backendPid) override
+    {
+        Q_UNUSED(backendPid)
+        m_owner->handlePayload(payload);
+    }
+
+private:
+    ChangeListener* m_owner;
+};
+
+ChangeListener& ChangeListener::instance()
+{
+    static ChangeListener instance;
+    return instance;
+}
+
+ChangeListener::ChangeListener()
+{
+    qRegisterMetaType<DatabaseChanges>("DatabaseChanges");
+    m_coalesceMs = qMax(0, ConfigManager::instance().getChangeNotificationCoalesceInterval());
+    setObjectName("ChangeListener");
+}
+
+ChangeListener::~ChangeListener()
+{
+    shutdown();
+}
+
+void ChangeListener::listen(const QString& connectionString, const QString& ownApplicationName)
+{
+    if (isRunning()) return;
+
+    m_connectionString = connectionString;
+    m_ownApplicationName = ownApplicationName;
+    m_stopping = false;
+    start(QThread::LowPriority);
+}
+
+void ChangeListener::shutdown()
+{
+    m_stopping = true;
+    wait(); // The poll interval bounds how long this blocks
+}
+
+void ChangeListener::run()
+{
+    int reconnectDelayMs = MinReconnectDelayMs;
+    bool connectedBefore = false;
+
+    while (!m_stopping) {
+        try {
+            pqxx::connection connection(m_connectionString.toStdString());
+            Receiver receiver(connection, this);
+            qDebug() << "Listening for database changes on" << Channel;
+
+            // Anything that happened while disconnected was not delivered
+            if (connectedBefore) {
+                m_pending.resync = true;
+                publishPending(true);
+            }
+            connectedBefore = true;
+            reconnectDelayMs = MinReconnectDelayMs;
+
+            while (!m_stopping) {
+                connection.await_notification(0, PollIntervalUs);
+                publishPending(false);
+            }
+        } catch (const std::exception &e) {
+            qDebug() << "Change listener connection lost:" << e.what();
+        }
+
+        // Back off before reconnecting, staying responsive to shutdown
+        for (int waited = 0; waited < reconnectDelayMs && !m_stopping; waited += 100) {
+            msleep(100);
+        }
+        reconnectDelayMs = qMin(reconnectDelayMs * 2, MaxReconnectDelayMs);
+    }
+}
+
+void ChangeListener::handlePayload(const std::string& payload)
+{
+    const bool wasEmpty = m_pending.isEmpty();
+    if (m_pending.addNotification(payload, m_ownApplicationName) && wasEmpty) {
+        m_pendingSince.start();
+    }
+}
+
+void ChangeListener::publishPending(bool force)
+{
+    if (m_pending.isEmpty()) return;
+    if (!force && m_pendingSince.elapsed() < m_coalesceMs) return;
+
+    DatabaseChanges changes;
+    std::swap(changes, m_pending);
+    emit changesReceived(changes);
+}
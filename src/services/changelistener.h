@@ -0,0 +1,56 @@
+#pragma once
+#include "databasechanges.h"
+#include <QThread>
+#include <QString>
+#include <QElapsedTimer>
+#include <atomic>
+#include <string>
+
+/**
+ * @brief LISTEN/NOTIFY receiver for changes made by other workstations
+ *
+ * Triggers installed by DatabaseService::createTables() notify on every row
+ * change of polygon_regions and flight_routes, and on aircraft inserts,
+ * deletes and updates of anything but the movement columns (position,
+ * altitude, speed, heading, velocity, timestamps), which the persistence
+ * worker rewrites every flush. This thread listens
+ * on its own dedicated connection, drops notifications that originate from
+ * this process (matched by application_name), coalesces the rest for a short
+ * interval and publishes them as one changesReceived() batch.
+ */
+class ChangeListener : public QThread {
+    Q_OBJECT
+public:
+    static constexpr const char* Channel = "gismap_changes";
+
+    static ChangeListener& instance();
+
+    // Start listening; notifications carrying ownApplicationName are ignored
+    void listen(const QString& connectionString, const QString& ownApplicationName);
+    void shutdown();
+
+signals:
+    // Emitted from the listener thread; connect with a queued (default) connection
+    void changesReceived(const DatabaseChanges& changes);
+
+protected:
+    void run() override;
+
+private:
+    ChangeListener();
+    ~ChangeListener();
+
+    class Receiver;
+
+    void handlePayload(const std::string& payload);
+    void publishPending(bool force);
+
+    QString m_connectionString;
+    QString m_ownApplicationName;
+    std::atomic_bool m_stopping{false};
+
+    // Listener thread only
+    DatabaseChanges m_pending;
+    QElapsedTimer m_pendingSince;
+    int m_coalesceMs;
+};
@@ -0,0 +1,44 @@
+#include "circuitbreaker.h"
+#include <QtGlobal>
+
+CircuitBreaker::CircuitBreaker(int failureThreshold, int minProbeDelayMs, int maxProbeDelayMs)
+    : m_failureThreshold(qMax(1, failureThreshold))
+    , m_minProbeDelayMs(qMax(1, minProbeDelayMs))
+    , m_maxProbeDelayMs(qMax(m_minProbeDelayMs, maxProbeDelayMs))
+    , m_probeDelayMs(m_minProbeDelayMs)
+{
+}
+
+CircuitBreaker::Transition CircuitBreaker::recordFailure()
+{
+    const int failures = ++m_failures;
+    return moveTo(failures >= m_failureThreshold ? Offline : Degraded);
+}
+
+CircuitBreaker::Transition CircuitBreaker::recordSuccess()
+{
+    m_failures = 0;
+    return moveTo(Connected);
+}
+
+CircuitBreaker::Transition CircuitBreaker::trip()
+{
+    return moveTo(Offline);
+}
+
+int CircuitBreaker::probeFailed()
+{
+    const int delay = qMin(m_probeDelayMs.load() * 2, m_maxProbeDelayMs);
+    m_probeDelayMs = delay;
+    return delay;
+}
+
+CircuitBreaker::Transition CircuitBreaker::moveTo(State state)
+{
+    const State previous = static_cast<State>(m_state.exchange(state));
+    if (previous != Offline && state == Offline) {
+        // A new outage; probing starts quickly again
+        m_probeDelayMs = m_minProbeDelayMs;
+    }
+    return Transition{previous, state};
+}
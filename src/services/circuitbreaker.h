@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+
+/**
+ * @brief Connection health state machine behind DatabaseService
+ *
+ * Failed connection attempts in a row first make the server Degraded, where
+ * it is still tried, and at the threshold Offline, where callers fail fast
+ * and only probes reach the server. Any success returns it to Connected.
+ * Each failed probe doubles the delay to the next one up to the maximum, and
+ * every new outage starts again from the minimum. Any thread may report;
+ * each call returns the transition it caused, so exactly one caller sees a
+ * given change and acts on it.
+ */
+class CircuitBreaker {
+public:
+    enum State {
+        Connected,
+        Degraded,
+        Offline
+    };
+
+    struct Transition {
+        State from;
+        State to;
+        bool changed() const { return from != to; }
+    };
+
+    CircuitBreaker(int failureThreshold, int minProbeDelayMs, int maxProbeDelayMs);
+
+    State state() const { return static_cast<State>(m_state.load()); }
+    int consecutiveFailures() const { return m_failures.load(); }
+    int probeDelayMs() const { return m_probeDelayMs.load(); }
+
+    Transition recordFailure();
+    Transition recordSuccess();
+    // Nothing works yet (startup could not connect or set up the schema); wait for a probe
+    Transition trip();
+
+    // Returns the delay before the next probe
+    int probeFailed();
+
+private:
+    Transition moveTo(State state);
+
+    const int m_failureThreshold;
+    const int m_minProbeDelayMs;
+    const int m_maxProbeDelayMs;
+    std::atomic_int m_state{Connected};
+    std::atomic_int m_failures{0};
+    std::atomic_int m_probeDelayMs;
+};
@@ -0,0 +1,172 @@
+#include "connectionpool.h"
+#include <QDeadlineTimer>
+#include <QDebug>
+#include <pqxx/pqxx>
+#include <stdexcept>
+
+PooledConnection::PooledConnection(ConnectionPool* pool, std::unique_ptr<pqxx::connection> connection,
+                                   quint64 generation)
+    : m_pool(pool)
+    , m_connection(std::move(connection))
+    , m_generation(generation)
+{
+}
+
+PooledConnection::PooledConnection(PooledConnection&& other) noexcept
+    : m_pool(other.m_pool)
+    , m_connection(std::move(other.m_connection))
+    , m_generation(other.m_generation)
+{
+    other.m_pool = nullptr;
+}
+
+PooledConnection::~PooledConnection()
+{
+    if (m_pool) {
+        m_pool->release(std::move(m_connection), m_generation);
+    }
+}
+
+ConnectionPool::ConnectionPool(const QString& connectionString, int maxConnections,
+                               int checkoutTimeoutMs, int healthCheckIntervalMs)
+    : m_connectionString(connectionString)
+    , m_maxConnections(qMax(1, maxConnections))
+    , m_checkoutTimeoutMs(checkoutTimeoutMs)
+    , m_healthCheckIntervalMs(healthCheckIntervalMs)
+{
+    m_clock.start();
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    closeIdle();
+}
+
+PooledConnection ConnectionPool::acquire()
+{
+    std::unique_ptr<pqxx::connection> connection;
+    std::function<void(pqxx::connection&)> initializer;
+    qint64 idleSince = 0;
+    quint64 generation = 0;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        initializer = m_initializer;
+        generation = m_generation;
+        QDeadlineTimer deadline(m_checkoutTimeoutMs);
+
+        while (m_idle.empty() && m_open >= m_maxConnections) {
+            if (!m_available.wait(&m_mutex, deadline)) {
+                throw std::runtime_error("Timed out waiting for a pooled database connection");
+            }
+        }
+
+        if (!m_idle.empty()) {
+            connection = std::move(m_idle.back().connection);
+            idleSince = m_idle.back().idleSince;
+            generation = m_idle.back().generation;
+            m_idle.pop_back();
+        } else {
+            ++m_open; // Reserve the slot; the handshake happens outside the lock
+        }
+    }
+
+    // Health check outside the lock; a dead connection keeps its slot for the replacement
+    if (connection && !isHealthy(*connection, idleSince)) {
+        qDebug() << "Discarding broken pooled database connection, reconnecting";
+        connection.reset();
+    }
+
+    if (!connection) {
+        try {
+            connection = std::make_unique<pqxx::connection>(m_connectionString.toStdString());
+            if (initializer) {
+                initializer(*connection);
+            }
+        } catch (...) {
+            QMutexLocker locker(&m_mutex);
+            --m_open;
+            m_available.wakeOne();
+            throw;
+        }
+    }
+
+    return PooledConnection(this, std::move(connection), generation);
+}
+
+void ConnectionPool::setConnectionInitializer(std::function<void(pqxx::connection&)> initializer)
+{
+    std::vector<IdleConnection> closing;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_initializer = std::move(initializer);
+        ++m_generation;
+
+        // Idle connections lack what the new initializer sets up; checked out ones are dropped on release
+        closing.swap(m_idle);
+        m_open -= static_cast<int>(closing.size());
+        m_available.wakeAll();
+    }
+}
+
+int ConnectionPool::openConnections() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_open;
+}
+
+int ConnectionPool::idleConnections() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_idle.size());
+}
+
+void ConnectionPool::closeIdle()
+{
+    std::vector<IdleConnection> closing;
+    {
+        QMutexLocker locker(&m_mutex);
+        closing.swap(m_idle);
+        m_open -= static_cast<int>(closing.size());
+        m_available.wakeAll();
+    }
+    // Connections close here, outside the lock
+}
+
+void ConnectionPool::release(std::unique_ptr<pqxx::connection> connection, quint64 generation)
+{
+    bool reusable = connection && connection->is_open();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        // Checked out before the current initializer was installed, so never set up by it
+        if (reusable && generation == m_generation) {
+            m_idle.push_back(IdleConnection{std::move(connection), m_clock.elapsed(), generation});
+        } else {
+            --m_open;
+        }
+        m_available.wakeOne();
+    }
+    // A discarded connection closes here, outside the lock
+}
+
+bool ConnectionPool::isHealthy(pqxx::connection& connection, qint64 idleSince) const
+{
+    if (!connection.is_open()) {
+        return false;
+    }
+
+    // Recently used connections are trusted; only long idle ones pay for a round trip
+    if (m_clock.elapsed() - idleSince < m_healthCheckIntervalMs) {
+        return true;
+    }
+
+    try {
+        pqxx::nontransaction txn(connection);
+        txn.exec("SELECT 1");
+        return true;
+    } catch (const std::exception& e) {
+        qDebug() << "Pooled connection failed health check:" << e.what();
+        return false;
+    }
+}
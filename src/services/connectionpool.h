@@ -0,0 +1,97 @@
+#pragma once
+#include <QString>
+#include <QtGlobal>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace pqxx {
+class connection;
+}
+
+class ConnectionPool;
+
+/**
+ * @brief Scoped checkout of a pooled database connection
+ *
+ * Returns the connection to its pool when it goes out of scope. Connections
+ * that were closed while checked out (for example by pqxx::broken_connection)
+ * are discarded instead of returned.
+ */
+class PooledConnection {
+public:
+    PooledConnection(PooledConnection&& other) noexcept;
+    PooledConnection(const PooledConnection&) = delete;
+    PooledConnection& operator=(const PooledConnection&) = delete;
+    PooledConnection& operator=(PooledConnection&&) = delete;
+    ~PooledConnection();
+
+    pqxx::connection& operator*() const { return *m_connection; }
+    pqxx::connection* operator->() const { return m_connection.get(); }
+
+private:
+    friend class ConnectionPool;
+    PooledConnection(ConnectionPool* pool, std::unique_ptr<pqxx::connection> connection, quint64 generation);
+
+    ConnectionPool* m_pool;
+    std::unique_ptr<pqxx::connection> m_connection;
+    quint64 m_generation; // Initializer generation the connection was set up with
+};
+
+/**
+ * @brief Thread-safe pool of persistent PostgreSQL connections
+ *
+ * At most maxConnections are open at once; callers block until one is free or
+ * the checkout timeout expires. Idle connections are validated before reuse and
+ * replaced transparently when the server dropped them.
+ */
+class ConnectionPool {
+public:
+    ConnectionPool(const QString& connectionString, int maxConnections,
+                   int checkoutTimeoutMs, int healthCheckIntervalMs);
+    ~ConnectionPool();
+
+    // Throws std::runtime_error on timeout and pqxx exceptions when connecting fails
+    PooledConnection acquire();
+
+    // Runs once on every newly opened connection before it is handed out
+    // (session setup, prepared statements). Throwing discards the connection.
+    // Connections set up with a previous initializer, idle or checked out, are
+    // discarded instead of reused.
+    void setConnectionInitializer(std::function<void(pqxx::connection&)> initializer);
+
+    int maxConnections() const { return m_maxConnections; }
+    int openConnections() const;
+    int idleConnections() const;
+
+    // Close every idle connection; checked out connections close on return
+    void closeIdle();
+
+private:
+    friend class PooledConnection;
+
+    struct IdleConnection {
+        std::unique_ptr<pqxx::connection> connection;
+        qint64 idleSince;
+        quint64 generation;
+    };
+
+    void release(std::unique_ptr<pqxx::connection> connection, quint64 generation);
+    bool isHealthy(pqxx::connection& connection, qint64 idleSince) const;
+
+    QString m_connectionString;
+    int m_maxConnections;
+    int m_checkoutTimeoutMs;
+    int m_healthCheckIntervalMs;
+    std::function<void(pqxx::connection&)> m_initializer;
+    quint64 m_generation = 0;           // Bumped by every setConnectionInitializer()
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_available;
+    std::vector<IdleConnection> m_idle; // Most recently returned last
+    int m_open = 0;                     // Idle plus checked out, including ones being opened
+    QElapsedTimer m_clock;
+};
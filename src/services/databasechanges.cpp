@@ -0,0 +1,50 @@
+#include "databasechanges.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+void applyChange(QSet<QString>& changed, QSet<QString>& removed, const QString& id, bool deleted)
+{
+    if (deleted) {
+        changed.remove(id);
+        removed.insert(id);
+    } else {
+        removed.remove(id);
+        changed.insert(id);
+    }
+}
+
+} // namespace
+
+bool DatabaseChanges::isEmpty() const
+{
+    return !resync
+        && regionsChanged.isEmpty() && regionsRemoved.isEmpty()
+        && aircraftChanged.isEmpty() && aircraftRemoved.isEmpty()
+        && routesChanged.isEmpty() && routesRemoved.isEmpty();
+}
+
+bool DatabaseChanges::addNotification(const std::string& payload, const QString& ownOrigin)
+{
+    QJsonObject change = QJsonDocument::fromJson(QByteArray::fromStdString(payload)).object();
+    if (change.value("origin").toString() == ownOrigin) {
+        return false; // Our own write; the local model already has it
+    }
+
+    const QString table = change.value("table").toString();
+    const QString id = change.value("id").toString();
+    const bool deleted = change.value("op").toString() == "delete";
+    if (id.isEmpty()) return false;
+
+    if (table == "polygon_regions") {
+        applyChange(regionsChanged, regionsRemoved, id, deleted);
+    } else if (table == "aircraft") {
+        applyChange(aircraftChanged, aircraftRemoved, id, deleted);
+    } else if (table == "flight_routes") {
+        applyChange(routesChanged, routesRemoved, id, deleted);
+    } else {
+        return false;
+    }
+    return true;
+}
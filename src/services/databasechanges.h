@@ -0,0 +1,25 @@
+#pragma once
+#include <QSet>
+#include <QString>
+#include <QMetaType>
+#include <string>
+
+/**
+ * @brief Row ids changed by other clients since the last notification batch
+ */
+struct DatabaseChanges {
+    QSet<QString> regionsChanged;
+    QSet<QString> regionsRemoved;
+    QSet<QString> aircraftChanged;
+    QSet<QString> aircraftRemoved;
+    QSet<QString> routesChanged;
+    QSet<QString> routesRemoved;
+    bool resync = false; // Notifications may have been missed; reload instead of applying deltas
+
+    bool isEmpty() const;
+
+    // Folds one trigger payload in, the latest operation on a row winning; false
+    // when it was ignored (written by ownOrigin, no id or an unknown table)
+    bool addNotification(const std::string& payload, const QString& ownOrigin);
+};
+Q_DECLARE_METATYPE(DatabaseChanges)
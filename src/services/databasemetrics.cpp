@@ -0,0 +1,232 @@
+#include "databasemetrics.h"
+#include "databaseservice.h"
+#include "persistenceworker.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QDateTime>
+#include <QFile>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+QJsonObject histogramToJson(const DatabaseMetrics::Histogram& histogram)
+{
+    QJsonArray buckets;
+    for (int i = 0; i < DatabaseMetrics::BucketCount; ++i) {
+        QJsonObject bucket;
+        bucket["le_ms"] = i < static_cast<int>(DatabaseMetrics::BucketBoundsMs.size())
+                              ? QJsonValue(DatabaseMetrics::BucketBoundsMs[i]) : QJsonValue("inf");
+        bucket["count"] = static_cast<double>(histogram.buckets[i]);
+        buckets.append(bucket);
+    }
+
+    QJsonObject json;
+    json["count"] = static_cast<double>(histogram.count);
+    json["mean_ms"] = histogram.meanMs();
+    json["p50_ms"] = histogram.percentile(0.50);
+    json["p95_ms"] = histogram.percentile(0.95);
+    json["p99_ms"] = histogram.percentile(0.99);
+    json["max_ms"] = histogram.maxMs;
+    json["buckets"] = buckets;
+    return json;
+}
+
+} // namespace
+
+void DatabaseMetrics::Histogram::add(double ms)
+{
+    auto bound = std::lower_bound(BucketBoundsMs.begin(), BucketBoundsMs.end(), ms);
+    ++buckets[static_cast<std::size_t>(bound - BucketBoundsMs.begin())];
+    ++count;
+    totalMs += ms;
+    maxMs = qMax(maxMs, ms);
+}
+
+double DatabaseMetrics::Histogram::percentile(double quantile) const
+{
+    if (count == 0) return 0.0;
+
+    const quint64 rank = static_cast<quint64>(std::ceil(quantile * count));
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += buckets[i];
+        if (seen >= rank && buckets[i] > 0) {
+            return i < static_cast<int>(BucketBoundsMs.size()) ? qMin(BucketBoundsMs[i], maxMs) : maxMs;
+        }
+    }
+    return maxMs;
+}
+
+DatabaseMetrics::Timer::Timer(const char* statement)
+    : m_statement(statement)
+{
+    m_clock.start();
+}
+
+DatabaseMetrics::Timer::~Timer()
+{
+    if (!m_finished) {
+        DatabaseMetrics::instance().recordStatement(m_statement, m_clock.nsecsElapsed() / 1e6, 0, 0, false);
+    }
+}
+
+void DatabaseMetrics::Timer::finish(quint64 rows, quint64 bytes)
+{
+    if (m_finished) return;
+    m_finished = true;
+    DatabaseMetrics::instance().recordStatement(m_statement, m_clock.nsecsElapsed() / 1e6, rows, bytes, true);
+}
+
+DatabaseMetrics& DatabaseMetrics::instance()
+{
+    static DatabaseMetrics instance;
+    return instance;
+}
+
+DatabaseMetrics::DatabaseMetrics()
+{
+    m_since.start();
+}
+
+void DatabaseMetrics::recordStatement(const QString& statement, double ms, quint64 rows, quint64 bytes, bool ok)
+{
+    QMutexLocker locker(&m_mutex);
+    StatementStats& stats = m_statements[statement];
+    if (stats.name.isEmpty()) {
+        stats.name = statement;
+    }
+    stats.latency.add(ms);
+    stats.rows += rows;
+    stats.bytes += bytes;
+    if (!ok) {
+        ++stats.errors;
+    }
+}
+
+void DatabaseMetrics::recordPoolWait(double ms, bool ok)
+{
+    QMutexLocker locker(&m_mutex);
+    m_poolWait.add(ms);
+    if (!ok) {
+        ++m_poolFailures;
+    }
+}
+
+void DatabaseMetrics::recordOperationError(const QString& operation)
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_operationErrors[operation];
+}
+
+QVector<DatabaseMetrics::StatementStats> DatabaseMetrics::statements() const
+{
+    QMutexLocker locker(&m_mutex);
+    QVector<StatementStats> statements;
+    statements.reserve(m_statements.size());
+    for (const StatementStats& stats : m_statements) {
+        statements.append(stats);
+    }
+    locker.unlock();
+
+    // Most total time first: that is where tuning pays off
+    std::sort(statements.begin(), statements.end(), [](const StatementStats& a, const StatementStats& b) {
+        return a.latency.totalMs > b.latency.totalMs;
+    });
+    return statements;
+}
+
+DatabaseMetrics::Histogram DatabaseMetrics::poolWait() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_poolWait;
+}
+
+quint64 DatabaseMetrics::poolFailures() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_poolFailures;
+}
+
+QHash<QString, quint64> DatabaseMetrics::operationErrors() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_operationErrors;
+}
+
+qint64 DatabaseMetrics::uptimeMs() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_since.elapsed();
+}
+
+QJsonObject DatabaseMetrics::toJson() const
+{
+    const qint64 uptime = qMax<qint64>(1, uptimeMs());
+
+    QJsonArray statementsJson;
+    for (const StatementStats& stats : statements()) {
+        QJsonObject json;
+        json["name"] = stats.name;
+        json["latency"] = histogramToJson(stats.latency);
+        json["errors"] = static_cast<double>(stats.errors);
+        json["error_rate"] = stats.latency.count ? double(stats.errors) / stats.latency.count : 0.0;
+        json["rows"] = static_cast<double>(stats.rows);
+        json["bytes"] = static_cast<double>(stats.bytes);
+        json["calls_per_second"] = stats.latency.count * 1000.0 / uptime;
+        statementsJson.append(json);
+    }
+
+    DatabaseService& dbService = DatabaseService::instance();
+    QJsonObject pool;
+    pool["wait"] = histogramToJson(poolWait());
+    pool["failures"] = static_cast<double>(poolFailures());
+    if (ConnectionPool* connectionPool = dbService.connectionPool()) {
+        pool["open"] = connectionPool->openConnections();
+        pool["idle"] = connectionPool->idleConnections();
+    }
+
+    QJsonObject queue;
+    queue["pending_aircraft"] = PersistenceWorker::instance().pendingCount();
+    queue["pending_samples"] = PersistenceWorker::instance().pendingSampleCount();
+
+    QJsonObject errors;
+    const QHash<QString, quint64> operationErrors = this->operationErrors();
+    for (auto it = operationErrors.cbegin(); it != operationErrors.cend(); ++it) {
+        errors[it.key()] = static_cast<double>(it.value());
+    }
+
+    static const char* const healthNames[] = { "connected", "degraded", "offline" };
+
+    QJsonObject json;
+    json["generated_at"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs);
+    json["uptime_ms"] = static_cast<double>(uptime);
+    json["health"] = healthNames[dbService.health()];
+    json["statements"] = statementsJson;
+    json["pool"] = pool;
+    json["persistence_queue"] = queue;
+    json["operation_errors"] = errors;
+    return json;
+}
+
+bool DatabaseMetrics::writeJson(const QString& path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "Cannot write database metrics to" << path << ":" << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(toJson()).toJson(QJsonDocument::Indented));
+    return true;
+}
+
+void DatabaseMetrics::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_statements.clear();
+    m_poolWait = Histogram();
+    m_poolFailures = 0;
+    m_operationErrors.clear();
+    m_since.restart();
+}
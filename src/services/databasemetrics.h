@@ -0,0 +1,87 @@
+#pragma once
+#include <QMutex>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <array>
+
+/**
+ * @brief Process-wide counters and latency histograms for database work
+ *
+ * Every prepared statement is recorded by PreparedStatements::exec(); bulk
+ * paths (COPY streams, viewport queries) use a Timer. Connection checkouts
+ * are recorded separately as pool waits. All methods are thread-safe.
+ */
+class DatabaseMetrics {
+public:
+    // Upper bounds in milliseconds of the histogram buckets; the last bucket is open
+    static constexpr std::array<double, 13> BucketBoundsMs = {
+        0.5, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000
+    };
+    static constexpr int BucketCount = static_cast<int>(BucketBoundsMs.size()) + 1;
+
+    struct Histogram {
+        std::array<quint64, BucketCount> buckets{};
+        quint64 count = 0;
+        double totalMs = 0.0;
+        double maxMs = 0.0;
+
+        void add(double ms);
+        // Upper bound of the bucket holding the quantile (0..1); maxMs for the open bucket
+        double percentile(double quantile) const;
+        double meanMs() const { return count ? totalMs / count : 0.0; }
+    };
+
+    struct StatementStats {
+        QString name;
+        Histogram latency;
+        quint64 errors = 0;
+        quint64 rows = 0;
+        quint64 bytes = 0;
+    };
+
+    /**
+     * @brief Scoped measurement of one statement; records an error unless finished
+     */
+    class Timer {
+    public:
+        explicit Timer(const char* statement);
+        ~Timer();
+
+        void finish(quint64 rows, quint64 bytes = 0);
+
+    private:
+        const char* m_statement;
+        QElapsedTimer m_clock;
+        bool m_finished = false;
+    };
+
+    static DatabaseMetrics& instance();
+
+    void recordStatement(const QString& statement, double ms, quint64 rows, quint64 bytes, bool ok);
+    void recordPoolWait(double ms, bool ok);
+    void recordOperationError(const QString& operation);
+
+    QVector<StatementStats> statements() const;
+    Histogram poolWait() const;
+    quint64 poolFailures() const;
+    QHash<QString, quint64> operationErrors() const;
+    qint64 uptimeMs() const;
+
+    // Statements, pool, persistence queue depth and health as one document
+    QJsonObject toJson() const;
+    bool writeJson(const QString& path) const;
+    void reset();
+
+private:
+    DatabaseMetrics();
+
+    mutable QMutex m_mutex;
+    QHash<QString, StatementStats> m_statements;
+    Histogram m_poolWait;
+    quint64 m_poolFailures = 0;
+    QHash<QString, quint64> m_operationErrors;
+    QElapsedTimer m_since;
+};
@@ -2,10 +2,61 @@
 #include "../models/aircraft.h"
 #include "../models/flightroute.h"
 #include "../core/configmanager.h"
+#include "persistenceworker.h"
+#include "preparedstatements.h"
+#include "changelistener.h"
+#include "databasemetrics.h"
 #include <QDebug>
+#include <QThreadPool>
+#include <QTimer>
+#include <QElapsedTimer>
 #include <QUuid>
+#include <QStringList>
 #include <pqxx/pqxx>
 
+namespace {
+
+const QString HistoryPartitionPrefix = QStringLiteral("position_history_");
+
+// Decodes an ST_AsBinary column into the region; buffer is reused across rows.
+// libpqxx 7 only requests text-format results, so bytea arrives hex-encoded and
+// is decoded in one pass into the reused buffer before the in-place WKB parse
+void readRegionGeometry(const pqxx::field& field, QByteArray& buffer,
+                        DatabaseService::PolygonRegion& region)
+{
+    region.parts.clear();
+    if (field.is_null() || !WkbReader::decodeByteaHex(field.c_str(), field.size(), buffer)) {
+        return;
+    }
+    
+    WkbReader reader(buffer.constData(), static_cast<std::size_t>(buffer.size()));
+    if (!reader.readPolygons(region.parts)) {
+        region.parts.clear();
+        return;
+    }
+    
+    if (!region.parts.isEmpty()) {
+        region.polygon = region.parts.first().first();
+    }
+}
+
+// WKB for a region; the edited outline replaces the first exterior ring, other rings are kept
+std::basic_string<std::byte> regionToWkb(const DatabaseService::PolygonRegion& region)
+{
+    QVector<WkbReader::Polygon> parts = region.parts;
+    if (parts.isEmpty() || parts.first().isEmpty()) {
+        parts = { WkbReader::Polygon{ region.polygon } };
+    } else {
+        parts.first().first() = region.polygon;
+    }
+    
+    QByteArray wkb = WkbWriter::writePolygons(parts);
+    return std::basic_string<std::byte>(reinterpret_cast<const std::byte*>(wkb.constData()),
+                                        static_cast<std::size_t>(wkb.size()));
+}
+
+} // namespace
+
 DatabaseService* DatabaseService::s_instance = nullptr;
 
 DatabaseService& DatabaseService::instance()
@@ -18,8 +69,18 @@ DatabaseService& DatabaseService::instance()
 
 DatabaseService::DatabaseService(QObject* parent)
     : QObject(parent)
+    // Unique per process so change notifications caused by our own writes can be told apart
+    , m_applicationName(QString("gismap-%1").arg(QUuid::createUuid().toString(QUuid::Id128).left(12)))
 {
-    connectToDatabase();
+    ConfigManager& config = ConfigManager::instance();
+    m_pool = std::make_unique<ConnectionPool>(buildConnectionString(),
+                                              config.getDatabaseMaxConnections(),
+                                              config.getDatabaseConnectionTimeout() * 1000,
+                                              config.getDatabaseHealthCheckInterval() * 1000);
+    m_breaker = std::make_unique<CircuitBreaker>(config.getDatabaseFailureThreshold(),
+                                                 qMax(100, config.getDatabaseProbeMinInterval()),
+                                                 config.getDatabaseProbeMaxInterval());
+    // Connecting may wait up to connect_timeout; callers choose when and on which thread
 }
 
 DatabaseService::~DatabaseService()
@@ -30,22 +91,30 @@ DatabaseService::~DatabaseService()
 bool DatabaseService::connectToDatabase()
 {
     try {
-        // Test connection using ConfigManager
-        ConfigManager& config = ConfigManager::instance();
-        
-        QString connString = buildConnectionString();
-        pqxx::connection testConn(connString.toStdString());
+        // Opening the first pooled connection doubles as the connectivity test
+        bool open = acquireConnection()->is_open();
         
-        if (testConn.is_open()) {
+        // Connected only once the schema exists and the pool prepares statements;
+        // before that, layers and the persistence worker must not rely on either
+        if (open && createTables()) {
             m_connected = true;
-            createTables(); // Ensure all tables exist
             
             qDebug() << "Successfully connected to database";
             emit databaseConnected();
             return true;
         }
+        
+        if (open) {
+            // Reachable but unusable; stay disconnected and let the offline probe retry startup
+            m_connected = false;
+            applyHealth(m_breaker->trip());
+            QString error = "Database schema could not be created or verified";
+            emit databaseError(error);
+        }
     } catch (const std::exception &e) {
         m_connected = false;
+        // Nothing works without the first connection; stop trying until a probe succeeds
+        applyHealth(m_breaker->trip());
         QString error = QString("Database connection failed: %1").arg(e.what());
         logError("Database Connection", error);
         emit databaseError(error);
@@ -54,33 +123,118 @@ bool DatabaseService::connectToDatabase()
     return false;
 }
 
+void DatabaseService::connectInBackground()
+{
+    if (m_connected || m_connecting.exchange(true)) {
+        return;
+    }
+    
+    QThreadPool::globalInstance()->start([this]() {
+        connectToDatabase();
+        m_connecting = false;
+    });
+}
+
 void DatabaseService::disconnectFromDatabase()
 {
     if (m_connected) {
         m_connected = false;
+        m_pool->closeIdle();
         qDebug() << "Disconnected from database";
         emit databaseDisconnected();
     }
 }
 
+PooledConnection DatabaseService::acquireConnection()
+{
+    if (health() == Offline) {
+        throw pqxx::broken_connection("Database offline, waiting for the next probe");
+    }
+    
+    QElapsedTimer wait;
+    wait.start();
+    try {
+        PooledConnection connection = m_pool->acquire();
+        DatabaseMetrics::instance().recordPoolWait(wait.nsecsElapsed() / 1e6, true);
+        applyHealth(m_breaker->recordSuccess());
+        return connection;
+    } catch (const pqxx::broken_connection&) {
+        DatabaseMetrics::instance().recordPoolWait(wait.nsecsElapsed() / 1e6, false);
+        applyHealth(m_breaker->recordFailure());
+        throw;
+    } catch (...) {
+        DatabaseMetrics::instance().recordPoolWait(wait.nsecsElapsed() / 1e6, false);
+        throw;
+    }
+}
+
+void DatabaseService::applyHealth(CircuitBreaker::Transition transition)
+{
+    if (!transition.changed()) return;
+    
+    const Health health = static_cast<Health>(transition.to);
+    qDebug() << "Database health:" << static_cast<Health>(transition.from) << "->" << health;
+    emit healthChanged(health);
+    
+    if (health == Offline) {
+        QMetaObject::invokeMethod(this, "scheduleProbe", Qt::QueuedConnection);
+    } else if (health == Connected && transition.from == CircuitBreaker::Offline) {
+        // Writes journaled while offline go out now
+        PersistenceWorker::instance().requestFlush();
+    }
+}
+
+void DatabaseService::scheduleProbe()
+{
+    QTimer::singleShot(m_breaker->probeDelayMs(), this, [this]() {
+        QThreadPool::globalInstance()->start([this]() { runProbe(); });
+    });
+}
+
+void DatabaseService::runProbe()
+{
+    try {
+        // Outside the pool, so a dead server costs one connection attempt per probe
+        pqxx::connection probe(buildConnectionString().toStdString());
+        pqxx::nontransaction txn(probe);
+        txn.exec("SELECT 1");
+    } catch (const std::exception &e) {
+        const int delayMs = m_breaker->probeFailed();
+        qDebug() << "Database probe failed, next in" << delayMs << "ms:" << e.what();
+        QMetaObject::invokeMethod(this, "scheduleProbe", Qt::QueuedConnection);
+        return;
+    }
+    
+    // Pooled connections from before the outage are dead
+    m_pool->closeIdle();
+    applyHealth(m_breaker->recordSuccess());
+    qDebug() << "Database reachable again";
+    
+    // Never got through startup: run it now (schema, statements, listener)
+    if (!m_connected) {
+        connectToDatabase();
+    }
+}
+
+void DatabaseService::enablePreparedStatements()
+{
+    // Connections opened before this, idle or checked out, lack the statements;
+    // the pool discards them rather than handing them out again
+    m_pool->setConnectionInitializer(&PreparedStatements::prepareAll);
+}
+
 QVector<DatabaseService::PolygonRegion> DatabaseService::loadAllRegions()
 {
     QVector<PolygonRegion> regions;
     
     try {
-        QString connString = buildConnectionString();
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        QString query = R"(
-            SELECT region_id, name, description, created_at, updated_at,
-                   ST_AsText(geom) as wkt_geometry
-            FROM polygon_regions 
-            ORDER BY created_at
-        )";
+        PooledConnection c = acquireConnection();
+        pqxx::work txn(*c);
         
-        pqxx::result result = txn.exec(query.toStdString());
+        pqxx::result result = PreparedStatements::exec(txn, PreparedStatements::RegionLoadAll);
         
+        regions.reserve(static_cast<int>(result.size()));
+        QByteArray wkbBuffer;
         for (const auto& row : result) {
             PolygonRegion region;
             region.id = QString::fromStdString(row["region_id"].as<std::string>());
@@ -91,9 +245,7 @@ QVector<DatabaseService::PolygonRegion> DatabaseService::loadAllRegions()
             region.updatedAt = QDateTime::fromString(
                 QString::fromStdString(row["updated_at"].as<std::string>()), Qt::ISODate);
             
-            // Parse WKT geometry to QPolygonF
-            QString wkt = QString::fromStdString(row["wkt_geometry"].as<std::string>());
-            region.polygon = parseWKTPolygon(wkt);
+            readRegionGeometry(row["wkb_geometry"], wkbBuffer, region);
             
             regions.append(region);
         }
@@ -107,23 +259,57 @@ QVector<DatabaseService::PolygonRegion> DatabaseService::loadAllRegions()
     return regions;
 }
 
+QVector<DatabaseService::PolygonRegion> DatabaseService::loadRegions(const QStringList& regionIds, bool* ok)
+{
+    QVector<PolygonRegion> regions;
+    if (ok) *ok = false;
+    
+    try {
+        PooledConnection c = acquireConnection();
+        pqxx::work txn(*c);
+        
+        std::vector<std::string> ids;
+        ids.reserve(static_cast<std::size_t>(regionIds.size()));
+        for (const QString& id : regionIds) {
+            ids.push_back(id.toStdString());
+        }
+        pqxx::result result = PreparedStatements::exec(txn, PreparedStatements::RegionLoadMany, ids);
+        
+        regions.reserve(static_cast<int>(result.size()));
+        QByteArray wkbBuffer;
+        for (const auto& row : result) {
+            PolygonRegion region;
+            region.id = QString::fromStdString(row["region_id"].as<std::string>());
+            region.name = QString::fromStdString(row["name"].as<std::string>());
+            region.description = QString::fromStdString(row["description"].as<std::string>());
+            region.createdAt = QDateTime::fromString(
+                QString::fromStdString(row["created_at"].as<std::string>()), Qt::ISODate);
+            region.updatedAt = QDateTime::fromString(
+                QString::fromStdString(row["updated_at"].as<std::string>()), Qt::ISODate);
+            
+            readRegionGeometry(row["wkb_geometry"], wkbBuffer, region);
+            
+            regions.append(region);
+        }
+        if (ok) *ok = true;
+        
+    } catch (const std::exception &e) {
+        logError("Load Regions", e.what());
+    }
+    
+    return regions;
+}
+
 DatabaseService::PolygonRegion DatabaseService::loadRegion(const QString& regionId)
 {
     PolygonRegion region;
     
     try {
-        QString connString = buildConnectionString();
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        QString query = R"(
-            SELECT name, description, created_at, updated_at,
-                   ST_AsText(geom) as wkt_geometry
-            FROM polygon_regions 
-            WHERE region_id = $1
-        )";
+        PooledConnection c = acquireConnection();
+        pqxx::work txn(*c);
         
-        pqxx::result result = txn.exec_params(query.toStdString(), regionId.toStdString());
+        pqxx::result result = PreparedStatements::exec(txn, PreparedStatements::RegionLoad,
+                                                       regionId.toStdString());
         
         if (!result.empty()) {
             auto row = result[0];
@@ -135,8 +321,8 @@ DatabaseService::PolygonRegion DatabaseService::loadRegion(const QString& region
             region.updatedAt = QDateTime::fromString(
                 QString::fromStdString(row["updated_at"].as<std::string>()), Qt::ISODate);
             
-            QString wkt = QString::fromStdString(row["wkt_geometry"].as<std::string>());
-            region.polygon = parseWKTPolygon(wkt);
+            QByteArray wkbBuffer;
+            readRegionGeometry(row["wkb_geometry"], wkbBuffer, region);
             
             logSuccess("Load Region", QString("Loaded region: %1").arg(regionId));
         }
@@ -151,23 +337,14 @@ DatabaseService::PolygonRegion DatabaseService::loadRegion(const QString& region
 bool DatabaseService::saveRegion(const PolygonRegion& region)
 {
     try {
-        QString connString = buildConnectionString();
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        // Convert QPolygonF to WKT
-        QString wkt = polygonToWKT(region.polygon);
-        
-        QString insertQuery = R"(
-            INSERT INTO polygon_regions (region_id, name, description, geom, created_at, updated_at)
-            VALUES ($1, $2, $3, ST_GeomFromText($4, 4326), $5, $6)
-        )";
+        PooledConnection c = acquireConnection();
+        pqxx::work txn(*c);
         
-        txn.exec_params(insertQuery.toStdString(),
+        PreparedStatements::exec(txn, PreparedStatements::RegionInsert,
             region.id.toStdString(),
             region.name.toStdString(),
             region.description.toStdString(),
-            wkt.toStdString(),
+            regionToWkb(region),
             region.createdAt.toString(Qt::ISODate).toStdString(),
             region.updatedAt.toString(Qt::ISODate).toStdString()
         );
@@ -188,23 +365,14 @@ bool DatabaseService::saveRegion(const PolygonRegion& region)
 bool DatabaseService::updateRegion(const PolygonRegion& region)
 {
     try {
-        QString connString = buildConnectionString();
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        QString wkt = polygonToWKT(region.polygon);
+        PooledConnection c = acquireConnection();
+        pqxx::work txn(*c);
         
-        QString updateQuery = R"(
-            UPDATE polygon_regions SET 
-                name = $2, description = $3, geom = ST_GeomFromText($4, 4326), updated_at = $5
-            WHERE region_id = $1
-        )";
-        
-        txn.exec_params(updateQuery.toStdString(),
+        PreparedStatements::exec(txn, PreparedStatements::RegionUpdate,
             region.id.toStdString(),
             region.name.toStdString(),
             region.description.toStdString(),
-            wkt.toStdString(),
+            regionToWkb(region),
             QDateTime::currentDateTime().toString(Qt::ISODate).toStdString()
         );
         
@@ -224,12 +392,10 @@ bool DatabaseService::updateRegion(const PolygonRegion& region)
 bool DatabaseService::deleteRegion(const QString& regionId)
 {
     try {
-        QString connString = buildConnectionString();
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
+        PooledConnection c = acquireConnection();
+        pqxx::work txn(*c);
         
-        QString deleteQuery = "DELETE FROM polygon_regions WHERE region_id = $1";
-        txn.exec_params(deleteQuery.toStdString(), regionId.toStdString());
+        PreparedStatements::exec(txn, PreparedStatements::RegionDelete, regionId.toStdString());
         
         txn.commit();
         
@@ -248,14 +414,17 @@ void DatabaseService::createDefaultHanoiRegion()
 {
     try {
         // Check if Hanoi region already exists
-        QString connString = buildConnectionString();
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        QString checkQuery = "SELECT COUNT(*) FROM polygon_regions WHERE name = 'Hanoi Area'";
-        pqxx::result checkResult = txn.exec(checkQuery.toStdString());
+        int existing = 0;
+        {
+            PooledConnection c = acquireConnection();
+            pqxx::work txn(*c);
+            
+            pqxx::result checkResult = PreparedStatements::exec(txn, PreparedStatements::RegionCountByName,
+                                                                std::string("Hanoi Area"));
+            existing = checkResult[0][0].as<int>();
+        } // Return the connection before saveRegion() checks out its own
         
-        if (checkResult[0][0].as<int>() == 0) {
+        if (existing == 0) {
             // Create default Hanoi polygon region
             PolygonRegion hanoiRegion;
             hanoiRegion.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
@@ -306,25 +475,10 @@ bool DatabaseService::updateAircraft(Aircraft* aircraft)
 
 bool DatabaseService::deleteAircraft(const QString& aircraftId)
 {
-    try {
-        QString connString = buildConnectionString();
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        QString deleteQuery = "DELETE FROM aircraft WHERE aircraft_id = $1";
-        txn.exec_params(deleteQuery.toStdString(), aircraftId.toStdString());
-        
-        txn.commit();
-        
-        logSuccess("Delete Aircraft", QString("Deleted aircraft: %1").arg(aircraftId));
-        emit operationCompleted(true, "Delete Aircraft", "Aircraft deleted successfully");
-        return true;
-        
-    } catch (const std::exception &e) {
-        logError("Delete Aircraft", e.what());
-        emit operationCompleted(false, "Delete Aircraft", e.what());
-        return false;
-    }
+    // Written by the persistence thread, after any update still queued for it
+    PersistenceWorker::instance().enqueueDelete(aircraftId);
+    logSuccess("Delete Aircraft", QString("Queued delete of aircraft: %1").arg(aircraftId));
+    return true;
 }
 
 bool DatabaseService::aircraftExists(const QString& aircraftId)
@@ -337,15 +491,19 @@ QVector<FlightRoute*> DatabaseService::loadAllFlightRoutes(QObject* parent)
     QVector<FlightRoute*> routes;
     
     try {
-        QString connString = buildConnectionString();
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        QString query = "SELECT route_id FROM flight_routes ORDER BY created_at";
-        pqxx::result result = txn.exec(query.toStdString());
+        QStringList routeIds;
+        {
+            PooledConnection c = acquireConnection();
+            pqxx::work txn(*c);
+            
+            pqxx::result result = PreparedStatements::exec(txn, PreparedStatements::RouteListIds);
+            
+            for (const auto& row : result) {
+                routeIds.append(QString::fromStdString(row["route_id"].as<std::string>()));
+            }
+        } // Each route loads through its own checkout
         
-        for (const auto& row : result) {
-            QString routeId = QString::fromStdString(row["route_id"].as<std::string>());
+        for (const QString& routeId : routeIds) {
             FlightRoute* route = new FlightRoute(parent);
             route->loadFromDatabase(routeId);
             routes.append(route);
@@ -379,12 +537,10 @@ bool DatabaseService::updateFlightRoute(FlightRoute* route)
 bool DatabaseService::deleteFlightRoute(const QString& routeId)
 {
     try {
-        QString connString = buildConnectionString();
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
+        PooledConnection c = acquireConnection();
+        pqxx::work txn(*c);
         
-        QString deleteQuery = "DELETE FROM flight_routes WHERE route_id = $1";
-        txn.exec_params(deleteQuery.toStdString(), routeId.toStdString());
+        PreparedStatements::exec(txn, PreparedStatements::RouteDelete, routeId.toStdString());
         
         txn.commit();
         
@@ -402,12 +558,11 @@ bool DatabaseService::deleteFlightRoute(const QString& routeId)
 bool DatabaseService::flightRouteExists(const QString& routeId)
 {
     try {
-        QString connString = buildConnectionString();
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
+        PooledConnection c = acquireConnection();
+        pqxx::work txn(*c);
         
-        QString query = "SELECT COUNT(*) FROM flight_routes WHERE route_id = $1";
-        pqxx::result result = txn.exec_params(query.toStdString(), routeId.toStdString());
+        pqxx::result result = PreparedStatements::exec(txn, PreparedStatements::RouteExists,
+                                                       routeId.toStdString());
         
         return result[0][0].as<int>() > 0;
         
@@ -417,12 +572,11 @@ bool DatabaseService::flightRouteExists(const QString& routeId)
     }
 }
 
-void DatabaseService::createTables()
+bool DatabaseService::createTables()
 {
     try {
-        QString connString = buildConnectionString();
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
+        PooledConnection c = acquireConnection();
+        pqxx::work txn(*c);
         
         // Create aircraft table
         QString createAircraftTable = R"(
@@ -494,13 +648,28 @@ void DatabaseService::createTables()
                 region_id VARCHAR(255) UNIQUE NOT NULL,
                 name VARCHAR(255) NOT NULL,
                 description TEXT,
-                geom GEOMETRY(POLYGON, 4326) NOT NULL,
+                geom GEOMETRY(MULTIPOLYGON, 4326) NOT NULL,
                 created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
                 updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
             )
         )";
         
         txn.exec(createRegionsTable.toStdString());
+        
+        // Tables created before multi-part regions held single polygons only
+        QString migrateRegionsGeometry = R"(
+            DO $$
+            BEGIN
+                IF EXISTS (SELECT 1 FROM geometry_columns
+                           WHERE f_table_name = 'polygon_regions' AND f_geometry_column = 'geom'
+                             AND type = 'POLYGON') THEN
+                    ALTER TABLE polygon_regions
+                        ALTER COLUMN geom TYPE GEOMETRY(MULTIPOLYGON, 4326) USING ST_Multi(geom);
+                END IF;
+            END $$
+        )";
+        
+        txn.exec(migrateRegionsGeometry.toStdString());
         qDebug() << "Polygon regions table created/verified";
         
         // Create spatial index
@@ -512,24 +681,242 @@ void DatabaseService::createTables()
         txn.exec(createSpatialIndex.toStdString());
         qDebug() << "Spatial index created/verified";
         
+        // Position samples; one partition per UTC day so retention drops whole tables.
+        // BRIN suits the append-only time column, the btree serves per-aircraft tracks
+        QString createHistoryTable = R"(
+            CREATE TABLE IF NOT EXISTS position_history (
+                aircraft_id VARCHAR(255) NOT NULL,
+                recorded_at TIMESTAMPTZ NOT NULL,
+                longitude DOUBLE PRECISION NOT NULL,
+                latitude DOUBLE PRECISION NOT NULL,
+                altitude DOUBLE PRECISION,
+                speed DOUBLE PRECISION,
+                heading DOUBLE PRECISION
+            ) PARTITION BY RANGE (recorded_at)
+        )";
+        
+        txn.exec(createHistoryTable.toStdString());
+        txn.exec("CREATE INDEX IF NOT EXISTS idx_position_history_time "
+                 "ON position_history USING BRIN (recorded_at)");
+        txn.exec("CREATE INDEX IF NOT EXISTS idx_position_history_aircraft "
+                 "ON position_history (aircraft_id, recorded_at)");
+        qDebug() << "Position history table created/verified";
+        
+        // Notify other clients of row changes; the origin lets each client skip its own writes
+        QString createNotifyFunction = QString(R"(
+            CREATE OR REPLACE FUNCTION gismap_notify_change() RETURNS trigger AS $$
+            DECLARE
+                changed JSONB;
+            BEGIN
+                IF TG_OP = 'DELETE' THEN
+                    changed := to_jsonb(OLD);
+                ELSE
+                    changed := to_jsonb(NEW);
+                END IF;
+                PERFORM pg_notify('%1', json_build_object(
+                    'table', TG_TABLE_NAME,
+                    'op', lower(TG_OP),
+                    'id', changed ->> TG_ARGV[0],
+                    'origin', current_setting('application_name'))::text);
+                RETURN NULL;
+            END
+            $$ LANGUAGE plpgsql
+        )").arg(ChangeListener::Channel);
+        
+        txn.exec(createNotifyFunction.toStdString());
+        
+        const QList<QPair<QString, QString>> notifyingTables = {
+            { "polygon_regions", "region_id" },
+            { "flight_routes", "route_id" }
+        };
+        for (const auto& table : notifyingTables) {
+            QString createTrigger = QString(R"(
+                DO $$
+                BEGIN
+                    IF NOT EXISTS (SELECT 1 FROM pg_trigger WHERE tgname = '%1_notify_change') THEN
+                        CREATE TRIGGER %1_notify_change
+                        AFTER INSERT OR UPDATE OR DELETE ON %1
+                        FOR EACH ROW EXECUTE PROCEDURE gismap_notify_change('%2');
+                    END IF;
+                END
+                $$
+            )").arg(table.first, table.second);
+            
+            txn.exec(createTrigger.toStdString());
+        }
+        
+        // The persistence worker rewrites every moving aircraft each flush; per-row
+        // notifications for that would flood every client. Updates only notify when
+        // something other than the movement columns changed, so the aircraft trigger
+        // is split into insert/delete and a filtered update trigger. Databases set up
+        // before the split still carry the unfiltered trigger; it is replaced once.
+        QString createAircraftTriggers = R"(
+            DO $$
+            BEGIN
+                IF NOT EXISTS (SELECT 1 FROM pg_trigger WHERE tgname = 'aircraft_notify_update') THEN
+                    DROP TRIGGER IF EXISTS aircraft_notify_change ON aircraft;
+                    CREATE TRIGGER aircraft_notify_change
+                    AFTER INSERT OR DELETE ON aircraft
+                    FOR EACH ROW EXECUTE PROCEDURE gismap_notify_change('aircraft_id');
+                    CREATE TRIGGER aircraft_notify_update
+                    AFTER UPDATE ON aircraft
+                    FOR EACH ROW
+                    WHEN ((OLD.aircraft_id, OLD.call_sign, OLD.aircraft_type, OLD.state,
+                           OLD.flight_route_id, OLD.is_moving)
+                          IS DISTINCT FROM
+                          (NEW.aircraft_id, NEW.call_sign, NEW.aircraft_type, NEW.state,
+                           NEW.flight_route_id, NEW.is_moving))
+                    EXECUTE PROCEDURE gismap_notify_change('aircraft_id');
+                END IF;
+            END
+            $$
+        )";
+        
+        txn.exec(createAircraftTriggers.toStdString());
+        qDebug() << "Change notification triggers created/verified";
+        
         txn.commit();
         
         qDebug() << "All database tables created/verified successfully";
         
-        // Create default Hanoi region after tables are created
-        createDefaultHanoiRegion();
-        
     } catch (const std::exception &e) {
         logError("Create Tables", e.what());
+        return false;
+    }
+    
+    // The schema exists now, so connections can prepare their statements;
+    // this must precede the first prepared statement (saveRegion below)
+    enablePreparedStatements();
+    
+    // Create default Hanoi region after tables are created (and the connection returned)
+    createDefaultHanoiRegion();
+    
+    // Partitions for today and the next few days, then apply retention
+    ConfigManager& config = ConfigManager::instance();
+    QDate today = QDateTime::currentDateTimeUtc().date();
+    ensurePositionHistoryPartitions(today, config.getPositionHistoryPartitionDaysAhead() + 1);
+    dropPositionHistoryBefore(today.addDays(-config.getPositionHistoryRetentionDays()));
+    
+    if (config.getChangeNotificationsEnabled()) {
+        ChangeListener::instance().listen(buildConnectionString(), m_applicationName);
+    }
+    return true;
+}
+
+QVector<DatabaseService::TrackPoint> DatabaseService::loadTrack(const QString& aircraftId,
+                                                               const QDateTime& from, const QDateTime& to)
+{
+    QVector<TrackPoint> track;
+    
+    try {
+        PooledConnection c = acquireConnection();
+        pqxx::read_transaction txn(*c);
+        
+        pqxx::result result = PreparedStatements::exec(txn, PreparedStatements::HistoryLoadTrack,
+            aircraftId.toStdString(),
+            from.toUTC().toString(Qt::ISODateWithMs).toStdString(),
+            to.toUTC().toString(Qt::ISODateWithMs).toStdString());
+        
+        track.reserve(static_cast<int>(result.size()));
+        for (const auto& row : result) {
+            TrackPoint point;
+            point.time = QDateTime::fromMSecsSinceEpoch(qRound64(row[0].as<double>() * 1000.0), Qt::UTC);
+            point.position = QPointF(row[1].as<double>(), row[2].as<double>());
+            point.altitude = row[3].as<double>(0.0);
+            point.speed = row[4].as<double>(0.0);
+            point.heading = row[5].as<double>(0.0);
+            track.append(point);
+        }
+        
+    } catch (const std::exception &e) {
+        logError("Load Track", e.what());
+    }
+    
+    return track;
+}
+
+QString DatabaseService::positionHistoryPartitionName(const QDate& day)
+{
+    return HistoryPartitionPrefix + day.toString("yyyyMMdd");
+}
+
+bool DatabaseService::ensurePositionHistoryPartitions(const QDate& firstDay, int days)
+{
+    try {
+        PooledConnection c = acquireConnection();
+        pqxx::work txn(*c);
+        
+        for (int i = 0; i < days; ++i) {
+            QDate day = firstDay.addDays(i);
+            QString createPartition = QString(
+                "CREATE TABLE IF NOT EXISTS %1 PARTITION OF position_history "
+                "FOR VALUES FROM ('%2 00:00:00+00') TO ('%3 00:00:00+00')")
+                .arg(positionHistoryPartitionName(day),
+                     day.toString(Qt::ISODate),
+                     day.addDays(1).toString(Qt::ISODate));
+            txn.exec(createPartition.toStdString());
+        }
+        
+        txn.commit();
+        return true;
+        
+    } catch (const std::exception &e) {
+        logError("Create Position History Partitions", e.what());
+        return false;
+    }
+}
+
+int DatabaseService::dropPositionHistoryBefore(const QDate& cutoffDay)
+{
+    int dropped = 0;
+    
+    try {
+        PooledConnection c = acquireConnection();
+        pqxx::work txn(*c);
+        
+        pqxx::result partitions = txn.exec(R"(
+            SELECT child.relname
+            FROM pg_inherits
+            JOIN pg_class parent ON parent.oid = pg_inherits.inhparent
+            JOIN pg_class child ON child.oid = pg_inherits.inhrelid
+            WHERE parent.relname = 'position_history'
+        )");
+        
+        for (const auto& row : partitions) {
+            QString name = QString::fromStdString(row[0].as<std::string>());
+            if (!name.startsWith(HistoryPartitionPrefix)) continue;
+            
+            // A partition holds one day, so it is expired once the next day reaches the cutoff
+            QDate day = QDate::fromString(name.mid(HistoryPartitionPrefix.size()), "yyyyMMdd");
+            if (day.isValid() && day.addDays(1) <= cutoffDay) {
+                txn.exec("DROP TABLE IF EXISTS " + txn.quote_name(name.toStdString()));
+                ++dropped;
+            }
+        }
+        
+        txn.commit();
+        
+        if (dropped > 0) {
+            logSuccess("Drop Position History",
+                QString("Dropped %1 daily partitions before %2").arg(dropped).arg(cutoffDay.toString(Qt::ISODate)));
+        }
+        
+    } catch (const std::exception &e) {
+        logError("Drop Position History", e.what());
+        return 0;
     }
+    
+    return dropped;
 }
 
 void DatabaseService::cleanupOldData(int daysOld)
 {
+    // Position history expires by dropping whole partitions, never row by row
+    dropPositionHistoryBefore(QDateTime::currentDateTimeUtc().date().addDays(-daysOld));
+    
     try {
-        QString connString = buildConnectionString();
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
+        PooledConnection c = acquireConnection();
+        pqxx::work txn(*c);
         
         // Cleanup old aircraft that haven't been updated
         QString cleanupAircraft = QString(
@@ -569,18 +956,20 @@ QString DatabaseService::buildConnectionString() const
 {
     ConfigManager& config = ConfigManager::instance();
     
-    return QString("host=%1 port=%2 dbname=%3 user=%4 password=%5 connect_timeout=%6")
+    return QString("host=%1 port=%2 dbname=%3 user=%4 password=%5 connect_timeout=%6 application_name=%7")
         .arg(config.getDatabaseHost())
         .arg(config.getDatabasePort())
         .arg(config.getDatabaseName())
         .arg(config.getDatabaseUsername())
         .arg(config.getDatabasePassword())
-        .arg(config.getDatabaseConnectionTimeout());
+        .arg(config.getDatabaseConnectionTimeout())
+        .arg(m_applicationName);
 }
 
 void DatabaseService::logError(const QString& operation, const QString& error)
 {
     qDebug() << "Database Error in" << operation << ":" << error;
+    DatabaseMetrics::instance().recordOperationError(operation);
     emit databaseError(QString("%1: %2").arg(operation, error));
 }
 
@@ -588,38 +977,3 @@ void DatabaseService::logSuccess(const QString& operation, const QString& messag
 {
     qDebug() << "Database Success in" << operation << ":" << message;
 }
-
-// Helper functions for WKT conversion
-QPolygonF DatabaseService::parseWKTPolygon(const QString& wkt)
-{
-    QPolygonF polygon;
-    
-    // Simple WKT parser for POLYGON((x1 y1, x2 y2, ...))
-    QString coords = wkt;
-    coords.remove("POLYGON((");
-    coords.remove("))");
-    
-    QStringList points = coords.split(",");
-    for (const QString& point : points) {
-        QStringList xy = point.trimmed().split(" ");
-        if (xy.size() >= 2) {
-            polygon << QPointF(xy[0].toDouble(), xy[1].toDouble());
-        }
-    }
-    
-    return polygon;
-}
-
-QString DatabaseService::polygonToWKT(const QPolygonF& polygon)
-{
-    QString wkt = "POLYGON((";
-    
-    for (int i = 0; i < polygon.size(); ++i) {
-        const QPointF& point = polygon[i];
-        if (i > 0) wkt += ", ";
-        wkt += QString("%1 %2").arg(point.x()).arg(point.y());
-    }
-    
-    wkt += "))";
-    return wkt;
-} 
\ No newline at end of file
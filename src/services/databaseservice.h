@@ -7,6 +7,12 @@
 #include <QPointF>
 #include <QPolygonF>
 #include <QDateTime>
+#include <QDate>
+#include <memory>
+#include <atomic>
+#include "connectionpool.h"
+#include "circuitbreaker.h"
+#include "../core/wkbreader.h"
 
 class Aircraft;
 class FlightRoute;
@@ -22,18 +28,42 @@ class DatabaseService : public QObject
     Q_OBJECT
 
 public:
+    // Circuit breaker state: Degraded still tries to connect, Offline fails fast
+    // and only background probes (with exponential backoff) touch the server
+    enum Health {
+        Connected = CircuitBreaker::Connected,
+        Degraded = CircuitBreaker::Degraded,
+        Offline = CircuitBreaker::Offline
+    };
+    Q_ENUM(Health)
+
     static DatabaseService& instance();
 
     // Database connection management
     bool connectToDatabase();
+    // Connect and prepare the schema on a pool thread; databaseConnected or
+    // databaseError reports the outcome. Does nothing while an attempt is running.
+    void connectInBackground();
     void disconnectFromDatabase();
     bool isConnected() const { return m_connected; }
+    Health health() const { return static_cast<Health>(m_breaker->state()); }
+    // Connected once and not offline; worth issuing queries
+    bool isAvailable() const { return m_connected && health() != Offline; }
+    
+    // Scoped checkout from the shared connection pool; all database access goes through here.
+    // Throws like pqxx::connection does when no connection can be established, and
+    // throws pqxx::broken_connection immediately while offline.
+    PooledConnection acquireConnection();
+    ConnectionPool* connectionPool() const { return m_pool.get(); }
+    // application_name of this process's sessions; tags the origin of change notifications
+    QString applicationName() const { return m_applicationName; }
 
     // Region/Polygon operations
     struct PolygonRegion {
         QString id;
         QString name;
-        QPolygonF polygon;
+        QPolygonF polygon;                // Editable outline: exterior ring of the first part
+        QVector<WkbReader::Polygon> parts; // Full stored geometry, holes and multi-parts included
         QString description;
         QDateTime createdAt;
         QDateTime updatedAt;
@@ -41,6 +71,8 @@ public:
 
     QVector<PolygonRegion> loadAllRegions();
     PolygonRegion loadRegion(const QString& regionId);
+    // One query for all ids; ids without a row are left out. ok is false if the query failed
+    QVector<PolygonRegion> loadRegions(const QStringList& regionIds, bool* ok = nullptr);
     bool saveRegion(const PolygonRegion& region);
     bool updateRegion(const PolygonRegion& region);
     bool deleteRegion(const QString& regionId);
@@ -62,8 +94,24 @@ public:
     bool deleteFlightRoute(const QString& routeId);
     bool flightRouteExists(const QString& routeId);
 
+    // Position history: per-sample track, range-partitioned by day (UTC)
+    struct TrackPoint {
+        QDateTime time;
+        QPointF position;
+        double altitude = 0.0;
+        double speed = 0.0;
+        double heading = 0.0;
+    };
+
+    QVector<TrackPoint> loadTrack(const QString& aircraftId, const QDateTime& from, const QDateTime& to);
+    // Create the daily partitions for [firstDay, firstDay + days); existing ones are kept
+    bool ensurePositionHistoryPartitions(const QDate& firstDay, int days);
+    // Drop every daily partition that ends on or before cutoffDay; returns the number dropped
+    int dropPositionHistoryBefore(const QDate& cutoffDay);
+    static QString positionHistoryPartitionName(const QDate& day);
+
     // Database maintenance
-    void createTables();
+    bool createTables();  // Also installs the prepared statements; false if the schema is unusable
     void cleanupOldData(int daysOld = 30);
     QString getConnectionInfo() const;
 
@@ -71,6 +119,8 @@ signals:
     void databaseConnected();
     void databaseDisconnected();
     void databaseError(const QString& error);
+    // Emitted from whichever thread observed the transition
+    void healthChanged(DatabaseService::Health health);
     void operationCompleted(bool success, const QString& operation, const QString& message);
 
 private:
@@ -78,14 +128,21 @@ private:
     ~DatabaseService();
 
     QString buildConnectionString() const;
+    // Announces a breaker transition and starts probing or replays the journal
+    void applyHealth(CircuitBreaker::Transition transition);
+    // Offline recovery; the timer runs on this object's thread, the probe on the pool
+    Q_INVOKABLE void scheduleProbe();
+    void runProbe();
+    // Install PreparedStatements::prepareAll on the pool; requires the schema
+    void enablePreparedStatements();
     void logError(const QString& operation, const QString& error);
     void logSuccess(const QString& operation, const QString& message);
 
-    // WKT conversion helpers
-    QPolygonF parseWKTPolygon(const QString& wkt);
-    QString polygonToWKT(const QPolygonF& polygon);
-
-    bool m_connected = false;
+    std::atomic_bool m_connected{false};
+    std::atomic_bool m_connecting{false};
+    std::unique_ptr<CircuitBreaker> m_breaker;
+    QString m_applicationName;
+    std::unique_ptr<ConnectionPool> m_pool;
     static DatabaseService* s_instance;
 };
 
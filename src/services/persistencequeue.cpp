@@ -0,0 +1,296 @@
+#include "persistencequeue.h"
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+#include <pqxx/pqxx>
+
+namespace {
+
+// Journal file layout: header, then counted aircraft states, deletes and
+// position samples, oldest sample first
+constexpr quint32 JournalMagic = 0x474D504A; // "GMPJ"
+constexpr quint32 JournalVersion = 1;
+
+void writeSnapshot(QDataStream& out, const AircraftSnapshot& snapshot)
+{
+    out << snapshot.aircraftId << snapshot.callSign << snapshot.aircraftType << snapshot.position
+        << snapshot.altitude << snapshot.speed << snapshot.heading << snapshot.velocity
+        << qint32(snapshot.state) << snapshot.flightRouteId << snapshot.isMoving << snapshot.updatedAt;
+}
+
+void readSnapshot(QDataStream& in, AircraftSnapshot& snapshot)
+{
+    qint32 state = 0;
+    in >> snapshot.aircraftId >> snapshot.callSign >> snapshot.aircraftType >> snapshot.position
+       >> snapshot.altitude >> snapshot.speed >> snapshot.heading >> snapshot.velocity
+       >> state >> snapshot.flightRouteId >> snapshot.isMoving >> snapshot.updatedAt;
+    snapshot.state = state;
+}
+
+void writeSample(QDataStream& out, const PositionSample& sample)
+{
+    out << sample.aircraftId << sample.recordedAt << sample.position
+        << sample.altitude << sample.speed << sample.heading;
+}
+
+void readSample(QDataStream& in, PositionSample& sample)
+{
+    in >> sample.aircraftId >> sample.recordedAt >> sample.position
+       >> sample.altitude >> sample.speed >> sample.heading;
+}
+
+} // namespace
+
+PersistenceQueue::PersistenceQueue(bool keepSamples, int maxSamples)
+    : m_keepSamples(keepSamples)
+    , m_maxSamples(qMax(0, maxSamples))
+{
+}
+
+void PersistenceQueue::enqueue(const AircraftSnapshot& snapshot)
+{
+    // Re-added after a delete that has not been written yet: the upsert wins
+    m_deletes.remove(snapshot.aircraftId);
+    m_pending.insert(snapshot.aircraftId, snapshot);
+
+    if (!m_keepSamples) return;
+    if (m_samples.size() >= m_maxSamples) {
+        ++m_droppedSamples; // Database behind or away; bound memory instead
+        return;
+    }
+
+    PositionSample sample;
+    sample.aircraftId = snapshot.aircraftId;
+    sample.recordedAt = snapshot.updatedAt;
+    sample.position = snapshot.position;
+    sample.altitude = snapshot.altitude;
+    sample.speed = snapshot.speed;
+    sample.heading = snapshot.heading;
+    m_samples.append(sample);
+}
+
+void PersistenceQueue::enqueueDelete(const QString& aircraftId)
+{
+    m_pending.remove(aircraftId);
+    m_deletes.insert(aircraftId);
+}
+
+void PersistenceQueue::discard(const QString& aircraftId)
+{
+    m_pending.remove(aircraftId);
+}
+
+PersistenceQueue::Round PersistenceQueue::take()
+{
+    Round round;
+    round.batch.reserve(m_pending.size());
+    for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it) {
+        round.batch.append(it.value());
+    }
+    m_pending.clear();
+    round.deletes = m_deletes.values();
+    m_deletes.clear();
+    round.samples.swap(m_samples);
+    return round;
+}
+
+void PersistenceQueue::requeue(const Round& round)
+{
+    // Anything enqueued or deleted since the round was taken is newer than it
+    for (const AircraftSnapshot& snapshot : round.batch) {
+        if (!m_pending.contains(snapshot.aircraftId) && !m_deletes.contains(snapshot.aircraftId)) {
+            m_pending.insert(snapshot.aircraftId, snapshot);
+        }
+    }
+    for (const QString& aircraftId : round.deletes) {
+        if (!m_pending.contains(aircraftId)) {
+            m_deletes.insert(aircraftId);
+        }
+    }
+
+    if (!round.samples.isEmpty()) {
+        // Older samples go first; beyond the bound the oldest are dropped
+        QVector<PositionSample> samples = round.samples + m_samples;
+        const int overflow = samples.size() - m_maxSamples;
+        if (overflow > 0) {
+            samples.remove(0, overflow);
+            m_droppedSamples += overflow;
+        }
+        m_samples.swap(samples);
+    }
+}
+
+int PersistenceQueue::takeDroppedSamples()
+{
+    const int dropped = m_droppedSamples;
+    m_droppedSamples = 0;
+    return dropped;
+}
+
+bool PersistenceQueue::settle(Round round, WriteResult batch, WriteResult samples, WriteResult deletes)
+{
+    // Rejected rows would only fail again and are dropped
+    if (batch == Rejected) {
+        qWarning() << "Dropped" << round.batch.size() << "aircraft states rejected by the database";
+    }
+    if (samples == Rejected) {
+        qWarning() << "Dropped" << round.samples.size() << "position samples rejected by the database";
+    }
+    if (deletes == Rejected) {
+        qWarning() << "Dropped" << round.deletes.size() << "aircraft deletes rejected by the database";
+    }
+
+    if (batch != Retry) round.batch.clear();
+    if (samples != Retry) round.samples.clear();
+    if (deletes != Retry) round.deletes.clear();
+    if (round.batch.isEmpty() && round.samples.isEmpty() && round.deletes.isEmpty()) {
+        return false;
+    }
+    requeue(round);
+    return true;
+}
+
+PersistenceQueue::WriteResult PersistenceQueue::classifyFailure(const char* operation, int rows)
+{
+    // Called from a catch block: rethrow to dispatch on the exception type
+    try {
+        throw;
+    } catch (const pqxx::data_exception& e) {
+        qDebug() << "Invalid data" << operation << rows << "rows:" << e.what();
+        return Rejected;
+    } catch (const pqxx::integrity_constraint_violation& e) {
+        qDebug() << "Constraint violated" << operation << rows << "rows:" << e.what();
+        return Rejected;
+    } catch (const pqxx::broken_connection& e) {
+        qDebug() << "Connection lost" << operation << rows << "rows, will retry:" << e.what();
+    } catch (const pqxx::in_doubt_error& e) {
+        qDebug() << "Commit outcome unknown" << operation << rows << "rows, will retry:" << e.what();
+    } catch (const pqxx::transaction_rollback& e) {
+        qDebug() << "Transaction rolled back" << operation << rows << "rows, will retry:" << e.what();
+    } catch (const std::exception& e) {
+        // Pool checkout timeouts, statement timeouts and anything unexpected
+        qDebug() << "Error" << operation << rows << "rows, will retry:" << e.what();
+    }
+    return Retry;
+}
+
+bool PersistenceQueue::saveJournal(const QString& path, qint64 maxBytes) const
+{
+    QByteArray head;
+    QDataStream headOut(&head, QIODevice::WriteOnly);
+    headOut.setVersion(QDataStream::Qt_5_15);
+    headOut << JournalMagic << JournalVersion << quint32(m_pending.size());
+    for (const AircraftSnapshot& snapshot : m_pending) {
+        writeSnapshot(headOut, snapshot);
+    }
+    headOut << quint32(m_deletes.size());
+    for (const QString& aircraftId : m_deletes) {
+        headOut << aircraftId;
+    }
+
+    // Aircraft states and deletes are always kept; samples fill the rest of the
+    // size cap, and the oldest are the ones left out
+    QByteArray tail;
+    QDataStream tailOut(&tail, QIODevice::WriteOnly);
+    tailOut.setVersion(QDataStream::Qt_5_15);
+    QVector<int> offsets;
+    offsets.reserve(m_samples.size());
+    for (const PositionSample& sample : m_samples) {
+        offsets.append(tail.size());
+        writeSample(tailOut, sample);
+    }
+    const qint64 budget = maxBytes - head.size() - qint64(sizeof(quint32));
+    int first = 0;
+    while (first < offsets.size() && tail.size() - offsets[first] > budget) {
+        ++first;
+    }
+    const int kept = m_samples.size() - first;
+
+    QByteArray count;
+    QDataStream countOut(&count, QIODevice::WriteOnly);
+    countOut << quint32(kept);
+
+    // QSaveFile keeps the previous journal until the new one is complete
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    bool saved = file.open(QIODevice::WriteOnly)
+              && file.write(head) == head.size()
+              && file.write(count) == count.size();
+    if (saved && kept > 0) {
+        const qint64 from = offsets[first];
+        saved = file.write(tail.constData() + from, tail.size() - from) == tail.size() - from;
+    }
+    saved = saved && file.commit();
+
+    if (!saved) {
+        qWarning() << "Cannot write persistence journal" << path << ":" << file.errorString();
+        return false;
+    }
+    qDebug() << "Saved persistence journal of" << m_pending.size() << "aircraft states,"
+             << m_deletes.size() << "deletes and" << kept << "position samples";
+    if (first > 0) {
+        qWarning() << "Persistence journal full, left out the" << first << "oldest position samples";
+    }
+    return true;
+}
+
+bool PersistenceQueue::loadJournal(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Cannot open persistence journal" << path << ":" << file.errorString();
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_15);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != JournalMagic || version != JournalVersion) {
+        qWarning() << "Ignoring persistence journal" << path << "with unknown format";
+        return false;
+    }
+
+    // Counts come from the file, so nothing is reserved up front and a short read ends the loop
+    QHash<QString, AircraftSnapshot> pending;
+    QSet<QString> deletes;
+    QVector<PositionSample> samples;
+    quint32 count = 0;
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        AircraftSnapshot snapshot;
+        readSnapshot(in, snapshot);
+        pending.insert(snapshot.aircraftId, snapshot);
+    }
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString aircraftId;
+        in >> aircraftId;
+        deletes.insert(aircraftId);
+    }
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        PositionSample sample;
+        readSample(in, sample);
+        samples.append(sample);
+    }
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "Ignoring damaged persistence journal" << path;
+        return false;
+    }
+
+    if (!m_keepSamples) {
+        samples.clear();
+    } else if (samples.size() > m_maxSamples) {
+        samples.remove(0, samples.size() - m_maxSamples);
+    }
+
+    m_pending.swap(pending);
+    m_deletes.swap(deletes);
+    m_samples.swap(samples);
+    return true;
+}
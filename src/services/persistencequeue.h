@@ -0,0 +1,103 @@
+#pragma once
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+#include <QPointF>
+#include <QDateTime>
+
+/**
+ * @brief Copy of the persisted aircraft columns, safe to hand to another thread
+ */
+struct AircraftSnapshot {
+    QString aircraftId;
+    QString callSign;
+    QString aircraftType;
+    QPointF position;
+    double altitude = 0.0;
+    double speed = 0.0;
+    double heading = 0.0;
+    QPointF velocity;
+    int state = 0;
+    QString flightRouteId;
+    bool isMoving = false;
+    QDateTime updatedAt;
+};
+
+/**
+ * @brief One position_history row
+ */
+struct PositionSample {
+    QString aircraftId;
+    QDateTime recordedAt;
+    QPointF position;
+    double altitude = 0.0;
+    double speed = 0.0;
+    double heading = 0.0;
+};
+
+/**
+ * @brief Rows waiting to be persisted, with no locking and no database access
+ *
+ * Snapshots coalesce to the latest one per aircraft. A delete replaces any
+ * queued snapshot of its aircraft and a later snapshot replaces the delete,
+ * so pending states and deletes never overlap. Every snapshot is also kept as
+ * a position sample when history is on, up to maxSamples; past that, new
+ * samples are counted as dropped. PersistenceWorker owns one behind its mutex.
+ *
+ * The same contents are what the journal file holds. Copies share their data
+ * until one is changed, so a copy can be saved without holding the worker.
+ */
+class PersistenceQueue {
+public:
+    // Everything taken out for one flush
+    struct Round {
+        QVector<AircraftSnapshot> batch;
+        QVector<PositionSample> samples;
+        QStringList deletes;
+    };
+
+    enum WriteResult {
+        Written,
+        Retry,      // Connection, timeout or transaction conflict; the rows are kept
+        Rejected    // The server refused the data itself; writing it again would fail again
+    };
+
+    PersistenceQueue() = default;
+    PersistenceQueue(bool keepSamples, int maxSamples);
+
+    void enqueue(const AircraftSnapshot& snapshot);
+    void enqueueDelete(const QString& aircraftId);
+    void discard(const QString& aircraftId);
+
+    Round take();
+    // Puts the failed parts of a round back without overwriting anything queued since
+    void requeue(const Round& round);
+    // Requeues the parts of a written round that came back Retry and drops the Rejected
+    // ones; true if anything was put back
+    bool settle(Round round, WriteResult batch, WriteResult samples, WriteResult deletes);
+
+    // From inside a catch block around a write: what to do with its rows
+    static WriteResult classifyFailure(const char* operation, int rows);
+
+    bool isEmpty() const { return m_pending.isEmpty() && m_deletes.isEmpty() && m_samples.isEmpty(); }
+    int pendingCount() const { return m_pending.size(); }
+    int deleteCount() const { return m_deletes.size(); }
+    int sampleCount() const { return m_samples.size(); }
+    // Samples dropped at the bound since the last call
+    int takeDroppedSamples();
+
+    // Snapshots and deletes always; the newest samples that still fit in maxBytes
+    bool saveJournal(const QString& path, qint64 maxBytes) const;
+    // Replaces the contents with a saved journal; false if it is missing, foreign or damaged
+    bool loadJournal(const QString& path);
+
+private:
+    QHash<QString, AircraftSnapshot> m_pending;
+    QSet<QString> m_deletes;
+    QVector<PositionSample> m_samples;  // Oldest first
+    bool m_keepSamples = false;
+    int m_maxSamples = 0;
+    int m_droppedSamples = 0;
+};
@@ -0,0 +1,397 @@
+#include "persistenceworker.h"
+#include "databaseservice.h"
+#include "preparedstatements.h"
+#include "databasemetrics.h"
+#include "../core/configmanager.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+#include <pqxx/pqxx>
+
+PersistenceWorker& PersistenceWorker::instance()
+{
+    static PersistenceWorker instance;
+    return instance;
+}
+
+PersistenceWorker::PersistenceWorker()
+{
+    ConfigManager& config = ConfigManager::instance();
+    m_flushIntervalMs = qMax(10, config.getPersistenceFlushInterval());
+    m_batchSize = qMax(1, config.getPersistenceBatchSize());
+    m_historyEnabled = config.getPositionHistoryEnabled();
+    m_historyBatchSize = qMax(1, config.getPositionHistoryBatchSize());
+    m_queue = PersistenceQueue(m_historyEnabled, qMax(m_historyBatchSize, config.getPositionHistoryMaxPending()));
+    m_journalPath = config.getPersistenceJournalPath();
+    m_journalMaxBytes = qint64(qMax(1, config.getPersistenceJournalMaxSize())) * 1024 * 1024;
+    m_journalSaveIntervalMs = qMax(m_flushIntervalMs, config.getPersistenceJournalSaveInterval());
+
+    // Whatever was left unwritten by the last run goes out with the first flush
+    loadJournal();
+
+    setObjectName("PersistenceWorker");
+    start(QThread::LowPriority);
+}
+
+PersistenceWorker::~PersistenceWorker()
+{
+    shutdown();
+}
+
+void PersistenceWorker::enqueue(const AircraftSnapshot& snapshot)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_stopping) return;
+
+    m_queue.enqueue(snapshot);
+    ++m_enqueued;
+
+    if (m_queue.pendingCount() >= m_batchSize || m_queue.sampleCount() >= m_historyBatchSize) {
+        m_wake.wakeOne();
+    }
+}
+
+void PersistenceWorker::discard(const QString& aircraftId)
+{
+    QMutexLocker locker(&m_mutex);
+    m_queue.discard(aircraftId);
+}
+
+void PersistenceWorker::enqueueDelete(const QString& aircraftId)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_stopping) return;
+
+    m_queue.enqueueDelete(aircraftId);
+    ++m_enqueued;
+
+    // Deletes are rare and user-initiated; don't hold them for the flush interval
+    m_flushRequested = true;
+    m_wake.wakeOne();
+}
+
+void PersistenceWorker::flush()
+{
+    QMutexLocker locker(&m_mutex);
+    quint64 target = m_enqueued;
+    if (m_written >= target || !isRunning()) return;
+
+    m_flushRequested = true;
+    m_wake.wakeOne();
+    while (m_written < target && isRunning()) {
+        m_flushed.wait(&m_mutex);
+    }
+}
+
+void PersistenceWorker::requestFlush()
+{
+    QMutexLocker locker(&m_mutex);
+    m_flushRequested = true;
+    m_wake.wakeOne();
+}
+
+void PersistenceWorker::shutdown()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_stopping) return;
+        m_stopping = true;
+        m_wake.wakeOne();
+    }
+
+    // run() drains the queue before it returns
+    wait();
+    qDebug() << "Persistence worker stopped";
+}
+
+int PersistenceWorker::pendingCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_queue.pendingCount();
+}
+
+int PersistenceWorker::pendingSampleCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_queue.sampleCount();
+}
+
+void PersistenceWorker::run()
+{
+    QMutexLocker locker(&m_mutex);
+    bool backOff = false; // Last write failed transiently; give it a flush interval before retrying
+    QElapsedTimer sinceJournalSave;
+    sinceJournalSave.start();
+
+    while (true) {
+        // Offline, the queues are the journal; only a reconnect (requestFlush) ends the wait
+        bool offline = DatabaseService::instance().health() == DatabaseService::Offline;
+        bool idle = offline || (m_queue.pendingCount() < m_batchSize && m_queue.sampleCount() < m_historyBatchSize);
+        if (!m_stopping && (backOff || (!m_flushRequested && idle))) {
+            m_wake.wait(&m_mutex, m_flushIntervalMs);
+        }
+        backOff = false;
+        m_flushRequested = false;
+
+        offline = DatabaseService::instance().health() == DatabaseService::Offline;
+        if (offline) {
+            // Journaled counts as handled, so flush() and shutdown() never wait on an outage
+            m_written = m_enqueued;
+            m_flushed.wakeAll();
+            if (m_stopping) {
+                qDebug() << "Database offline at shutdown with" << m_queue.pendingCount()
+                         << "aircraft states," << m_queue.deleteCount() << "deletes and"
+                         << m_queue.sampleCount() << "position samples unwritten";
+                saveJournal(locker);
+                break;
+            }
+            if (m_enqueued != m_journaledSequence && sinceJournalSave.hasExpired(m_journalSaveIntervalMs)) {
+                saveJournal(locker);
+                sinceJournalSave.restart();
+            }
+            continue;
+        }
+
+        if (!m_queue.isEmpty()) {
+            PersistenceQueue::Round round = m_queue.take();
+            const QVector<AircraftSnapshot> batch = round.batch;
+            const QVector<PositionSample> samples = round.samples;
+            const QStringList deletes = round.deletes;
+            if (const int dropped = m_queue.takeDroppedSamples()) {
+                qDebug() << "Position history queue full, dropped" << dropped << "samples";
+            }
+            quint64 sequence = m_enqueued;
+
+            // The database round trips happen without holding the queue
+            locker.unlock();
+            const PersistenceQueue::WriteResult batchResult =
+                batch.isEmpty() ? PersistenceQueue::Written : writeBatch(batch);
+            const PersistenceQueue::WriteResult historyResult =
+                samples.isEmpty() ? PersistenceQueue::Written : writeHistory(samples);
+            // After the upserts, so a row deleted in this round is not written back
+            const PersistenceQueue::WriteResult deleteResult =
+                deletes.isEmpty() ? PersistenceQueue::Written : writeDeletes(deletes);
+            locker.relock();
+
+            // Transient failures stay journaled, whatever the service health says
+            backOff = m_queue.settle(std::move(round), batchResult, historyResult, deleteResult);
+
+            m_written = sequence;
+        } else {
+            m_written = m_enqueued;
+        }
+        m_flushed.wakeAll();
+
+        if (m_queue.isEmpty()) {
+            // Everything the journal file held has reached the database
+            removeJournal();
+        } else if (m_stopping) {
+            qDebug() << "Database writes still failing at shutdown with" << m_queue.pendingCount()
+                     << "aircraft states," << m_queue.deleteCount() << "deletes and"
+                     << m_queue.sampleCount() << "position samples unwritten";
+            saveJournal(locker);
+        } else if (backOff && m_enqueued != m_journaledSequence
+                   && sinceJournalSave.hasExpired(m_journalSaveIntervalMs)) {
+            saveJournal(locker);
+            sinceJournalSave.restart();
+        }
+
+        if (m_stopping) {
+            break;
+        }
+    }
+}
+
+void PersistenceWorker::loadJournal()
+{
+    if (m_journalPath.isEmpty() || !QFileInfo::exists(m_journalPath)) return;
+
+    // Even a journal that cannot be read is removed after the first clean flush
+    m_journalOnDisk = true;
+    if (!m_queue.loadJournal(m_journalPath)) return;
+
+    qDebug() << "Replaying persistence journal of" << m_queue.pendingCount() << "aircraft states,"
+             << m_queue.deleteCount() << "deletes and" << m_queue.sampleCount() << "position samples";
+
+    ++m_enqueued;
+    m_journaledSequence = m_enqueued;
+    m_flushRequested = true;
+}
+
+void PersistenceWorker::saveJournal(QMutexLocker& locker)
+{
+    if (m_journalPath.isEmpty()) return;
+    if (m_queue.isEmpty()) {
+        removeJournal();
+        return;
+    }
+
+    // The copy shares the queue's data; the file is written without holding the queue
+    const PersistenceQueue journal = m_queue;
+    m_journaledSequence = m_enqueued;
+    locker.unlock();
+
+    const bool saved = journal.saveJournal(m_journalPath, m_journalMaxBytes);
+
+    locker.relock();
+    m_journalOnDisk = m_journalOnDisk || saved;
+}
+
+void PersistenceWorker::removeJournal()
+{
+    if (!m_journalOnDisk) return;
+    m_journalOnDisk = false;
+
+    if (QFile::remove(m_journalPath)) {
+        qDebug() << "Persistence journal written to the database, removed" << m_journalPath;
+    }
+}
+
+PersistenceQueue::WriteResult PersistenceWorker::writeBatch(const QVector<AircraftSnapshot>& batch)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    try {
+        PooledConnection c = DatabaseService::instance().acquireConnection();
+        DatabaseMetrics::Timer metrics("aircraft_copy_merge");
+        pqxx::work txn(*c);
+
+        // COPY the whole batch in one stream; aircraft_staging is created per
+        // connection by PreparedStatements::prepareAll and each commit empties it
+        auto stream = pqxx::stream_to::table(txn, {"aircraft_staging"},
+            {"aircraft_id", "call_sign", "aircraft_type", "longitude", "latitude",
+             "altitude", "speed", "heading", "velocity_x", "velocity_y",
+             "state", "flight_route_id", "is_moving", "updated_at"});
+
+        for (const AircraftSnapshot& snapshot : batch) {
+            stream.write_values(
+                snapshot.aircraftId.toStdString(),
+                snapshot.callSign.toStdString(),
+                snapshot.aircraftType.toStdString(),
+                snapshot.position.x(),
+                snapshot.position.y(),
+                snapshot.altitude,
+                snapshot.speed,
+                snapshot.heading,
+                snapshot.velocity.x(),
+                snapshot.velocity.y(),
+                snapshot.state,
+                snapshot.flightRouteId.toStdString(),
+                snapshot.isMoving,
+                snapshot.updatedAt.toString(Qt::ISODate).toStdString()
+            );
+        }
+        stream.complete();
+
+        // One set-based upsert from the staging rows
+        PreparedStatements::exec(txn, PreparedStatements::AircraftMergeStaging);
+
+        txn.commit();
+        metrics.finish(static_cast<quint64>(batch.size()));
+
+        qint64 elapsedMs = timer.elapsed();
+        double rowsPerSecond = batch.size() * 1000.0 / qMax<qint64>(1, elapsedMs);
+        qDebug() << "Persisted" << batch.size() << "aircraft in" << elapsedMs << "ms,"
+                 << qRound(rowsPerSecond) << "rows/s";
+        emit batchWritten(batch.size(), elapsedMs, rowsPerSecond);
+        return PersistenceQueue::Written;
+
+    } catch (const std::exception &) {
+        return PersistenceQueue::classifyFailure("persisting aircraft updates,", batch.size());
+    }
+}
+
+PersistenceQueue::WriteResult PersistenceWorker::writeDeletes(const QStringList& aircraftIds)
+{
+    try {
+        PooledConnection c = DatabaseService::instance().acquireConnection();
+        pqxx::work txn(*c);
+
+        for (const QString& aircraftId : aircraftIds) {
+            PreparedStatements::exec(txn, PreparedStatements::AircraftDelete, aircraftId.toStdString());
+        }
+
+        txn.commit();
+        qDebug() << "Deleted" << aircraftIds.size() << "aircraft from database:" << aircraftIds;
+        return PersistenceQueue::Written;
+
+    } catch (const std::exception &) {
+        return PersistenceQueue::classifyFailure("deleting aircraft,", aircraftIds.size());
+    }
+}
+
+bool PersistenceWorker::ensureHistoryPartitions(const QVector<PositionSample>& samples)
+{
+    QSet<QDate> missing;
+    for (const PositionSample& sample : samples) {
+        QDate day = sample.recordedAt.toUTC().date();
+        if (!m_historyPartitions.contains(day)) {
+            missing.insert(day);
+        }
+    }
+    if (missing.isEmpty()) return true;
+
+    // Normally only at startup and on the first flush of a new day; create a little
+    // ahead and let retention run once a day as a side effect
+    ConfigManager& config = ConfigManager::instance();
+    DatabaseService& dbService = DatabaseService::instance();
+    for (const QDate& day : qAsConst(missing)) {
+        if (!dbService.ensurePositionHistoryPartitions(day, config.getPositionHistoryPartitionDaysAhead() + 1)) {
+            return false;
+        }
+        for (int i = 0; i <= config.getPositionHistoryPartitionDaysAhead(); ++i) {
+            m_historyPartitions.insert(day.addDays(i));
+        }
+        dbService.dropPositionHistoryBefore(day.addDays(-config.getPositionHistoryRetentionDays()));
+    }
+    return true;
+}
+
+PersistenceQueue::WriteResult PersistenceWorker::writeHistory(const QVector<PositionSample>& samples)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    try {
+        if (!ensureHistoryPartitions(samples)) {
+            qDebug() << "No partition to hold" << samples.size() << "position samples yet";
+            return PersistenceQueue::Retry;
+        }
+
+        PooledConnection c = DatabaseService::instance().acquireConnection();
+        DatabaseMetrics::Timer metrics("position_history_copy");
+        pqxx::work txn(*c);
+
+        // Append-only, so COPY goes straight into the partitioned table
+        auto stream = pqxx::stream_to::table(txn, {"position_history"},
+            {"aircraft_id", "recorded_at", "longitude", "latitude", "altitude", "speed", "heading"});
+
+        for (const PositionSample& sample : samples) {
+            stream.write_values(
+                sample.aircraftId.toStdString(),
+                sample.recordedAt.toUTC().toString(Qt::ISODateWithMs).toStdString(),
+                sample.position.x(),
+                sample.position.y(),
+                sample.altitude,
+                sample.speed,
+                sample.heading
+            );
+        }
+        stream.complete();
+
+        txn.commit();
+        metrics.finish(static_cast<quint64>(samples.size()));
+
+        qint64 elapsedMs = timer.elapsed();
+        double samplesPerSecond = samples.size() * 1000.0 / qMax<qint64>(1, elapsedMs);
+        qDebug() << "Recorded" << samples.size() << "position samples in" << elapsedMs << "ms,"
+                 << qRound(samplesPerSecond) << "samples/s";
+        emit historyWritten(samples.size(), elapsedMs, samplesPerSecond);
+        return PersistenceQueue::Written;
+
+    } catch (const std::exception &) {
+        return PersistenceQueue::classifyFailure("recording position samples,", samples.size());
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include "persistencequeue.h"
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSet>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+#include <QDate>
+
+/**
+ * @brief Write-behind queue that persists aircraft state on its own thread
+ *
+ * Callers enqueue snapshots without touching the database. Snapshots for the
+ * same aircraft coalesce to the latest one, and the queue is written when the
+ * flush interval elapses or the batch size is reached, whichever comes first.
+ * Each flush is one COPY into a staging table plus one set-based upsert.
+ *
+ * Deletes go through the same queue and are written after the batch they
+ * follow, so a queued update can never recreate a deleted row.
+ *
+ * Every snapshot is also kept, uncoalesced, as a position history sample and
+ * COPY'd straight into the day-partitioned position_history table.
+ *
+ * While DatabaseService is offline nothing is written: the queues act as a
+ * bounded journal (latest snapshot per aircraft, at most max_pending_samples
+ * samples) and failed batches are put back. The journal is replayed when the
+ * service reports the database connected again. Writes that fail while the
+ * service still looks healthy (a connection broken mid-transaction, a pool
+ * timeout, a serialization failure) are put back and retried after the flush
+ * interval; only rows the server rejects as invalid are dropped.
+ *
+ * The journal is also saved to the persistence journal file: at most every
+ * save interval while writes are failing, and at shutdown if anything is still
+ * unwritten. The file is capped at max_size_mb by dropping the oldest position
+ * samples, is replayed when the worker starts, and is removed once everything
+ * in it has been written.
+ */
+class PersistenceWorker : public QThread {
+    Q_OBJECT
+public:
+    static PersistenceWorker& instance();
+
+    // Thread-safe; replaces any queued snapshot of the same aircraft
+    void enqueue(const AircraftSnapshot& snapshot);
+    // Drop a queued snapshot, e.g. before the aircraft row is deleted
+    void discard(const QString& aircraftId);
+    // Thread-safe; drops any queued snapshot and deletes the aircraft row with the next flush
+    void enqueueDelete(const QString& aircraftId);
+
+    // Block until everything enqueued so far has been written (or journaled while offline)
+    void flush();
+    // Write the queue now without waiting for it
+    void requestFlush();
+    // Flush and stop the thread; later snapshots are no longer written
+    void shutdown();
+
+    int pendingCount() const;
+    int pendingSampleCount() const;
+
+signals:
+    // Emitted from the worker thread after every successful flush
+    void batchWritten(int rows, qint64 elapsedMs, double rowsPerSecond);
+    void historyWritten(int samples, qint64 elapsedMs, double samplesPerSecond);
+
+protected:
+    void run() override;
+
+private:
+    PersistenceWorker();
+    ~PersistenceWorker();
+
+    PersistenceQueue::WriteResult writeBatch(const QVector<AircraftSnapshot>& batch);
+    PersistenceQueue::WriteResult writeHistory(const QVector<PositionSample>& samples);
+    PersistenceQueue::WriteResult writeDeletes(const QStringList& aircraftIds);
+    bool ensureHistoryPartitions(const QVector<PositionSample>& samples);
+
+    // Journal file; saveJournal() unlocks locker while writing
+    void loadJournal();
+    void saveJournal(QMutexLocker& locker);
+    void removeJournal();
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    QWaitCondition m_flushed;
+    PersistenceQueue m_queue;
+
+    // Sequence numbers let flush() wait for exactly the work queued before it
+    quint64 m_enqueued = 0;
+    quint64 m_written = 0;
+    bool m_flushRequested = false;
+    bool m_stopping = false;
+
+    int m_flushIntervalMs;
+    int m_batchSize;
+    bool m_historyEnabled;
+    int m_historyBatchSize;
+
+    QString m_journalPath;
+    qint64 m_journalMaxBytes;
+    int m_journalSaveIntervalMs;
+    bool m_journalOnDisk = false;
+    quint64 m_journaledSequence = 0; // m_enqueued when the file was last written
+
+    // Worker thread only: days whose partition is known to exist
+    QSet<QDate> m_historyPartitions;
+};
@@ -0,0 +1,202 @@
+#include "preparedstatements.h"
+#include "../core/configmanager.h"
+#include <QDebug>
+#include <QString>
+#include <QPair>
+#include <QVector>
+
+namespace {
+
+struct Definition {
+    const char* name;
+    const char* sql;
+};
+
+const Definition s_definitions[] = {
+    // Aircraft
+    { PreparedStatements::AircraftLoad, R"(
+        SELECT call_sign, aircraft_type, longitude, latitude, altitude, speed, heading,
+               velocity_x, velocity_y, state, flight_route_id, is_moving, created_at, updated_at
+        FROM aircraft
+        WHERE aircraft_id = $1
+    )" },
+    { PreparedStatements::AircraftDelete,
+        "DELETE FROM aircraft WHERE aircraft_id = $1" },
+    { PreparedStatements::AircraftExists,
+        "SELECT COUNT(*) FROM aircraft WHERE aircraft_id = $1" },
+    { PreparedStatements::AircraftMergeStaging, R"(
+        INSERT INTO aircraft
+            (aircraft_id, call_sign, aircraft_type, longitude, latitude, altitude, speed,
+             heading, velocity_x, velocity_y, state, flight_route_id, is_moving, updated_at)
+        SELECT aircraft_id, call_sign, aircraft_type, longitude, latitude, altitude, speed,
+               heading, velocity_x, velocity_y, state, flight_route_id, is_moving, updated_at
+        FROM aircraft_staging
+        ON CONFLICT (aircraft_id)
+        DO UPDATE SET
+            call_sign = EXCLUDED.call_sign,
+            aircraft_type = EXCLUDED.aircraft_type,
+            longitude = EXCLUDED.longitude,
+            latitude = EXCLUDED.latitude,
+            altitude = EXCLUDED.altitude,
+            speed = EXCLUDED.speed,
+            heading = EXCLUDED.heading,
+            velocity_x = EXCLUDED.velocity_x,
+            velocity_y = EXCLUDED.velocity_y,
+            state = EXCLUDED.state,
+            flight_route_id = EXCLUDED.flight_route_id,
+            is_moving = EXCLUDED.is_moving,
+            updated_at = EXCLUDED.updated_at
+    )" },
+
+    // Position history; the time range prunes partitions at execution
+    { PreparedStatements::HistoryLoadTrack, R"(
+        SELECT EXTRACT(EPOCH FROM recorded_at) AS epoch, longitude, latitude, altitude, speed, heading
+        FROM position_history
+        WHERE aircraft_id = $1 AND recorded_at >= $2 AND recorded_at < $3
+        ORDER BY recorded_at
+    )" },
+
+    // Polygon regions; geom is a MultiPolygon, single polygons are wrapped on write
+    { PreparedStatements::RegionLoadAll, R"(
+        SELECT region_id, name, description, created_at, updated_at,
+               ST_AsBinary(geom) as wkb_geometry
+        FROM polygon_regions
+        ORDER BY created_at
+    )" },
+    { PreparedStatements::RegionLoad, R"(
+        SELECT name, description, created_at, updated_at,
+               ST_AsBinary(geom) as wkb_geometry
+        FROM polygon_regions
+        WHERE region_id = $1
+    )" },
+    { PreparedStatements::RegionLoadMany, R"(
+        SELECT region_id, name, description, created_at, updated_at,
+               ST_AsBinary(geom) as wkb_geometry
+        FROM polygon_regions
+        WHERE region_id = ANY($1::varchar[])
+    )" },
+    { PreparedStatements::RegionInsert, R"(
+        INSERT INTO polygon_regions (region_id, name, description, geom, created_at, updated_at)
+        VALUES ($1, $2, $3, ST_Multi(ST_GeomFromWKB($4, 4326)), $5, $6)
+    )" },
+    { PreparedStatements::RegionUpdate, R"(
+        UPDATE polygon_regions SET
+            name = $2, description = $3, geom = ST_Multi(ST_GeomFromWKB($4, 4326)), updated_at = $5
+        WHERE region_id = $1
+    )" },
+    { PreparedStatements::RegionDelete,
+        "DELETE FROM polygon_regions WHERE region_id = $1" },
+    { PreparedStatements::RegionCountByName,
+        "SELECT COUNT(*) FROM polygon_regions WHERE name = $1" },
+
+    // Flight routes and waypoints
+    { PreparedStatements::RouteUpsert, R"(
+        INSERT INTO flight_routes (route_id, route_type, description, color, width, visible, active)
+        VALUES ($1, $2, $3, $4, $5, $6, $7)
+        ON CONFLICT (route_id)
+        DO UPDATE SET
+            route_type = EXCLUDED.route_type,
+            description = EXCLUDED.description,
+            color = EXCLUDED.color,
+            width = EXCLUDED.width,
+            visible = EXCLUDED.visible,
+            active = EXCLUDED.active,
+            updated_at = CURRENT_TIMESTAMP
+    )" },
+    { PreparedStatements::RouteLoad, R"(
+        SELECT route_type, description, color, width, visible, active
+        FROM flight_routes
+        WHERE route_id = $1
+    )" },
+    { PreparedStatements::RouteDelete,
+        "DELETE FROM flight_routes WHERE route_id = $1" },
+    { PreparedStatements::RouteExists,
+        "SELECT COUNT(*) FROM flight_routes WHERE route_id = $1" },
+    { PreparedStatements::RouteListIds,
+        "SELECT route_id FROM flight_routes ORDER BY created_at" },
+    { PreparedStatements::WaypointsLoad, R"(
+        SELECT name, longitude, latitude, altitude, estimated_time, description
+        FROM route_waypoints
+        WHERE route_id = $1
+        ORDER BY waypoint_order
+    )" },
+    { PreparedStatements::WaypointsDelete,
+        "DELETE FROM route_waypoints WHERE route_id = $1" },
+};
+
+// Statements on the display polygons table, whose name and columns come from database.json
+QVector<QPair<const char*, QString>> configuredDefinitions()
+{
+    ConfigManager& config = ConfigManager::instance();
+    const QString table = config.getDatabasePolygonsTableName();
+    const QString geometry = config.getDatabasePolygonsGeometryColumn();
+    const QString id = config.getDatabasePolygonsIdColumn();
+
+    return {
+        { PreparedStatements::PolygonLoadFirst,
+            QString("SELECT ST_AsBinary(%1) FROM %2 ORDER BY %3 LIMIT 1").arg(geometry, table, id) },
+        { PreparedStatements::PolygonCountByName,
+            QString("SELECT COUNT(*) FROM %1 WHERE name = $1").arg(table) },
+        { PreparedStatements::PolygonInsert,
+            QString("INSERT INTO %1 (name, %2) VALUES ($1, ST_GeomFromText($2, 4326))").arg(table, geometry) },
+    };
+}
+
+} // namespace
+
+quint64 PreparedStatements::rowCount(const pqxx::result& result)
+{
+    return static_cast<quint64>(result.empty() ? result.affected_rows() : result.size());
+}
+
+quint64 PreparedStatements::resultBytes(const pqxx::result& result)
+{
+    quint64 bytes = 0;
+    for (const auto& row : result) {
+        for (const auto& field : row) {
+            bytes += field.size();
+        }
+    }
+    return bytes;
+}
+
+void PreparedStatements::prepareAll(pqxx::connection& connection)
+{
+    // Session-lifetime staging table used by the persistence worker's bulk upsert;
+    // it has to exist before the statement that reads from it can be prepared
+    {
+        pqxx::nontransaction txn(connection);
+        txn.exec(R"(
+            CREATE TEMP TABLE IF NOT EXISTS aircraft_staging (
+                aircraft_id VARCHAR(255),
+                call_sign VARCHAR(50),
+                aircraft_type VARCHAR(50),
+                longitude DOUBLE PRECISION,
+                latitude DOUBLE PRECISION,
+                altitude DOUBLE PRECISION,
+                speed DOUBLE PRECISION,
+                heading DOUBLE PRECISION,
+                velocity_x DOUBLE PRECISION,
+                velocity_y DOUBLE PRECISION,
+                state INTEGER,
+                flight_route_id VARCHAR(255),
+                is_moving BOOLEAN,
+                updated_at TIMESTAMP
+            ) ON COMMIT DELETE ROWS
+        )");
+    }
+
+    for (const Definition& definition : s_definitions) {
+        connection.prepare(definition.name, definition.sql);
+    }
+
+    // The display table is created by setup_database.sql, not by the application;
+    // without it these statements are skipped and their callers fail as before
+    for (const auto& definition : configuredDefinitions()) {
+        try {
+            connection.prepare(definition.first, definition.second.toStdString());
+        } catch (const pqxx::sql_error& e) {
+            qDebug() << "Not preparing" << definition.first << ":" << e.what();
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "databasemetrics.h"
+#include <pqxx/pqxx>
+#include <utility>
+
+/**
+ * @brief Registry of the recurring SQL statements, prepared once per pooled connection
+ *
+ * DatabaseService installs prepareAll() as the pool's connection initializer,
+ * so every connection handed out already has these statements parsed and
+ * planned on the server. Call sites refer to them by name through exec(),
+ * which also records latency, rows and bytes in DatabaseMetrics.
+ */
+class PreparedStatements {
+public:
+    // Aircraft
+    static constexpr const char* AircraftLoad = "aircraft_load";
+    static constexpr const char* AircraftDelete = "aircraft_delete";
+    static constexpr const char* AircraftExists = "aircraft_exists";
+    static constexpr const char* AircraftMergeStaging = "aircraft_merge_staging";
+
+    // Position history
+    static constexpr const char* HistoryLoadTrack = "history_load_track";
+
+    // Polygon regions
+    static constexpr const char* RegionLoadAll = "region_load_all";
+    static constexpr const char* RegionLoad = "region_load";
+    static constexpr const char* RegionLoadMany = "region_load_many";
+    static constexpr const char* RegionInsert = "region_insert";
+    static constexpr const char* RegionUpdate = "region_update";
+    static constexpr const char* RegionDelete = "region_delete";
+    static constexpr const char* RegionCountByName = "region_count_by_name";
+
+    // Flight routes and waypoints
+    static constexpr const char* RouteUpsert = "route_upsert";
+    static constexpr const char* RouteLoad = "route_load";
+    static constexpr const char* RouteDelete = "route_delete";
+    static constexpr const char* RouteExists = "route_exists";
+    static constexpr const char* RouteListIds = "route_list_ids";
+    static constexpr const char* WaypointsLoad = "waypoints_load";
+    static constexpr const char* WaypointsDelete = "waypoints_delete";
+
+    // Configured display polygons table (tables.polygons); prepared only where it exists
+    static constexpr const char* PolygonLoadFirst = "polygon_load_first";
+    static constexpr const char* PolygonCountByName = "polygon_count_by_name";
+    static constexpr const char* PolygonInsert = "polygon_insert";
+
+    // Session setup plus PREPARE of every registered statement; requires the schema to exist
+    static void prepareAll(pqxx::connection& connection);
+
+    template<typename... Args>
+    static pqxx::result exec(pqxx::transaction_base& txn, const char* name, Args&&... args)
+    {
+        DatabaseMetrics::Timer timer(name);
+        pqxx::result result = txn.exec_prepared(name, std::forward<Args>(args)...);
+        timer.finish(rowCount(result), resultBytes(result));
+        return result;
+    }
+
+    // Rows returned, or affected for DML
+    static quint64 rowCount(const pqxx::result& result);
+    // Payload size of the returned fields in their text/binary wire form
+    static quint64 resultBytes(const pqxx::result& result);
+};
@@ -0,0 +1,303 @@
+#include "vectorloader.h"
+#include "../core/configmanager.h"
+#include <QThreadPool>
+#include <QPointer>
+#include <QFileInfo>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QVariant>
+#include <QDebug>
+#include <mutex>
+#include <gdal.h>
+#include <gdal_priv.h>
+#include <ogrsf_frmts.h>
+
+namespace {
+
+void appendExteriorRing(const OGRPolygon* polygon, QVector<QPolygonF>& out)
+{
+    const OGRLinearRing* ring = polygon->getExteriorRing();
+    if (!ring || ring->getNumPoints() == 0) return;
+
+    QPolygonF qpoly;
+    qpoly.reserve(ring->getNumPoints());
+    for (int i = 0; i < ring->getNumPoints(); ++i) {
+        qpoly << QPointF(ring->getX(i), ring->getY(i));
+    }
+    out.append(qpoly);
+}
+
+// Exterior rings only, as the map draws filled outlines
+void appendPolygons(const OGRGeometry* geometry, QVector<QPolygonF>& out)
+{
+    switch (wkbFlatten(geometry->getGeometryType())) {
+    case wkbPolygon:
+        appendExteriorRing(geometry->toPolygon(), out);
+        break;
+    case wkbMultiPolygon: {
+        const OGRMultiPolygon* multiPolygon = geometry->toMultiPolygon();
+        for (int i = 0; i < multiPolygon->getNumGeometries(); ++i) {
+            appendPolygons(multiPolygon->getGeometryRef(i), out);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// Field values as JSON; the first field called "name" in any case also becomes the feature name
+QJsonObject readAttributes(OGRFeature* feature, QString& name)
+{
+    QJsonObject attributes;
+    for (int i = 0; i < feature->GetFieldCount(); ++i) {
+        if (!feature->IsFieldSetAndNotNull(i)) continue;
+
+        const OGRFieldDefn* field = feature->GetFieldDefnRef(i);
+        const QString key = QString::fromUtf8(field->GetNameRef());
+        switch (field->GetType()) {
+        case OFTInteger:
+        case OFTInteger64:
+            attributes[key] = static_cast<double>(feature->GetFieldAsInteger64(i));
+            break;
+        case OFTReal:
+            attributes[key] = feature->GetFieldAsDouble(i);
+            break;
+        default:
+            attributes[key] = QString::fromUtf8(feature->GetFieldAsString(i));
+            break;
+        }
+
+        if (name.isEmpty() && key.compare("name", Qt::CaseInsensitive) == 0) {
+            name = attributes[key].toVariant().toString();
+        }
+    }
+    return attributes;
+}
+
+qint64 countPolygons(const GeometryCache& cache)
+{
+    qint64 count = 0;
+    for (int feature = 0; feature < cache.featureCount(); ++feature) {
+        count += cache.ringCount(feature, 0);
+    }
+    return count;
+}
+
+} // namespace
+
+struct VectorLoader::Job {
+    QPointer<VectorLoader> owner;
+    int generation;
+    QString path;
+    int batchSize;
+    bool cacheEnabled;
+    QString cacheDirectory;
+    std::shared_ptr<std::atomic_bool> cancelled;
+};
+
+VectorLoader::VectorLoader(QObject* parent)
+    : QObject(parent)
+{
+    ConfigManager& config = ConfigManager::instance();
+    m_batchSize = qMax(1, config.getVectorLoadBatchSize());
+    m_cacheEnabled = config.getGeometryCacheEnabled();
+    m_cacheDirectory = config.getGeometryCacheDirectory();
+}
+
+VectorLoader::~VectorLoader()
+{
+    cancel();
+}
+
+QString VectorLoader::findDefaultSource()
+{
+    // GeoJSON first, then indexed formats and shapefiles; the current directory is the fallback
+    const QStringList candidates = {
+        "resources/shapefiles/vn.json",
+        "resources/shapefiles/vn.gpkg",
+        "resources/shapefiles/vn.fgb",
+        "resources/shapefiles/vn.shp",
+        "vn.json",
+        "vn.shp"
+    };
+
+    for (const QString& path : candidates) {
+        if (QFileInfo::exists(path)) {
+            return path;
+        }
+        qDebug() << "Vector data file not found:" << path;
+    }
+    return QString();
+}
+
+void VectorLoader::load(const QString& path)
+{
+    cancel();
+
+    m_path = path;
+    m_loading = true;
+    m_cancelled = std::make_shared<std::atomic_bool>(false);
+
+    auto job = std::make_shared<Job>();
+    job->owner = this;
+    job->generation = m_generation;
+    job->path = path;
+    job->batchSize = m_batchSize;
+    job->cacheEnabled = m_cacheEnabled;
+    job->cacheDirectory = m_cacheDirectory;
+    job->cancelled = m_cancelled;
+
+    QThreadPool::globalInstance()->start([job]() { read(job); });
+}
+
+void VectorLoader::cancel()
+{
+    // Anything still queued from the running load carries the old generation
+    ++m_generation;
+    if (m_cancelled) {
+        *m_cancelled = true;
+        m_cancelled.reset();
+    }
+    if (m_loading) {
+        qDebug() << "Cancelled vector load of" << m_path;
+        m_loading = false;
+    }
+}
+
+void VectorLoader::post(const std::shared_ptr<Job>& job, std::function<void(VectorLoader*)> deliver)
+{
+    QMetaObject::invokeMethod(QCoreApplication::instance(), [job, deliver]() {
+        VectorLoader* loader = job->owner;
+        if (!loader || loader->m_generation != job->generation) return;
+        deliver(loader);
+    }, Qt::QueuedConnection);
+}
+
+void VectorLoader::read(const std::shared_ptr<Job>& job)
+{
+    static std::once_flag gdalRegistered;
+    std::call_once(gdalRegistered, []() { GDALAllRegister(); });
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QByteArray sourceHash;
+    QString cachePath;
+    if (job->cacheEnabled) {
+        sourceHash = GeometryCache::hashSource(job->path);
+        if (!sourceHash.isEmpty()) {
+            cachePath = GeometryCache::cacheFilePath(job->cacheDirectory, sourceHash);
+            if (std::shared_ptr<const GeometryCache> cache = GeometryCache::open(cachePath, sourceHash)) {
+                const qint64 features = cache->featureCount();
+                const qint64 polygons = countPolygons(*cache);
+                qDebug() << "Mapped geometry cache for" << job->path << ":" << features << "features in"
+                         << timer.elapsed() << "ms";
+                post(job, [job, cache, features, polygons](VectorLoader* loader) {
+                    emit loader->loadStarted(job->path, features);
+                    emit loader->cacheReady(cache);
+                    emit loader->progress(features, features);
+                    loader->m_loading = false;
+                    emit loader->loadFinished(job->path, features, polygons);
+                });
+                return;
+            }
+        }
+    }
+
+    GDALDataset* dataset = static_cast<GDALDataset*>(
+        GDALOpenEx(job->path.toLocal8Bit().constData(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr));
+    if (!dataset) {
+        const QString error = QString::fromLocal8Bit(CPLGetLastErrorMsg());
+        qDebug() << "Failed to open vector data:" << job->path << "- GDAL Error:" << error;
+        post(job, [job, error](VectorLoader* loader) {
+            loader->m_loading = false;
+            emit loader->loadFailed(job->path, error);
+        });
+        return;
+    }
+
+    OGRLayer* layer = dataset->GetLayer(0);
+    if (!layer) {
+        GDALClose(dataset);
+        qDebug() << "No layer found in vector data:" << job->path;
+        post(job, [job](VectorLoader* loader) {
+            loader->m_loading = false;
+            emit loader->loadFailed(job->path, "No layer found");
+        });
+        return;
+    }
+
+    // Only a cheap count: forcing one would scan a shapefile or GeoJSON twice
+    const qint64 total = layer->GetFeatureCount(FALSE);
+    post(job, [job, total](VectorLoader* loader) {
+        emit loader->loadStarted(job->path, total);
+    });
+
+    qint64 featureCount = 0;
+    qint64 polygonCount = 0;
+    QVector<GeometryCache::SourceFeature> batch;
+    int batchFeatures = 0;
+    QVector<GeometryCache::SourceFeature> compiled;  // Only filled when a cache is written
+
+    auto flush = [&]() {
+        const qint64 featuresRead = featureCount;
+        post(job, [batch, featuresRead, total](VectorLoader* loader) {
+            if (!batch.isEmpty()) {
+                emit loader->batchLoaded(batch);
+            }
+            emit loader->progress(featuresRead, total);
+        });
+        batch.clear();
+        batchFeatures = 0;
+    };
+
+    layer->ResetReading();
+    OGRFeature* feature;
+    while (!*job->cancelled && (feature = layer->GetNextFeature()) != nullptr) {
+        if (const OGRGeometry* geometry = feature->GetGeometryRef()) {
+            // Attributes travel with the rings, so a load without a cache still has names
+            GeometryCache::SourceFeature source;
+            appendPolygons(geometry, source.rings);
+            source.attributes = readAttributes(feature, source.name);
+            polygonCount += source.rings.size();
+
+            if (!cachePath.isEmpty()) {
+                compiled.append(source);
+            }
+            batch.append(std::move(source));
+        }
+        OGRFeature::DestroyFeature(feature);
+        ++featureCount;
+
+        if (++batchFeatures >= job->batchSize) {
+            flush();
+        }
+    }
+
+    GDALClose(dataset);
+
+    if (*job->cancelled) {
+        qDebug() << "Vector load of" << job->path << "stopped after" << featureCount << "features";
+        return;
+    }
+
+    flush();
+    qDebug() << "Loaded" << featureCount << "features with" << polygonCount << "polygons from"
+             << job->path << "in" << timer.elapsed() << "ms";
+
+    // Later starts map this instead of parsing the source again
+    std::shared_ptr<const GeometryCache> cache;
+    if (!cachePath.isEmpty() && GeometryCache::build(cachePath, sourceHash, compiled)) {
+        cache = GeometryCache::open(cachePath, sourceHash);
+    }
+
+    post(job, [job, cache, featureCount, polygonCount](VectorLoader* loader) {
+        if (cache) {
+            emit loader->cacheReady(cache);
+        }
+        loader->m_loading = false;
+        emit loader->loadFinished(job->path, featureCount, polygonCount);
+    });
+}
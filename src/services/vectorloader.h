@@ -0,0 +1,63 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QPolygonF>
+#include "../core/geometrycache.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief Streams polygons out of an OGR vector source on the global thread pool
+ *
+ * Features are read with GetNextFeature() on a pool thread and handed to the
+ * GUI thread, rings together with name and attributes, in batches of
+ * vector_loading.batch_size, so large datasets appear progressively while the
+ * map stays interactive. Starting a new load
+ * or calling cancel() stops the running read at the next feature; batches of
+ * a superseded load that are still queued are dropped, never emitted.
+ *
+ * With the geometry cache enabled, a source that was read before is served
+ * from its compiled GeometryCache instead, without any parsing; otherwise the
+ * features read are compiled into one after the last batch. Either way
+ * cacheReady() hands over the mapped cache, which supersedes the batches.
+ */
+class VectorLoader : public QObject {
+    Q_OBJECT
+public:
+    explicit VectorLoader(QObject* parent = nullptr);
+    ~VectorLoader();
+
+    // First existing file of the bundled Vietnam boundary candidates, or empty
+    static QString findDefaultSource();
+
+    // Cancels any load in progress and starts reading path
+    void load(const QString& path);
+    void cancel();
+    bool isLoading() const { return m_loading; }
+    QString currentPath() const { return m_path; }
+
+signals:
+    // All signals are emitted on the GUI thread and only for the current load
+    void loadStarted(const QString& path, qint64 totalFeatures);  // total -1 when the driver cannot count cheaply
+    void batchLoaded(const QVector<GeometryCache::SourceFeature>& features);
+    void cacheReady(std::shared_ptr<const GeometryCache> cache);
+    void progress(qint64 featuresRead, qint64 totalFeatures);
+    void loadFinished(const QString& path, qint64 features, qint64 polygons);
+    void loadFailed(const QString& path, const QString& error);
+
+private:
+    struct Job;
+
+    static void read(const std::shared_ptr<Job>& job);
+    static void post(const std::shared_ptr<Job>& job, std::function<void(VectorLoader*)> deliver);
+
+    int m_generation = 0;
+    std::shared_ptr<std::atomic_bool> m_cancelled;
+    bool m_loading = false;
+    QString m_path;
+    int m_batchSize;
+    bool m_cacheEnabled;
+    QString m_cacheDirectory;
+};
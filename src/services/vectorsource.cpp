@@ -0,0 +1,48 @@
+#include "vectorsource.h"
+#include <QFileInfo>
+#include <QHash>
+
+VectorSource::VectorSource(const QString& path)
+    : m_path(path)
+    , m_loader(std::make_unique<VectorLoader>())
+{
+    connect(m_loader.get(), &VectorLoader::batchLoaded, this, [this](const QVector<GeometryCache::SourceFeature>& features) {
+        m_features += features;
+    });
+    connect(m_loader.get(), &VectorLoader::cacheReady, this, [this](std::shared_ptr<const GeometryCache> cache) {
+        // The mapped cache holds the same features; the parsed ones are no longer needed
+        m_cache = std::move(cache);
+        m_features.clear();
+        m_features.squeeze();
+    });
+    connect(m_loader.get(), &VectorLoader::loadFinished, this, [this]() {
+        m_state = Ready;
+    });
+    connect(m_loader.get(), &VectorLoader::loadFailed, this, [this]() {
+        m_state = Failed;
+    });
+}
+
+VectorSource::~VectorSource() = default;
+
+std::shared_ptr<VectorSource> VectorSource::acquire(const QString& path)
+{
+    static QHash<QString, std::weak_ptr<VectorSource>> sources;
+
+    const QString key = QFileInfo(path).absoluteFilePath();
+    std::shared_ptr<VectorSource> source = sources.value(key).lock();
+    if (!source) {
+        source.reset(new VectorSource(path));
+        sources.insert(key, source);
+    }
+    return source;
+}
+
+void VectorSource::load()
+{
+    if (m_state == Loading || m_state == Ready) return;
+
+    m_state = Loading;
+    m_features.clear();
+    m_loader->load(m_path);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "vectorloader.h"
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+/**
+ * @brief One vector file and what has been loaded from it, shared by all its readers
+ *
+ * The boundary layer and the reverse geocoder read the same province file.
+ * Acquiring a path that is already held returns the same source, so the file
+ * is parsed and its GeometryCache compiled once, whoever asks first. The
+ * source keeps what its loader delivered: the streamed features with their
+ * attributes until a cache is mapped, then the cache alone. Readers connect to
+ * loader() for what arrives later; the source's own connections run first, so
+ * its state is current when they are called. Releasing the last reference
+ * cancels a load in progress.
+ */
+class VectorSource : public QObject {
+    Q_OBJECT
+public:
+    enum State {
+        NotLoaded,
+        Loading,
+        Ready,
+        Failed
+    };
+
+    ~VectorSource();
+
+    // GUI thread only
+    static std::shared_ptr<VectorSource> acquire(const QString& path);
+
+    // Starts reading unless loading or loaded; a failed source is read again
+    void load();
+
+    QString path() const { return m_path; }
+    State state() const { return m_state; }
+    VectorLoader* loader() const { return m_loader.get(); }
+
+    std::shared_ptr<const GeometryCache> cache() const { return m_cache; }
+    // Longitude/latitude features read so far; empty once the cache is mapped
+    const QVector<GeometryCache::SourceFeature>& features() const { return m_features; }
+
+private:
+    explicit VectorSource(const QString& path);
+
+    QString m_path;
+    State m_state = NotLoaded;
+    std::unique_ptr<VectorLoader> m_loader;
+    std::shared_ptr<const GeometryCache> m_cache;
+    QVector<GeometryCache::SourceFeature> m_features;
+};
@@ -0,0 +1,180 @@
+#include "diagnosticsdialog.h"
+#include "../services/databasemetrics.h"
+#include "../services/databaseservice.h"
+#include "../services/persistenceworker.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QDateTime>
+#include <QStringList>
+
+namespace {
+
+QTableWidgetItem* numberItem(double value, int decimals = 0)
+{
+    QTableWidgetItem* item = new QTableWidgetItem(QString::number(value, 'f', decimals));
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+QString formatBytes(quint64 bytes)
+{
+    if (bytes >= 1024 * 1024) {
+        return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+    if (bytes >= 1024) {
+        return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    }
+    return QString("%1 B").arg(bytes);
+}
+
+} // namespace
+
+DiagnosticsDialog::DiagnosticsDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Database Diagnostics");
+    setMinimumSize(900, 450);
+
+    setupUI();
+
+    m_refreshTimer = new QTimer(this);
+    connect(m_refreshTimer, &QTimer::timeout, this, &DiagnosticsDialog::refresh);
+    m_refreshTimer->start(1000);
+
+    refresh();
+}
+
+void DiagnosticsDialog::setupUI()
+{
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    // Connection and queue summary
+    QGroupBox* summaryGroup = new QGroupBox("Connection");
+    QFormLayout* summaryLayout = new QFormLayout(summaryGroup);
+    m_healthLabel = new QLabel();
+    m_poolLabel = new QLabel();
+    m_queueLabel = new QLabel();
+    m_errorsLabel = new QLabel();
+    m_errorsLabel->setWordWrap(true);
+    summaryLayout->addRow("Health:", m_healthLabel);
+    summaryLayout->addRow("Pool:", m_poolLabel);
+    summaryLayout->addRow("Write queue:", m_queueLabel);
+    summaryLayout->addRow("Operation errors:", m_errorsLabel);
+    mainLayout->addWidget(summaryGroup);
+
+    // Per-statement statistics
+    QGroupBox* statementsGroup = new QGroupBox("Statements");
+    QVBoxLayout* statementsLayout = new QVBoxLayout(statementsGroup);
+    m_statementsTable = new QTableWidget(0, 12);
+    m_statementsTable->setHorizontalHeaderLabels({
+        "Statement", "Calls", "Calls/s", "Errors", "Error %", "Mean ms",
+        "p50 ms", "p95 ms", "p99 ms", "Max ms", "Rows", "Bytes"
+    });
+    m_statementsTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_statementsTable->verticalHeader()->setVisible(false);
+    m_statementsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_statementsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    statementsLayout->addWidget(m_statementsTable);
+    mainLayout->addWidget(statementsGroup);
+
+    // Buttons
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    m_resetButton = new QPushButton("Reset");
+    m_exportButton = new QPushButton("Export JSON...");
+    m_closeButton = new QPushButton("Close");
+    buttonLayout->addWidget(m_resetButton);
+    buttonLayout->addWidget(m_exportButton);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(m_closeButton);
+    mainLayout->addLayout(buttonLayout);
+
+    connect(m_resetButton, &QPushButton::clicked, this, &DiagnosticsDialog::onReset);
+    connect(m_exportButton, &QPushButton::clicked, this, &DiagnosticsDialog::onExport);
+    connect(m_closeButton, &QPushButton::clicked, this, &QDialog::accept);
+}
+
+void DiagnosticsDialog::refresh()
+{
+    DatabaseMetrics& metrics = DatabaseMetrics::instance();
+    DatabaseService& dbService = DatabaseService::instance();
+
+    static const char* const healthNames[] = { "Connected", "Degraded", "Offline" };
+    m_healthLabel->setText(healthNames[dbService.health()]);
+
+    DatabaseMetrics::Histogram poolWait = metrics.poolWait();
+    QString pool = QString("checkouts %1, wait mean %2 ms, p95 %3 ms, max %4 ms, failures %5")
+        .arg(poolWait.count)
+        .arg(poolWait.meanMs(), 0, 'f', 2)
+        .arg(poolWait.percentile(0.95), 0, 'f', 1)
+        .arg(poolWait.maxMs, 0, 'f', 1)
+        .arg(metrics.poolFailures());
+    if (ConnectionPool* connectionPool = dbService.connectionPool()) {
+        pool.prepend(QString("%1 open, %2 idle; ")
+            .arg(connectionPool->openConnections())
+            .arg(connectionPool->idleConnections()));
+    }
+    m_poolLabel->setText(pool);
+
+    m_queueLabel->setText(QString("%1 aircraft states, %2 position samples")
+        .arg(PersistenceWorker::instance().pendingCount())
+        .arg(PersistenceWorker::instance().pendingSampleCount()));
+
+    QStringList errors;
+    const QHash<QString, quint64> operationErrors = metrics.operationErrors();
+    for (auto it = operationErrors.cbegin(); it != operationErrors.cend(); ++it) {
+        errors << QString("%1: %2").arg(it.key()).arg(it.value());
+    }
+    errors.sort();
+    m_errorsLabel->setText(errors.isEmpty() ? "none" : errors.join(", "));
+
+    const double uptimeSeconds = qMax<qint64>(1, metrics.uptimeMs()) / 1000.0;
+    const QVector<DatabaseMetrics::StatementStats> statements = metrics.statements();
+    m_statementsTable->setRowCount(statements.size());
+    for (int row = 0; row < statements.size(); ++row) {
+        const DatabaseMetrics::StatementStats& stats = statements[row];
+        const DatabaseMetrics::Histogram& latency = stats.latency;
+        const double errorRate = latency.count ? 100.0 * stats.errors / latency.count : 0.0;
+
+        m_statementsTable->setItem(row, 0, new QTableWidgetItem(stats.name));
+        m_statementsTable->setItem(row, 1, numberItem(latency.count));
+        m_statementsTable->setItem(row, 2, numberItem(latency.count / uptimeSeconds, 2));
+        m_statementsTable->setItem(row, 3, numberItem(stats.errors));
+        m_statementsTable->setItem(row, 4, numberItem(errorRate, 1));
+        m_statementsTable->setItem(row, 5, numberItem(latency.meanMs(), 2));
+        m_statementsTable->setItem(row, 6, numberItem(latency.percentile(0.50), 1));
+        m_statementsTable->setItem(row, 7, numberItem(latency.percentile(0.95), 1));
+        m_statementsTable->setItem(row, 8, numberItem(latency.percentile(0.99), 1));
+        m_statementsTable->setItem(row, 9, numberItem(latency.maxMs, 1));
+        m_statementsTable->setItem(row, 10, numberItem(stats.rows));
+
+        QTableWidgetItem* bytesItem = new QTableWidgetItem(formatBytes(stats.bytes));
+        bytesItem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        m_statementsTable->setItem(row, 11, bytesItem);
+    }
+}
+
+void DiagnosticsDialog::onReset()
+{
+    DatabaseMetrics::instance().reset();
+    refresh();
+}
+
+void DiagnosticsDialog::onExport()
+{
+    QString defaultName = QString("gismap-db-metrics-%1.json")
+        .arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
+    QString path = QFileDialog::getSaveFileName(this, "Export Database Metrics", defaultName,
+                                                "JSON files (*.json)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    if (!DatabaseMetrics::instance().writeJson(path)) {
+        QMessageBox::warning(this, "Export Failed", QString("Could not write %1").arg(path));
+    }
+}
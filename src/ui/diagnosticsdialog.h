@@ -0,0 +1,37 @@
+#pragma once
+#include <QDialog>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QLabel>
+#include <QTimer>
+
+/**
+ * @brief Live view of DatabaseMetrics: per-statement latency, pool and queue state
+ */
+class DiagnosticsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DiagnosticsDialog(QWidget *parent = nullptr);
+
+private slots:
+    void refresh();
+    void onReset();
+    void onExport();
+
+private:
+    void setupUI();
+
+    QLabel* m_healthLabel;
+    QLabel* m_poolLabel;
+    QLabel* m_queueLabel;
+    QLabel* m_errorsLabel;
+    QTableWidget* m_statementsTable;
+
+    QPushButton* m_resetButton;
+    QPushButton* m_exportButton;
+    QPushButton* m_closeButton;
+
+    QTimer* m_refreshTimer;
+};
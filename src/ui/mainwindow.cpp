@@ -3,9 +3,16 @@
 #include "mapwidget.h"
 #include "aircraftdialog.h"
 #include "polygoneditor.h"
+#include "diagnosticsdialog.h"
 #include "../models/aircraft.h"
+#include "../services/databaseservice.h"
+#include "../layers/layerregistry.h"
+#include "../managers/reversegeocoder.h"
 #include <QTimer>
 #include <QMessageBox>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -47,6 +54,32 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_mapWidget, &MapWidget::coordinatesChanged, this, &MainWindow::updateStatusBar);
     connect(m_mapWidget, &MapWidget::aircraftSelected, this, &MainWindow::onAircraftSelected);
     connect(m_mapWidget, &MapWidget::aircraftClicked, this, &MainWindow::onAircraftClicked);
+    connect(m_mapWidget->geofenceManager(), &GeofenceManager::geofenceEvents, this, &MainWindow::onGeofenceEvents);
+    connect(m_mapWidget, &MapWidget::firstFrameRendered, this, [this](qint64 elapsedMs) {
+        statusBar()->showMessage(QString("Map ready in %1 ms, loading data...").arg(elapsedMs), 3000);
+    });
+    LayerRegistry* layers = m_mapWidget->layerRegistry();
+    connect(layers, &LayerRegistry::loadProgress, this, [this](const QString& layer, qint64 read, qint64 total) {
+        statusBar()->showMessage(total > 0
+            ? QString("Loading %1: %2 of %3 features").arg(layer).arg(read).arg(total)
+            : QString("Loading %1: %2 features").arg(layer).arg(read), 2000);
+    });
+    connect(layers, &LayerRegistry::layerLoaded, this,
+            [this](const QString& layer, qint64 features, qint64 polygons) {
+        statusBar()->showMessage(QString("Loaded %1 features (%2 polygons) for %3")
+                                 .arg(features).arg(polygons).arg(layer), 5000);
+    });
+    connect(layers, &LayerRegistry::layerLoadFailed, this, [this](const QString& layer, const QString& error) {
+        statusBar()->showMessage(QString("Cannot load %1: %2").arg(layer, error), 5000);
+    });
+    connect(layers, &LayerRegistry::layersChanged, this, &MainWindow::updateLayersMenu);
+    updateLayersMenu();
+    connect(&DatabaseService::instance(), &DatabaseService::healthChanged, this,
+            [this](DatabaseService::Health health) {
+        statusBar()->showMessage(health == DatabaseService::Connected ? "Database connected"
+                                 : health == DatabaseService::Degraded ? "Database degraded, retrying"
+                                 : "Database offline, changes are journaled until it returns", 5000);
+    });
     
     // Update tile server actions to reflect current state
     updateTileServerActions();
@@ -77,6 +110,9 @@ void MainWindow::onAircraftSelected(Aircraft* aircraft)
                               .arg(aircraft->heading(), 0, 'f', 1)
                               .arg(aircraft->state() == Aircraft::Normal ? "Normal" : 
                                    aircraft->state() == Aircraft::InRegion ? "In Region" : "Selected");
+                if (!aircraft->province().isEmpty()) {
+                    info += QString(", Province: %1").arg(aircraft->province());
+                }
                 m_aircraftLabel->setText(info);
             }
         });
@@ -88,6 +124,9 @@ void MainWindow::onAircraftSelected(Aircraft* aircraft)
                       .arg(aircraft->heading(), 0, 'f', 1)
                       .arg(aircraft->state() == Aircraft::Normal ? "Normal" : 
                            aircraft->state() == Aircraft::InRegion ? "In Region" : "Selected");
+        if (!aircraft->province().isEmpty()) {
+            info += QString(", Province: %1").arg(aircraft->province());
+        }
         m_aircraftLabel->setText(info);
         statusBar()->showMessage("Aircraft selected - coordinates updating in real-time", 3000);
     } else {
@@ -107,6 +146,35 @@ void MainWindow::onAircraftClicked(Aircraft* aircraft, const QPointF& position)
     }
 }
 
+void MainWindow::onGeofenceEvents(const QVector<GeofenceEvent>& events)
+{
+    if (events.isEmpty()) return;
+    
+    // One status message per batch; a single transition is spelled out
+    if (events.size() == 1) {
+        const GeofenceEvent& event = events.first();
+        GeofenceManager* geofence = m_mapWidget->geofenceManager();
+        QString regionName = geofence->regionName(event.regionId);
+        QString action = event.type == GeofenceEvent::Enter ? "entered" :
+                         event.type == GeofenceEvent::Exit ? "left" : "is dwelling in";
+        statusBar()->showMessage(QString("Aircraft %1 %2 %3")
+                                 .arg(event.aircraftId, action,
+                                      regionName.isEmpty() ? event.regionId : regionName), 3000);
+        return;
+    }
+    
+    int entered = 0, exited = 0, dwelling = 0;
+    for (const GeofenceEvent& event : events) {
+        switch (event.type) {
+            case GeofenceEvent::Enter: ++entered; break;
+            case GeofenceEvent::Exit: ++exited; break;
+            case GeofenceEvent::Dwell: ++dwelling; break;
+        }
+    }
+    statusBar()->showMessage(QString("Geofence: %1 entered, %2 exited, %3 dwelling")
+                             .arg(entered).arg(exited).arg(dwelling), 3000);
+}
+
 void MainWindow::setupMenuBar()
 {
     m_menuBar = menuBar();
@@ -165,6 +233,15 @@ void MainWindow::setupMenuBar()
     });
     mapMenu->addAction(clearCacheAction);
     
+    mapMenu->addSeparator();
+    
+    // Replace the boundary layer; the current load, if any, is cancelled
+    QAction* openVectorAction = new QAction("&Open Vector Data...", this);
+    openVectorAction->setShortcut(QKeySequence::Open);
+    openVectorAction->setStatusTip("Show a GeoJSON, shapefile, GeoPackage or FlatGeobuf source");
+    connect(openVectorAction, &QAction::triggered, this, &MainWindow::onOpenVectorData);
+    mapMenu->addAction(openVectorAction);
+    
     // Create Aircraft menu
     QMenu* aircraftMenu = m_menuBar->addMenu("&Aircraft");
     
@@ -217,6 +294,26 @@ void MainWindow::setupMenuBar()
     m_clearTrailsAction->setStatusTip("Clear all aircraft flight trails");
     connect(m_clearTrailsAction, &QAction::triggered, this, &MainWindow::onClearTrails);
     viewMenu->addAction(m_clearTrailsAction);
+    
+    viewMenu->addSeparator();
+    
+    // One checkable entry per data layer, filled once the map has built its layers
+    m_layersMenu = viewMenu->addMenu("&Layers");
+    
+    viewMenu->addSeparator();
+    
+    // Aircraft counts per province
+    QAction* provinceCountsAction = new QAction("Aircraft by &Province", this);
+    provinceCountsAction->setStatusTip("Show how many aircraft are over each province");
+    connect(provinceCountsAction, &QAction::triggered, this, &MainWindow::onShowProvinceCounts);
+    viewMenu->addAction(provinceCountsAction);
+    
+    // Database diagnostics action
+    QAction* diagnosticsAction = new QAction("Database &Diagnostics", this);
+    diagnosticsAction->setShortcut(QKeySequence("Ctrl+Shift+D"));
+    diagnosticsAction->setStatusTip("Show database latency, throughput and error statistics");
+    connect(diagnosticsAction, &QAction::triggered, this, &MainWindow::onShowDiagnostics);
+    viewMenu->addAction(diagnosticsAction);
 }
 
 /*
@@ -406,17 +503,93 @@ void MainWindow::onEditPolygons()
 {
     PolygonEditor editor(this);
     
-    // Connect signal to refresh polygons on map
-    connect(&editor, &PolygonEditor::polygonUpdated, [this]() {
+    // Edits reach the map as deltas; nothing is read back from the database
+    connect(&editor, &PolygonEditor::regionSaved, this, [this](const DatabaseService::PolygonRegion& region) {
         if (m_mapWidget) {
-            // Refresh polygons from database
-            m_mapWidget->refreshPolygons();
+            m_mapWidget->applyLocalRegion(region);
+        }
+    });
+    connect(&editor, &PolygonEditor::regionDeleted, this, [this](const QString& regionId) {
+        if (m_mapWidget) {
+            m_mapWidget->removeLocalRegion(regionId);
         }
     });
     
     editor.exec();
 }
 
+void MainWindow::updateLayersMenu()
+{
+    m_layersMenu->clear();
+    
+    // Topmost layer first, as in a legend
+    QVector<MapLayer*> layers = m_mapWidget->layerRegistry()->layers();
+    for (auto it = layers.crbegin(); it != layers.crend(); ++it) {
+        MapLayer* layer = *it;
+        QAction* action = m_layersMenu->addAction(layer->name());
+        action->setCheckable(true);
+        action->setChecked(layer->isVisible());
+        action->setStatusTip("Hidden layers release their data and read nothing");
+        connect(action, &QAction::toggled, layer, &MapLayer::setVisible);
+    }
+    m_layersMenu->setEnabled(!layers.isEmpty());
+}
+
+void MainWindow::onOpenVectorData()
+{
+    QString path = QFileDialog::getOpenFileName(this, "Open Vector Data", "resources/shapefiles",
+                                                "Vector data (*.json *.geojson *.shp *.gpkg *.fgb);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+    m_mapWidget->loadVectorData(path);
+    statusBar()->showMessage(QString("Loading %1...").arg(QFileInfo(path).fileName()), 2000);
+}
+
+void MainWindow::onShowProvinceCounts()
+{
+    ReverseGeocoder* geocoder = m_mapWidget->reverseGeocoder();
+    if (!geocoder->isReady()) {
+        QMessageBox::information(this, "Aircraft by Province", "Province boundaries are not loaded yet.");
+        return;
+    }
+    
+    // Busiest provinces first
+    const QHash<QString, int> counts = geocoder->provinceCounts();
+    QVector<QPair<QString, int>> rows;
+    for (auto it = counts.cbegin(); it != counts.cend(); ++it) {
+        rows.append(qMakePair(it.key(), it.value()));
+    }
+    std::sort(rows.begin(), rows.end(), [](const QPair<QString, int>& a, const QPair<QString, int>& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    
+    int located = 0;
+    QStringList lines;
+    for (const auto& row : rows) {
+        lines.append(QString("%1: %2").arg(row.first).arg(row.second));
+        located += row.second;
+    }
+    const int outside = m_mapWidget->aircraftManager()->aircraftCount() - located;
+    if (outside > 0) {
+        lines.append(QString("Outside all provinces: %1").arg(outside));
+    }
+    
+    QMessageBox::information(this, "Aircraft by Province",
+                             lines.isEmpty() ? QString("No aircraft.") : lines.join("\n"));
+}
+
+void MainWindow::onShowDiagnostics()
+{
+    // Non-modal so it can stay open next to the map while it refreshes
+    if (!m_diagnosticsDialog) {
+        m_diagnosticsDialog = new DiagnosticsDialog(this);
+    }
+    m_diagnosticsDialog->show();
+    m_diagnosticsDialog->raise();
+    m_diagnosticsDialog->activateWindow();
+}
+
 // Trail management implementations
 void MainWindow::onToggleTrails()
 {
@@ -434,6 +607,10 @@ void MainWindow::onToggleTrails()
         }
     }
     
+    if (m_mapWidget->trailLayer()) {
+        m_mapWidget->trailLayer()->invalidate();
+    }
+    
     statusBar()->showMessage(
         showTrails ? "Flight trails enabled" : "Flight trails disabled", 
         2000
@@ -459,6 +636,10 @@ void MainWindow::onClearTrails()
         }
     }
     
+    if (m_mapWidget->trailLayer()) {
+        m_mapWidget->trailLayer()->invalidate();
+    }
+    
     statusBar()->showMessage(
         QString("Cleared trails for %1 aircraft").arg(clearedCount), 
         2000
@@ -11,6 +11,8 @@
 #include <QActionGroup>
 #include <QDebug>
 #include <QTimer>
+#include <QVector>
+#include "../managers/geofencemanager.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -18,6 +20,7 @@ QT_END_NAMESPACE
 
 class MapWidget;
 class Aircraft;
+class DiagnosticsDialog;
 
 class MainWindow : public QMainWindow
 {
@@ -32,6 +35,8 @@ private slots:
     void onAircraftSelected(Aircraft* aircraft);
     void onAircraftClicked(Aircraft* aircraft, const QPointF& position);
     void onTileServerChanged();
+    void onOpenVectorData();
+    void updateLayersMenu();
     void updateCacheStats(); // New slot for updating cache statistics
     
     // Aircraft management slots
@@ -42,9 +47,15 @@ private slots:
     // Polygon management slots
     void onEditPolygons();
     
+    void onShowDiagnostics();
+    void onShowProvinceCounts();
+    
     // Trail management slots  
     void onToggleTrails();
     void onClearTrails();
+    
+    // Geofence notifications
+    void onGeofenceEvents(const QVector<GeofenceEvent>& events);
 
 private:
     void setupMenuBar();
@@ -57,6 +68,7 @@ private:
     QLabel *m_aircraftLabel;
     QLabel *m_cacheStatsLabel;  // New cache statistics label
     MapWidget *m_mapWidget;
+    DiagnosticsDialog *m_diagnosticsDialog = nullptr;
     
     // Menu and toolbar components
     QMenuBar *m_menuBar;
@@ -76,6 +88,9 @@ private:
     // Trail management actions
     QAction *m_toggleTrailsAction;
     QAction *m_clearTrailsAction;
+    
+    // Data layer visibility
+    QMenu *m_layersMenu = nullptr;
 };
 
 #endif // MAINWINDOW_H
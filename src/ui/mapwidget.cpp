@@ -1,6 +1,12 @@
 #include "mapwidget.h"
 #include "../core/configmanager.h"
 #include "../services/databaseservice.h"
+#include "../services/persistenceworker.h"
+#include "../services/preparedstatements.h"
+#include "../core/wkbreader.h"
+#include "../layers/vectorlayer.h"
+#include "../layers/ogrcelllayer.h"
+#include "../layers/postgislayer.h"
 #include <QPainter>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
@@ -16,27 +22,48 @@
 #include <QFileInfo>
 #include <QDateTime>
 #include <QtMath>
+#include <QThread>
+#include <QThreadPool>
+#include <QPointer>
+#include <QCoreApplication>
 #include <algorithm>
+#include <functional>
 #include <cmath>
-#include <gdal.h>
-#include <gdal_priv.h>
-#include <ogrsf_frmts.h>
 #include <pqxx/pqxx>
 
 // New architecture includes
 #include "aircraft.h"
 #include "polygonobject.h"
 
+namespace {
+
+// Runs work on the global thread pool and hands its result to apply on the GUI
+// thread; apply is skipped when the widget is gone by then
+template<typename Result>
+void runInBackground(QObject* owner, const QString& taskName, const QElapsedTimer& startup,
+                     std::function<Result()> work, std::function<void(const Result&)> apply)
+{
+    QPointer<QObject> guard(owner);
+    QThreadPool::globalInstance()->start([guard, taskName, startup, work, apply]() {
+        Result result = work();
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, taskName, startup, apply, result]() {
+            if (!guard) return;
+            apply(result);
+            qDebug() << "Background task" << taskName << "finished at" << startup.elapsed() << "ms";
+        }, Qt::QueuedConnection);
+    });
+}
+
+} // namespace
+
 MapWidget::MapWidget(QWidget *parent) : QWidget(parent) {
     // Remove fixed minimum size, use size policy instead
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     setMinimumSize(400, 300);  // Set reasonable minimum but allow expansion
     
-    // Initialize database service first (creates all tables)
-    DatabaseService& dbService = DatabaseService::instance();
-    if (!dbService.isConnected()) {
-        qWarning() << "Database connection failed! Some features may not work.";
-    }
+    // Everything below only builds in-memory state; database and file work is
+    // started at the end and streams in after the first frame
+    m_startupTimer.start();
     
     // Initialize configuration-based settings
     initializeFromConfig();
@@ -59,31 +86,19 @@ MapWidget::MapWidget(QWidget *parent) : QWidget(parent) {
     
     loadTileMap();
     
-    // According to requirements: Only create ONE polygon area around Hanoi
-    // This will be stored in PostgreSQL database and used for aircraft interaction
-    // Remove hardcoded red polygon, use database-stored polygon instead
-    
-    // Create Hanoi area polygon for database storage
-    createHanoiPolygonInDatabase();
-    
-    fetchShapefiles();  // Load Vietnam shapefile from SimpleMaps (for reference/display)
-    fetchPostgis();     // Load the main Hanoi polygon from database
-    
-    // Load existing aircraft from database first, then create samples if needed
-    loadExistingAircraft();
+    startBackgroundInitialization();
     
     // Emit initial coordinates
     emit coordinatesChanged(m_centerGeo.x(), m_centerGeo.y(), m_zoom);
 }
 
-void MapWidget::setShapefilePolygon(const QVector<QPolygonF> &shapes) {
-    m_shapefilePolygons = shapes;
-    update();
-}
-
-void MapWidget::setPostgisPolygon(const QVector<QPolygonF> &shapes) {
-    m_postgisPolygons = shapes;
-    update();
+void MapWidget::loadVectorData(const QString &path) {
+    // One opened source at a time; replacing its layer cancels a load still running
+    if (!m_openedLayerName.isEmpty()) {
+        m_layerRegistry->removeLayer(m_openedLayerName);
+    }
+    m_openedLayerName = QFileInfo(path).fileName();
+    m_layerRegistry->addFileLayer(m_openedLayerName, path, OpenedLayerZOrder);
 }
 
 void MapWidget::paintEvent(QPaintEvent *) {
@@ -96,42 +111,72 @@ void MapWidget::paintEvent(QPaintEvent *) {
     // Draw tiles
     drawTiles(painter);
     
-    // Draw polygons using legacy method (for now)
-    auto drawGeoPolygon = [&](const QPolygonF &geoPoly, QColor color) {
-        QPolygonF pxPoly;
-        QPointF centerPixel = geoToPixel(m_centerGeo.x(), m_centerGeo.y(), m_zoom);
-        
-        for (const QPointF &pt : geoPoly) {
-            QPointF pixelPos = geoToPixel(pt.x(), pt.y(), m_zoom);
-            // Translate to widget coordinates relative to center
-            QPointF widgetPos = pixelPos - centerPixel + QPointF(width()/2, height()/2);
-            pxPoly << widgetPos;
+    // Render data layers in z-order, then the trail overlay and aircraft layer
+    if (m_aircraftLayer && m_viewTransform) {
+        updateViewTransform();
+        if (m_layerRegistry) {
+            m_layerRegistry->render(painter, *m_viewTransform);
         }
-        
-        painter.setPen(QPen(color, 3));
-        painter.setBrush(QBrush(color, Qt::SolidPattern));
-        painter.setOpacity(0.3);
-        painter.drawPolygon(pxPoly);
-        painter.setOpacity(1.0);
-        painter.setBrush(Qt::NoBrush);
-        painter.drawPolygon(pxPoly);
-    };
+        if (m_trailLayer) {
+            m_trailLayer->render(painter, *m_viewTransform);
+        }
+        m_aircraftLayer->render(painter, *m_viewTransform);
+    }
     
-    // Draw polygons according to project requirements:
-    // - BLUE polygons: Vietnam administrative boundaries from SimpleMaps shapefile (for reference)  
-    // - GREEN polygon: Main Hanoi area polygon from PostgreSQL database (for aircraft interaction)
-    // - Removed RED hardcoded polygon as per requirements
+    if (m_timeToFirstFrameMs < 0) {
+        m_timeToFirstFrameMs = m_startupTimer.elapsed();
+        qDebug() << "Time to first frame:" << m_timeToFirstFrameMs << "ms";
+        emit firstFrameRendered(m_timeToFirstFrameMs);
+    }
+}
+
+void MapWidget::startBackgroundInitialization()
+{
+    // Data layers need no start here: each reads its source on its first visible render
     
-    for (const auto &poly : m_shapefilePolygons) drawGeoPolygon(poly, Qt::blue);     // Vietnam provinces from shapefile
-    for (const auto &poly : m_postgisPolygons) drawGeoPolygon(poly, Qt::green);     // Hanoi area from database
+    // Database work waits for the connection, which may take up to connect_timeout
+    DatabaseService& dbService = DatabaseService::instance();
+    connect(&dbService, &DatabaseService::databaseConnected,
+            this, &MapWidget::onDatabaseConnected, Qt::UniqueConnection);
+    connect(&dbService, &DatabaseService::databaseError, this, [this](const QString& error) {
+        // Only a failed connection attempt counts; later operation errors do not
+        if (!m_databaseReady && !m_aircraftLoaded && !DatabaseService::instance().isConnected()) {
+            qWarning() << "Database unavailable, continuing without stored data:" << error;
+            onAircraftLoaded(0);
+        }
+    });
     
-    // Render aircraft layer using new architecture
-    if (m_aircraftLayer && m_viewTransform) {
-        updateViewTransform();
-        m_aircraftLayer->render(painter, *m_viewTransform);
+    if (dbService.isConnected()) {
+        onDatabaseConnected();
+    } else {
+        dbService.connectInBackground();
     }
 }
 
+void MapWidget::onDatabaseConnected()
+{
+    if (m_databaseReady) return;
+    m_databaseReady = true;
+    qDebug() << "Database connected after" << m_startupTimer.elapsed() << "ms";
+    
+    // Cells requested while disconnected were skipped
+    update();
+    
+    // The interaction polygon is read back after the Hanoi rows are ensured
+    runInBackground<QPolygonF>(this, "interaction polygon", m_startupTimer,
+        []() {
+            createHanoiPolygonInDatabase();
+            return loadInteractionPolygon();
+        },
+        [this](const QPolygonF& polygon) { applyInteractionPolygon(polygon); });
+    
+    runInBackground<QVector<DatabaseService::PolygonRegion>>(this, "geofence regions", m_startupTimer,
+        []() { return DatabaseService::instance().loadAllRegions(); },
+        [this](const QVector<DatabaseService::PolygonRegion>& regions) { applyGeofenceRegions(regions); });
+    
+    loadExistingAircraft();
+}
+
 void MapWidget::resizeEvent(QResizeEvent *event) {
     QWidget::resizeEvent(event);
     
@@ -382,187 +427,50 @@ void MapWidget::drawPolygons(QPainter &painter, const QVector<QPolygonF> &polygo
     }
 }
 
-void MapWidget::fetchShapefiles() {
-    // Initialize GDAL/OGR for reading vector data
-    GDALAllRegister();
-    
-    ConfigManager& config = ConfigManager::instance();
-    
-    // Try to load vector data files in priority order: GeoJSON first, then shapefiles
-    QStringList vectorDataPaths = {
-        "resources/shapefiles/vn.json",     // GeoJSON format (priority)
-        "resources/shapefiles/vn.shp",      // Shapefile format  
-        "vn.json",                          // Fallback to current directory
-        "vn.shp"                           // Fallback shapefile
-    };
-    
-    for (const QString& path : vectorDataPaths) {
-        QFileInfo fileInfo(path);
-        if (!fileInfo.exists()) {
-            qDebug() << "Vector data file not found:" << path;
-            continue;
-        }
-        
-        qDebug() << "Attempting to load vector data from:" << path;
-        
-        GDALDataset *poDS = (GDALDataset*) GDALOpenEx(path.toLocal8Bit().data(), GDAL_OF_VECTOR, NULL, NULL, NULL);
-        if (poDS) {
-            qDebug() << "Successfully opened vector data:" << path;
-            
-            OGRLayer *poLayer = poDS->GetLayer(0);
-            if (!poLayer) {
-                qDebug() << "No layer found in vector data:" << path;
-                GDALClose(poDS);
-                continue;
-            }
-            
-            OGRFeature *poFeature;
-            poLayer->ResetReading();
-            
-            int featureCount = 0;
-            int polygonCount = 0;
-            
-            // Process all features (no limit for GeoJSON, limited for performance with large shapefiles)
-            int maxFeatures = path.endsWith(".json") ? 1000 : 100; // More features for GeoJSON
-            
-            while ((poFeature = poLayer->GetNextFeature()) != nullptr && featureCount < maxFeatures) {
-                OGRGeometry *poGeometry = poFeature->GetGeometryRef();
-                if (poGeometry) {
-                    OGRwkbGeometryType geomType = wkbFlatten(poGeometry->getGeometryType());
-                    
-                    if (geomType == wkbPolygon) {
-                        // Handle single polygon
-                        OGRPolygon *poPolygon = (OGRPolygon *) poGeometry;
-                        OGRLinearRing *ring = poPolygon->getExteriorRing();
-                        if (ring && ring->getNumPoints() > 0) {
-                            QPolygonF qpoly;
-                            for (int i = 0; i < ring->getNumPoints(); ++i) {
-                                qpoly << QPointF(ring->getX(i), ring->getY(i));
-                            }
-                            m_shapefilePolygons.append(qpoly);
-                            polygonCount++;
-                        }
-                    } 
-                    else if (geomType == wkbMultiPolygon) {
-                        // Handle multipolygon (important for complex provinces)
-                        OGRMultiPolygon *poMultiPolygon = (OGRMultiPolygon *) poGeometry;
-                        for (int i = 0; i < poMultiPolygon->getNumGeometries(); ++i) {
-                            OGRGeometry *poSubGeom = poMultiPolygon->getGeometryRef(i);
-                            if (poSubGeom && wkbFlatten(poSubGeom->getGeometryType()) == wkbPolygon) {
-                                OGRPolygon *poPolygon = (OGRPolygon *) poSubGeom;
-                                OGRLinearRing *ring = poPolygon->getExteriorRing();
-                                if (ring && ring->getNumPoints() > 0) {
-                                    QPolygonF qpoly;
-                                    for (int j = 0; j < ring->getNumPoints(); ++j) {
-                                        qpoly << QPointF(ring->getX(j), ring->getY(j));
-                                    }
-                                    m_shapefilePolygons.append(qpoly);
-                                    polygonCount++;
-                                }
-                            }
-                        }
-                    }
-                    
-                    // Log feature properties for GeoJSON
-                    if (path.endsWith(".json") && featureCount < 10) {
-                        const char* name = poFeature->GetFieldAsString("name");
-                        if (name && strlen(name) > 0) {
-                            qDebug() << "  Feature" << featureCount << ": Province =" << name;
-                        }
-                    }
-                }
-                
-                OGRFeature::DestroyFeature(poFeature);
-                featureCount++;
-            }
-            
-            qDebug() << "Successfully loaded" << featureCount << "features with" << polygonCount << "polygons from" << path;
-            
-            if (path.endsWith(".json")) {
-                qDebug() << "Loaded Vietnam administrative boundaries from GeoJSON";
-            } else {
-                qDebug() << "Loaded boundaries from shapefile";
-            }
-            
-            GDALClose(poDS);
-            break; // Successfully loaded, don't try other paths
-        } else {
-            qDebug() << "Failed to open vector data:" << path << "- GDAL Error:" << CPLGetLastErrorMsg();
-        }
-    }
-    
-    if (m_shapefilePolygons.isEmpty()) {
-        qDebug() << "No vector data loaded successfully. Application will work without administrative boundaries.";
-        qDebug() << "To add Vietnam provinces, place vn.json in resources/shapefiles/ directory";
-    } else {
-        qDebug() << "Total polygons loaded:" << m_shapefilePolygons.size();
-        qDebug() << "Vietnam administrative boundaries ready for display";
-    }
-}
-
-void MapWidget::fetchPostgis() {
-    // Connect and query PostGIS using configuration settings
+QPolygonF MapWidget::loadInteractionPolygon() {
+    // Polygons for display are streamed per viewport by the PostGIS layers; here only the
+    // first stored polygon is read, as the Hanoi area used for aircraft interaction
     try {
-        ConfigManager& config = ConfigManager::instance();
+        PooledConnection c = DatabaseService::instance().acquireConnection();
+        pqxx::work txn(*c);
         
-        // Build connection string from configuration
-        QString connString = QString("host=%1 port=%2 dbname=%3 user=%4 password=%5 connect_timeout=%6")
-            .arg(config.getDatabaseHost())
-            .arg(config.getDatabasePort())
-            .arg(config.getDatabaseName())
-            .arg(config.getDatabaseUsername())
-            .arg(config.getDatabasePassword())
-            .arg(config.getDatabaseConnectionTimeout());
+        // Table and columns come from tables.polygons, fixed when the statement is prepared
+        pqxx::result r = PreparedStatements::exec(txn, PreparedStatements::PolygonLoadFirst);
         
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        // Get table configuration
-        QString tableName = config.getDatabasePolygonsTableName();
-        QString geomColumn = config.getDatabasePolygonsGeometryColumn();
-        int limit = config.getDatabasePolygonsLimit();
-        
-        QString query = QString("SELECT ST_AsText(%1) FROM %2 LIMIT %3")
-            .arg(geomColumn)
-            .arg(tableName)
-            .arg(limit);
-        
-        pqxx::result r = txn.exec(query.toStdString());
-        
-        for (auto row : r) {
-            std::string wkt = row[0].c_str();
-            OGRGeometry *geom = nullptr;
-            OGRGeometryFactory::createFromWkt(wkt.c_str(), nullptr, &geom);
-            if (geom && wkbFlatten(geom->getGeometryType()) == wkbPolygon) {
-                OGRPolygon *poPolygon = (OGRPolygon *) geom;
-                OGRLinearRing *ring = poPolygon->getExteriorRing();
-                QPolygonF qpoly;
-                for (int i = 0; i < ring->getNumPoints(); ++i) {
-                    qpoly << QPointF(ring->getX(i), ring->getY(i));
+        QVector<WkbReader::Polygon> parts;
+        if (!r.empty() && !r[0][0].is_null()) {
+            QByteArray wkbBuffer;
+            const pqxx::field field = r[0][0];
+            if (WkbReader::decodeByteaHex(field.c_str(), field.size(), wkbBuffer)) {
+                WkbReader reader(wkbBuffer.constData(), static_cast<std::size_t>(wkbBuffer.size()));
+                if (!reader.readPolygons(parts)) {
+                    parts.clear();
                 }
-                m_postgisPolygons.append(qpoly);
             }
-            if (geom) OGRGeometryFactory::destroyGeometry(geom);
         }
         
-        qDebug() << "Loaded" << m_postgisPolygons.size() << "polygons from PostGIS";
-        
-        // CRITICAL: Update the polygon region for aircraft interaction
-        // This ensures aircraft change color when entering the database-stored Hanoi area
-        if (!m_postgisPolygons.isEmpty() && m_hanoiPolygon) {
-            // Use the first polygon from database as the main Hanoi area for aircraft interaction
-            QPolygonF mainHanoiArea = m_postgisPolygons.first();
-            m_hanoiPolygon->setPolygon(mainHanoiArea);
-            
-            qDebug() << "Set Hanoi polygon for aircraft interaction from database";
-            qDebug() << "Polygon has" << mainHanoiArea.size() << "points";
-            qDebug() << "Aircraft will change color when entering this area";
+        if (!parts.isEmpty()) {
+            return parts.first().first();
         }
         
     } catch (const std::exception &e) {
         qDebug() << "PostGIS error:" << e.what();
         qDebug() << "Aircraft interaction will use fallback polygon";
     }
+    
+    return QPolygonF();
+}
+
+void MapWidget::applyInteractionPolygon(const QPolygonF& mainHanoiArea) {
+    // CRITICAL: Update the polygon region for aircraft interaction
+    // This ensures aircraft change color when entering the database-stored Hanoi area
+    if (!mainHanoiArea.isEmpty() && m_hanoiPolygon) {
+        m_hanoiPolygon->setPolygon(mainHanoiArea);
+        
+        qDebug() << "Set Hanoi polygon for aircraft interaction from database";
+        qDebug() << "Polygon has" << mainHanoiArea.size() << "points";
+        qDebug() << "Aircraft will change color when entering this area";
+    }
 }
 
 QPointF MapWidget::geoToPixel(double lon, double lat, int zoom, int tileSize) const {
@@ -942,20 +850,76 @@ void MapWidget::initializeArchitecture()
     // Initialize AircraftLayer
     m_aircraftLayer = std::make_unique<AircraftLayer>(this);
     
+    // Initialize TrailLayer (persistent overlay fed from the aircraft trail buffers)
+    m_trailLayer = std::make_unique<TrailLayer>(m_aircraftLayer.get(), this);
+    connect(m_trailLayer.get(), &MapLayer::layerChanged, this, [this]() { update(); });
+    
+    // Initialize data layers from data_sources.json; nothing is read until they are drawn
+    m_layerRegistry = std::make_unique<LayerRegistry>(this);
+    connect(m_layerRegistry.get(), &LayerRegistry::repaintNeeded, this, [this]() { update(); });
+    m_layerRegistry->loadFromConfig();
+    if (m_layerRegistry->layersOfType<VectorLayer>().isEmpty()
+        && m_layerRegistry->layersOfType<OgrCellLayer>().isEmpty()) {
+        // No configured file source; fall back to the bundled boundaries
+        const QString boundaryPath = VectorLoader::findDefaultSource();
+        if (boundaryPath.isEmpty()) {
+            qDebug() << "No vector data found. Application will work without administrative boundaries.";
+            qDebug() << "To add Vietnam provinces, place vn.json in resources/shapefiles/ directory";
+        } else {
+            m_layerRegistry->addFileLayer("Vietnam Boundary", boundaryPath, 0);
+        }
+    }
+    
     // Initialize polygon region (Hanoi area)
     m_hanoiPolygon = std::make_unique<PolygonObject>(this);
     
+    // Initialize GeofenceManager (all stored regions, loaded after the database is ready)
+    m_geofenceManager = std::make_unique<GeofenceManager>(this);
+    
+    // Initialize ReverseGeocoder (provinces from the boundary source, shown or not)
+    m_reverseGeocoder = std::make_unique<ReverseGeocoder>(this);
+    ConfigManager& config = ConfigManager::instance();
+    if (config.getReverseGeocodingEnabled()) {
+        QString provincePath = config.getReverseGeocodingSource();
+        if (!QFileInfo::exists(provincePath)) {
+            provincePath = VectorLoader::findDefaultSource();
+        }
+        if (!provincePath.isEmpty()) {
+            m_reverseGeocoder->loadSource(provincePath);
+        }
+    }
+    
     // Connect aircraft manager to layer
     connect(m_aircraftManager.get(), &AircraftManager::aircraftCreated,
             this, [this](Aircraft* aircraft) {
                 m_aircraftLayer->addAircraft(aircraft);
+                m_reverseGeocoder->updateAircraft(aircraft);
+            });
+    
+    connect(m_aircraftManager.get(), &AircraftManager::aircraftBatchAdded,
+            m_aircraftLayer.get(), &AircraftLayer::addAircraftBatch);
+    
+    connect(m_aircraftManager.get(), &AircraftManager::aircraftBatchAdded,
+            this, [this](const QVector<Aircraft*>& aircraft) {
+                for (Aircraft* item : aircraft) {
+                    m_reverseGeocoder->updateAircraft(item);
+                }
             });
     
     connect(m_aircraftManager.get(), &AircraftManager::aircraftRemoved,
             this, [this](Aircraft* aircraft) {
                 m_aircraftLayer->removeAircraft(aircraft);
+                m_trailLayer->removeAircraft(aircraft);
+                m_reverseGeocoder->removeAircraft(aircraft);
             });
     
+    // One batched notification per movement tick instead of a signal per aircraft
+    connect(m_aircraftManager.get(), &AircraftManager::tickCompleted,
+            m_aircraftLayer.get(), &AircraftLayer::onTickCompleted);
+    
+    connect(m_aircraftManager.get(), &AircraftManager::tickCompleted,
+            m_reverseGeocoder.get(), &ReverseGeocoder::onTickCompleted);
+    
     // Connect aircraft layer signals to mapwidget signals
     connect(m_aircraftLayer.get(), &AircraftLayer::aircraftSelected,
             this, &MapWidget::aircraftSelected);
@@ -973,11 +937,16 @@ void MapWidget::initializeArchitecture()
     // Set up polygon region for both manager and layer
     m_aircraftManager->setPolygonRegion(m_hanoiPolygon.get());
     m_aircraftLayer->setPolygonRegion(m_hanoiPolygon.get());
+    m_aircraftLayer->setGeofenceManager(m_geofenceManager.get());
     
     // Connect view transform change signals
     connect(m_viewTransform.get(), &ViewTransform::transformChanged,
             this, [this]() { update(); });
     
+    // Changes made by other clients arrive from the listener thread (queued)
+    connect(&ChangeListener::instance(), &ChangeListener::changesReceived,
+            this, &MapWidget::onDatabaseChanges);
+    
     qDebug() << "Architecture components initialized successfully";
 }
 
@@ -1145,51 +1114,24 @@ void MapWidget::ensureCacheSize()
 void MapWidget::createHanoiPolygonInDatabase()
 {
     try {
-        ConfigManager& config = ConfigManager::instance();
-        
-        QString connString = QString("host=%1 port=%2 dbname=%3 user=%4 password=%5 connect_timeout=%6")
-            .arg(config.getDatabaseHost())
-            .arg(config.getDatabasePort())
-            .arg(config.getDatabaseName())
-            .arg(config.getDatabaseUsername())
-            .arg(config.getDatabasePassword())
-            .arg(config.getDatabaseConnectionTimeout());
-        
-        pqxx::connection c(connString.toStdString());
-        pqxx::work txn(c);
-        
-        // Get table configuration
-        QString tableName = config.getDatabasePolygonsTableName();
-        QString geomColumn = config.getDatabasePolygonsGeometryColumn();
+        PooledConnection c = DatabaseService::instance().acquireConnection();
+        pqxx::work txn(*c);
         
         // Check if the polygon already exists
-        QString checkQuery = QString("SELECT COUNT(*) FROM %1 WHERE name = 'Hanoi Area'")
-            .arg(tableName);
-        
-        pqxx::result checkResult = txn.exec(checkQuery.toStdString());
+        pqxx::result checkResult = PreparedStatements::exec(txn, PreparedStatements::PolygonCountByName,
+                                                            std::string("Hanoi Area"));
         int count = checkResult[0][0].as<int>();
         
         if (count == 0) {
             // Create a larger polygon area around Hanoi for aircraft interaction
             // This represents a detection zone, not just Hoan Kiem Lake
-            QString wktPolygon = "POLYGON((105.7 20.8, 105.7 21.3, 106.1 21.3, 106.1 20.8, 105.7 20.8))";
-            
-            QString insertQuery = QString("INSERT INTO %1 (name, %2) VALUES ('Hanoi Area', ST_GeomFromText('%3', 4326))")
-                .arg(tableName)
-                .arg(geomColumn)
-                .arg(wktPolygon);
-            
-            txn.exec(insertQuery.toStdString());
+            PreparedStatements::exec(txn, PreparedStatements::PolygonInsert, std::string("Hanoi Area"),
+                std::string("POLYGON((105.7 20.8, 105.7 21.3, 106.1 21.3, 106.1 20.8, 105.7 20.8))"));
             
             // OPTIONAL: Add a smaller demo polygon for testing if you want to see the difference
             // This creates a visible contrast between having/not having shapefile data
-            QString demoPolygon = "POLYGON((105.85 21.00, 105.85 21.05, 105.90 21.05, 105.90 21.00, 105.85 21.00))";
-            QString demoQuery = QString("INSERT INTO %1 (name, %2) VALUES ('Demo Small Area', ST_GeomFromText('%3', 4326))")
-                .arg(tableName)
-                .arg(geomColumn)
-                .arg(demoPolygon);
-            
-            txn.exec(demoQuery.toStdString());
+            PreparedStatements::exec(txn, PreparedStatements::PolygonInsert, std::string("Demo Small Area"),
+                std::string("POLYGON((105.85 21.00, 105.85 21.05, 105.90 21.05, 105.90 21.00, 105.85 21.00))"));
             
             txn.commit();
             
@@ -1215,41 +1157,230 @@ void MapWidget::loadExistingAircraft()
     
     qDebug() << "Loading existing aircraft from database";
     
-    // Load aircraft from database using DatabaseService
-    DatabaseService& dbService = DatabaseService::instance();
-    QVector<Aircraft*> existingAircraft = dbService.loadAllAircraft(this);
-    
-    qDebug() << "Found" << existingAircraft.size() << "aircraft in database";
-    
-    // Add existing aircraft to the manager and layer
-    for (Aircraft* aircraft : existingAircraft) {
-        if (aircraft) {
-            // Add to aircraft manager (this will trigger signals to add to layer)
-            m_aircraftManager->addExistingAircraft(aircraft);
-            
-            // Restart movement if aircraft was moving when last saved
-            if (aircraft->isMoving()) {
-                aircraft->startMovement();
-                qDebug() << "Restarted movement for aircraft:" << aircraft->getCallSign();
+    // Stream every stored aircraft in one query on a pool thread; each batch is
+    // moved to the GUI thread and added to the manager as it arrives. Aircraft
+    // saved while moving keep their is_moving flag and resume. When the first
+    // connection failed and the sample fleet was created meanwhile, stored rows
+    // are merged by aircraft id instead, so the samples are not duplicated
+    QPointer<MapWidget> guard(this);
+    QThread* guiThread = thread();
+    const int batchSize = ConfigManager::instance().getAircraftLoadBatchSize();
+    
+    QThreadPool::globalInstance()->start([guard, guiThread, batchSize]() {
+        int loaded = Aircraft::streamAllFromDatabase(nullptr, batchSize,
+            [guard, guiThread](const QVector<Aircraft*>& batch) {
+                for (Aircraft* aircraft : batch) {
+                    aircraft->moveToThread(guiThread);
+                }
+                QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, batch]() {
+                    if (guard && guard->m_aircraftManager && guard->m_aircraftLoaded) {
+                        // The fleet came up without the database (samples); merge by id
+                        guard->applyRemoteAircraft(batch);
+                    } else if (guard && guard->m_aircraftManager) {
+                        guard->m_aircraftManager->addExistingAircraftBatch(batch);
+                    } else {
+                        qDeleteAll(batch);
+                    }
+                }, Qt::QueuedConnection);
+            });
+        
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, loaded]() {
+            if (guard) {
+                guard->onAircraftLoaded(loaded);
             }
-            
-            qDebug() << "Loaded aircraft:" << aircraft->getCallSign() 
-                     << "at position:" << aircraft->position()
-                     << "moving:" << aircraft->isMoving();
-        }
-    }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MapWidget::onAircraftLoaded(int loaded)
+{
+    if (m_aircraftLoaded) return;
+    m_aircraftLoaded = true;
     
     // If no aircraft found in database, create sample aircraft for demo
-    if (existingAircraft.isEmpty()) {
+    if (loaded == 0) {
         qDebug() << "No aircraft found in database, creating sample aircraft";
         createSampleAircraft();
     } else {
-        qDebug() << "Successfully loaded" << existingAircraft.size() << "aircraft from database";
+        qDebug() << "Successfully loaded" << loaded << "aircraft from database after"
+                 << m_startupTimer.elapsed() << "ms";
+    }
+}
+
+void MapWidget::applyLocalRegion(const DatabaseService::PolygonRegion& region)
+{
+    if (!m_geofenceManager) {
+        return;
+    }
+    
+    // Stored as regionToWkb() writes it: the edited outline replaces the first exterior ring
+    DatabaseService::PolygonRegion stored = region;
+    if (!stored.parts.isEmpty() && !stored.parts.first().isEmpty()) {
+        stored.parts.first().first() = stored.polygon;
+    }
+    m_regions.insert(stored.id, stored);
+    m_geofenceManager->setRegions(m_regions.values().toVector());
+    update();
+}
+
+void MapWidget::removeLocalRegion(const QString& regionId)
+{
+    if (!m_geofenceManager || m_regions.remove(regionId) == 0) {
+        return;
+    }
+    m_geofenceManager->setRegions(m_regions.values().toVector());
+    update();
+}
+
+void MapWidget::applyGeofenceRegions(const QVector<DatabaseService::PolygonRegion>& regions)
+{
+    if (!m_geofenceManager) {
+        return;
+    }
+    
+    m_regions.clear();
+    for (const DatabaseService::PolygonRegion& region : regions) {
+        m_regions.insert(region.id, region);
+    }
+    m_geofenceManager->setRegions(m_regions.values().toVector());
+}
+
+void MapWidget::onDatabaseChanges(const DatabaseChanges& changes)
+{
+    // Reads run on the pool, as at startup; a slow database must not stall the map
+    
+    // Notifications were lost while the listener reconnected; reload instead of patching
+    if (changes.resync) {
+        qDebug() << "Resynchronizing with database after missed change notifications";
+        if (m_geofenceManager) {
+            runInBackground<QVector<DatabaseService::PolygonRegion>>(this, "region resync", m_startupTimer,
+                []() { return DatabaseService::instance().loadAllRegions(); },
+                [this](const QVector<DatabaseService::PolygonRegion>& regions) { applyGeofenceRegions(regions); });
+        }
+        if (m_aircraftManager) {
+            QThread* guiThread = thread();
+            runInBackground<QVector<Aircraft*>>(this, "aircraft resync", m_startupTimer,
+                [guiThread]() {
+                    QVector<Aircraft*> loaded;
+                    Aircraft::streamAllFromDatabase(nullptr, ConfigManager::instance().getAircraftLoadBatchSize(),
+                                                    [&loaded](const QVector<Aircraft*>& batch) { loaded += batch; });
+                    for (Aircraft* aircraft : loaded) {
+                        aircraft->moveToThread(guiThread);
+                    }
+                    return loaded;
+                },
+                [this](const QVector<Aircraft*>& loaded) { applyRemoteAircraft(loaded); });
+        }
+        return;
+    }
+    
+    // Regions: only the touched rows are read back, in one query, then the geofence index is rebuilt
+    if (m_geofenceManager && (!changes.regionsChanged.isEmpty() || !changes.regionsRemoved.isEmpty())) {
+        for (const QString& regionId : changes.regionsRemoved) {
+            m_regions.remove(regionId);
+        }
+        if (changes.regionsChanged.isEmpty()) {
+            m_geofenceManager->setRegions(m_regions.values().toVector());
+        } else {
+            const QStringList regionIds = changes.regionsChanged.values();
+            runInBackground<QPair<bool, QVector<DatabaseService::PolygonRegion>>>(this, "region changes", m_startupTimer,
+                [regionIds]() {
+                    bool ok = false;
+                    QVector<DatabaseService::PolygonRegion> regions = DatabaseService::instance().loadRegions(regionIds, &ok);
+                    return qMakePair(ok, regions);
+                },
+                [this, regionIds](const QPair<bool, QVector<DatabaseService::PolygonRegion>>& result) {
+                    applyRegionChanges(regionIds, result.first, result.second);
+                });
+        }
+        qDebug() << "Remote region changes:" << changes.regionsChanged.size() << "changed,"
+                 << changes.regionsRemoved.size() << "removed";
+    }
+    
+    if (m_aircraftManager) {
+        if (!changes.aircraftRemoved.isEmpty()) {
+            const QVector<Aircraft*> current = m_aircraftManager->allAircraft();
+            for (Aircraft* aircraft : current) {
+                if (changes.aircraftRemoved.contains(aircraft->getAircraftId())) {
+                    // A queued local update would otherwise recreate the row
+                    PersistenceWorker::instance().discard(aircraft->getAircraftId());
+                    m_aircraftManager->removeAircraft(aircraft);
+                }
+            }
+        }
+        if (!changes.aircraftChanged.isEmpty()) {
+            const QStringList aircraftIds = changes.aircraftChanged.values();
+            QThread* guiThread = thread();
+            runInBackground<QVector<Aircraft*>>(this, "aircraft changes", m_startupTimer,
+                [aircraftIds, guiThread]() {
+                    QVector<Aircraft*> loaded = Aircraft::loadByIdsFromDatabase(aircraftIds, nullptr);
+                    for (Aircraft* aircraft : loaded) {
+                        aircraft->moveToThread(guiThread);
+                    }
+                    return loaded;
+                },
+                [this](const QVector<Aircraft*>& loaded) { applyRemoteAircraft(loaded); });
+        }
     }
+    
+    if (!changes.routesChanged.isEmpty() || !changes.routesRemoved.isEmpty()) {
+        emit flightRoutesChanged(changes.routesChanged, changes.routesRemoved);
+    }
+    
+    update();
 }
 
-void MapWidget::refreshPolygons()
+void MapWidget::applyRegionChanges(const QStringList& regionIds, bool ok,
+                                   const QVector<DatabaseService::PolygonRegion>& loaded)
 {
-    fetchPostgis();
+    if (!m_geofenceManager) {
+        return;
+    }
+    if (!ok) {
+        qWarning() << "Could not read" << regionIds.size() << "changed regions; keeping the previous geometry";
+        return;
+    }
+    
+    QHash<QString, DatabaseService::PolygonRegion> found;
+    for (const DatabaseService::PolygonRegion& region : loaded) {
+        found.insert(region.id, region);
+    }
+    
+    for (const QString& regionId : regionIds) {
+        auto region = found.constFind(regionId);
+        if (region == found.cend()) {
+            m_regions.remove(regionId); // Deleted again before we read it
+            continue;
+        }
+        // Reads of overlapping batches may finish out of order; never go back in time
+        auto existing = m_regions.constFind(regionId);
+        if (existing == m_regions.cend() || !(region->updatedAt < existing->updatedAt)) {
+            m_regions.insert(regionId, *region);
+        }
+    }
+    m_geofenceManager->setRegions(m_regions.values().toVector());
     update();
 }
+
+void MapWidget::applyRemoteAircraft(const QVector<Aircraft*>& loaded)
+{
+    QHash<QString, Aircraft*> current;
+    for (Aircraft* aircraft : m_aircraftManager->allAircraft()) {
+        current.insert(aircraft->getAircraftId(), aircraft);
+    }
+    
+    QVector<Aircraft*> added;
+    for (Aircraft* remote : loaded) {
+        Aircraft* existing = current.value(remote->getAircraftId());
+        if (existing) {
+            existing->applyRemoteState(*remote);
+            delete remote;
+        } else {
+            added.append(remote);
+        }
+    }
+    
+    if (!added.isEmpty()) {
+        m_aircraftManager->addExistingAircraftBatch(added);
+    }
+}
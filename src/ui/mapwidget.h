@@ -12,12 +12,20 @@
 #include <QDateTime>
 #include <QNetworkAccessManager>
 #include <QMap>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QSet>
 #include <memory>
 
 // Include necessary headers for the architecture components
 #include "../core/viewtransform.h"
 #include "../layers/aircraftlayer.h"
+#include "../layers/traillayer.h"
+#include "../layers/layerregistry.h"
 #include "../managers/aircraftmanager.h"
+#include "../managers/geofencemanager.h"
+#include "../managers/reversegeocoder.h"
+#include "../services/changelistener.h"
 #include "../models/polygonobject.h"
 #include "aircraft.h"
 
@@ -26,12 +34,14 @@ class MapWidget : public QWidget {
     
 public:
     explicit MapWidget(QWidget *parent = nullptr);
-    void setShapefilePolygon(const QVector<QPolygonF> &shapes);
-    void setPostgisPolygon(const QVector<QPolygonF> &shapes);
     
     // New architecture methods
     AircraftLayer* aircraftLayer() const { return m_aircraftLayer.get(); }
+    TrailLayer* trailLayer() const { return m_trailLayer.get(); }
+    LayerRegistry* layerRegistry() const { return m_layerRegistry.get(); }
     AircraftManager* aircraftManager() const { return m_aircraftManager.get(); }
+    GeofenceManager* geofenceManager() const { return m_geofenceManager.get(); }
+    ReverseGeocoder* reverseGeocoder() const { return m_reverseGeocoder.get(); }
     ViewTransform* viewTransform() const { return m_viewTransform.get(); }
     
     // Public methods for UI control
@@ -41,13 +51,24 @@ public:
     qint64 getTileCacheSize() const; // Get cache size in MB
     void prefetchTiles(int radius = 1); // Prefetch surrounding tiles
     
-    // Polygon refresh
-    void refreshPolygons();
+    // Regions edited in this process; own writes raise no change notification
+    void applyLocalRegion(const DatabaseService::PolygonRegion& region);
+    void removeLocalRegion(const QString& regionId);
+    
+    // Show another vector file above the configured layers, replacing the one opened before.
+    // GeoPackage and FlatGeobuf files are browsed per viewport cell instead of loaded whole.
+    void loadVectorData(const QString& path);
+    
+    // Milliseconds from construction to the first painted frame, -1 before it
+    qint64 timeToFirstFrameMs() const { return m_timeToFirstFrameMs; }
 
 signals:
     void coordinatesChanged(double lon, double lat, int zoom);
+    void firstFrameRendered(qint64 elapsedMs);
     void aircraftSelected(Aircraft* aircraft);
     void aircraftClicked(Aircraft* aircraft, const QPointF& position);
+    // Routes written by another client; nothing on the map caches routes yet
+    void flightRoutesChanged(const QSet<QString>& changedIds, const QSet<QString>& removedIds);
 
 protected:
     void paintEvent(QPaintEvent *event) override;
@@ -60,6 +81,8 @@ protected:
 private slots:
     void onAircraftSelected(Aircraft* aircraft);
     void onAircraftClicked(Aircraft* aircraft, const QPointF& position);
+    void onDatabaseChanges(const DatabaseChanges& changes);  // Deltas from other clients
+    void onDatabaseConnected();  // Starts the database-backed startup tasks
 
 private:
     void loadTileMap();
@@ -67,9 +90,17 @@ private:
     void drawTiles(QPainter &painter);
     void drawPolygon(QPainter &painter, const QPolygonF &polygon, QColor color = Qt::red);
     void drawPolygons(QPainter &painter, const QVector<QPolygonF> &polygons, QColor color = Qt::blue);
-    void fetchShapefiles();
-    void fetchPostgis();
-    void createHanoiPolygonInDatabase();  // Create Hanoi area polygon in PostgreSQL database
+    // Startup: the window shows first, data arrives from pool threads
+    void startBackgroundInitialization();
+    void onAircraftLoaded(int loaded);
+    
+    static QPolygonF loadInteractionPolygon();  // Any thread
+    void applyInteractionPolygon(const QPolygonF& polygon);
+    static void createHanoiPolygonInDatabase();  // Create Hanoi area polygon in PostgreSQL database
+    void applyGeofenceRegions(const QVector<DatabaseService::PolygonRegion>& regions);
+    void applyRemoteAircraft(const QVector<Aircraft*>& loaded);  // Merge rows into the manager
+    void applyRegionChanges(const QStringList& regionIds, bool ok,
+                            const QVector<DatabaseService::PolygonRegion>& loaded);
     QPixmap createFallbackTile(int tileX, int tileY) const;
     
     // New architecture methods
@@ -106,15 +137,20 @@ private:
     QVector<QPixmap> m_tiles;
     QVector<QPoint> m_tilePositions;
     QPolygonF m_polygon;
-    QVector<QPolygonF> m_shapefilePolygons;
-    QVector<QPolygonF> m_postgisPolygons;
     int m_centerTileX, m_centerTileY;
     
     // New architecture components
     std::unique_ptr<ViewTransform> m_viewTransform;
+    std::unique_ptr<GeofenceManager> m_geofenceManager;  // Declared before the layer that uses it
+    std::unique_ptr<ReverseGeocoder> m_reverseGeocoder;
     std::unique_ptr<AircraftLayer> m_aircraftLayer;
+    std::unique_ptr<TrailLayer> m_trailLayer;
+    std::unique_ptr<LayerRegistry> m_layerRegistry;  // Configured data layers, drawn in z-order
     std::unique_ptr<AircraftManager> m_aircraftManager;
     std::unique_ptr<PolygonObject> m_hanoiPolygon;
+    QString m_openedLayerName;  // Layer added by loadVectorData()
+    static constexpr int OpenedLayerZOrder = 1000;
+    QHash<QString, DatabaseService::PolygonRegion> m_regions;  // Geofence regions by id, kept in sync by notifications
     
     // Asynchronous loading components
     QNetworkAccessManager* m_networkManager;
@@ -123,6 +159,12 @@ private:
     // Update timer for smooth animation
     QTimer* m_updateTimer;
     
+    // Startup state
+    QElapsedTimer m_startupTimer;
+    qint64 m_timeToFirstFrameMs = -1;
+    bool m_databaseReady = false;
+    bool m_aircraftLoaded = false;
+    
     // Drag functionality
     bool m_dragging;
     QPointF m_lastPanPoint;
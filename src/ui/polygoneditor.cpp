@@ -9,6 +9,28 @@
 #include <QDoubleSpinBox>
 #include <QDebug>
 #include <QUuid>
+#include <QThreadPool>
+#include <QPointer>
+#include <QCoreApplication>
+#include <functional>
+
+namespace {
+
+// Runs work on the global thread pool and hands its result to apply on the GUI
+// thread; apply is skipped when the editor is gone by then
+template<typename Result>
+void runInBackground(QObject* owner, std::function<Result()> work, std::function<void(const Result&)> apply)
+{
+    QPointer<QObject> guard(owner);
+    QThreadPool::globalInstance()->start([guard, work, apply]() {
+        Result result = work();
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, apply, result]() {
+            if (guard) apply(result);
+        }, Qt::QueuedConnection);
+    });
+}
+
+} // namespace
 
 PolygonEditor::PolygonEditor(QWidget *parent)
     : QDialog(parent)
@@ -151,17 +173,51 @@ void PolygonEditor::setupConnections()
             this, &QDialog::accept);
 }
 
-void PolygonEditor::loadRegions()
+void PolygonEditor::done(int result)
 {
-    DatabaseService& dbService = DatabaseService::instance();
-    m_regions = dbService.loadAllRegions();
-    
-    m_regionsListWidget->clear();
-    for (const auto& region : m_regions) {
-        m_regionsListWidget->addItem(region.name);
-    }
-    
-    qDebug() << "Loaded" << m_regions.size() << "regions from database";
+    // The map only learns about the change from the completion signals
+    if (m_writing) return;
+    QDialog::done(result);
+}
+
+void PolygonEditor::setBusy(bool busy, bool writing)
+{
+    m_busy = busy;
+    m_writing = busy && writing;
+    
+    bool hasRegion = m_currentRegionIndex >= 0 && m_currentRegionIndex < m_regions.size();
+    m_regionsListWidget->setEnabled(!busy);
+    m_addRegionButton->setEnabled(!busy);
+    m_loadButton->setEnabled(!busy);
+    m_closeButton->setEnabled(!m_writing);
+    m_deleteRegionButton->setEnabled(!busy && hasRegion);
+    m_saveRegionButton->setEnabled(!busy && hasRegion);
+}
+
+void PolygonEditor::loadRegions(bool announce)
+{
+    setBusy(true);
+    
+    using Regions = QVector<DatabaseService::PolygonRegion>;
+    runInBackground<Regions>(this,
+        []() { return DatabaseService::instance().loadAllRegions(); },
+        [this, announce](const Regions& regions) {
+            m_regions = regions;
+            m_currentRegionIndex = -1;
+            
+            m_regionsListWidget->clear();
+            for (const auto& region : m_regions) {
+                m_regionsListWidget->addItem(region.name);
+            }
+            setBusy(false);
+            
+            qDebug() << "Loaded" << m_regions.size() << "regions from database";
+            
+            if (announce) {
+                QMessageBox::information(this, "Reload Complete", 
+                                       "Regions reloaded from database.");
+            }
+        });
 }
 
 void PolygonEditor::onRegionSelectionChanged()
@@ -284,17 +340,33 @@ void PolygonEditor::onDeleteRegion()
     );
     
     if (reply == QMessageBox::Yes) {
-        // Delete from database
-        DatabaseService& dbService = DatabaseService::instance();
-        dbService.deleteRegion(region.id);
-        
-        // Remove from local list
-        m_regions.removeAt(m_currentRegionIndex);
-        delete m_regionsListWidget->takeItem(m_currentRegionIndex);
+        const QString regionId = region.id;
+        const QString regionName = region.name;
         
-        qDebug() << "Deleted region:" << region.name;
-        
-        emit polygonUpdated();
+        setBusy(true, true);
+        runInBackground<bool>(this,
+            [regionId]() { return DatabaseService::instance().deleteRegion(regionId); },
+            [this, regionId, regionName](const bool& success) {
+                setBusy(false);
+                if (!success) {
+                    QMessageBox::warning(this, "Delete Failed", 
+                                       "Failed to delete region from database.");
+                    return;
+                }
+                
+                // Remove from local list; the list was locked, but look the region up by id anyway
+                for (int i = 0; i < m_regions.size(); ++i) {
+                    if (m_regions[i].id == regionId) {
+                        m_regions.removeAt(i);
+                        delete m_regionsListWidget->takeItem(i);
+                        break;
+                    }
+                }
+                
+                qDebug() << "Deleted region:" << regionName;
+                
+                emit regionDeleted(regionId);
+            });
     }
 }
 
@@ -320,23 +392,28 @@ void PolygonEditor::onSaveRegion()
     }
     
     // Save to database
-    DatabaseService& dbService = DatabaseService::instance();
-    bool success = dbService.saveRegion(region);
-    
-    if (success) {
-        // Update list widget
-        m_regionsListWidget->item(m_currentRegionIndex)->setText(region.name);
-        
-        QMessageBox::information(this, "Save Successful", 
-                                QString("Region '%1' saved successfully.").arg(region.name));
-        
-        emit polygonUpdated();
-        
-        qDebug() << "Saved region:" << region.name;
-    } else {
-        QMessageBox::warning(this, "Save Failed", 
-                           "Failed to save region to database.");
-    }
+    const DatabaseService::PolygonRegion saved = region;
+    const int index = m_currentRegionIndex;
+    setBusy(true, true);
+    runInBackground<bool>(this,
+        [saved]() { return DatabaseService::instance().saveRegion(saved); },
+        [this, saved, index](const bool& success) {
+            setBusy(false);
+            if (success) {
+                // Update list widget; it stayed locked, so the row is still this region
+                m_regionsListWidget->item(index)->setText(saved.name);
+                
+                QMessageBox::information(this, "Save Successful", 
+                                        QString("Region '%1' saved successfully.").arg(saved.name));
+                
+                emit regionSaved(saved);
+                
+                qDebug() << "Saved region:" << saved.name;
+            } else {
+                QMessageBox::warning(this, "Save Failed", 
+                                   "Failed to save region to database.");
+            }
+        });
 }
 
 void PolygonEditor::onAddPoint()
@@ -372,10 +449,7 @@ void PolygonEditor::onPointChanged(int row, int column)
 
 void PolygonEditor::onLoadFromDatabase()
 {
-    loadRegions();
     clearRegionData();
     m_currentRegionIndex = -1;
-    
-    QMessageBox::information(this, "Reload Complete", 
-                           "Regions reloaded from database.");
+    loadRegions(true);
 } 
\ No newline at end of file
@@ -24,8 +24,13 @@ class PolygonEditor : public QDialog
 public:
     explicit PolygonEditor(QWidget *parent = nullptr);
     
+    // Held open until a save or delete in flight has been answered
+    void done(int result) override;
+    
 signals:
-    void polygonUpdated(); // Signal when polygon is modified
+    // Emitted after the database accepted the change, with the region as stored
+    void regionSaved(const DatabaseService::PolygonRegion& region);
+    void regionDeleted(const QString& regionId);
 
 private slots:
     void onRegionSelectionChanged();
@@ -40,7 +45,9 @@ private slots:
 private:
     void setupUI();
     void setupConnections();
-    void loadRegions();
+    // Database work runs on the thread pool; the editor is locked until it answers
+    void loadRegions(bool announce = false);
+    void setBusy(bool busy, bool writing = false);
     void loadRegionData(const DatabaseService::PolygonRegion& region);
     void clearRegionData();
     void updatePointsTable(const QPolygonF& polygon);
@@ -63,4 +70,6 @@ private:
     // Data
     QVector<DatabaseService::PolygonRegion> m_regions;
     int m_currentRegionIndex = -1;
+    bool m_busy = false;
+    bool m_writing = false;
 }; 
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "cellgrid.h"
+#include <QtTest>
+
+class TestCellGrid : public QObject {
+    Q_OBJECT
+
+private slots:
+    void cellAddressing();
+    void boundsCoverCells();
+    void requestsEachCellOnce();
+    void sharesItemsBetweenCells();
+    void evictsLeastRecentlyUsed();
+    void dropsResultsFromBeforeClear();
+    void failedCellWaitsForRetry();
+
+private:
+    struct Item {
+        int value = 0;
+        int cellRefs = 0;
+    };
+    using Cache = CellCache<Item>;
+
+    // Every key startFetch was called with, in call order
+    static QVector<quint64> request(Cache& cache, const QRectF& visible, int z, int group = 0);
+    static Cache::Fetched items(std::initializer_list<qint64> ids);
+};
+
+QVector<quint64> TestCellGrid::request(Cache& cache, const QRectF& visible, int z, int group)
+{
+    QVector<quint64> started;
+    cache.requestVisible(visible, z, group, [&started](quint64 key, int, const QRectF&) {
+        started.append(key);
+    });
+    return started;
+}
+
+TestCellGrid::Cache::Fetched TestCellGrid::items(std::initializer_list<qint64> ids)
+{
+    Cache::Fetched fetched;
+    for (qint64 id : ids) {
+        fetched.append(qMakePair(id, Item{ int(id), 0 }));
+    }
+    return fetched;
+}
+
+void TestCellGrid::cellAddressing()
+{
+    QCOMPARE(CellGrid::lonToCellX(-180.0, 0), 0);
+    QCOMPARE(CellGrid::lonToCellX(180.0, 1), 1);
+    QCOMPARE(CellGrid::lonToCellX(105.85, 10), 813);
+    QCOMPARE(CellGrid::latToCellY(21.03, 10), 450);
+
+    // Clamped at the Mercator limits instead of running off the grid
+    QCOMPARE(CellGrid::latToCellY(90.0, 4), 0);
+    QCOMPARE(CellGrid::latToCellY(-90.0, 4), 15);
+
+    QVERIFY(CellGrid::cellKey(10, 813, 450) != CellGrid::cellKey(10, 450, 813));
+    QVERIFY(CellGrid::cellKey(10, 813, 450) != CellGrid::cellKey(11, 813, 450));
+}
+
+void TestCellGrid::boundsCoverCells()
+{
+    const QRectF bounds = CellGrid::cellBounds(10, 813, 450);
+    QVERIFY(bounds.contains(QPointF(105.85, 21.03)));
+    QCOMPARE(CellGrid::lonToCellX(bounds.center().x(), 10), 813);
+    QCOMPARE(CellGrid::latToCellY(bounds.center().y(), 10), 450);
+
+    // Neighbouring cells share their edge
+    QCOMPARE(CellGrid::cellBounds(10, 814, 450).left(), bounds.right());
+    QCOMPARE(CellGrid::toleranceForZoom(0, 256.0), 360.0);
+}
+
+void TestCellGrid::requestsEachCellOnce()
+{
+    Cache cache(16);
+    const QRectF visible(105.80, 21.00, 0.1, 0.05);
+
+    const QVector<quint64> started = request(cache, visible, 10);
+    QVERIFY(!started.isEmpty());
+    QCOMPARE(cache.cellCount(), started.size());
+
+    // Still loading: nothing is started again and the view is not complete
+    QVERIFY(request(cache, visible, 10).isEmpty());
+    QVERIFY(!cache.requestVisible(visible, 10, 0, [](quint64, int, const QRectF&) {}));
+
+    for (quint64 key : started) {
+        cache.apply(key, cache.generation(), true, Cache::Fetched());
+    }
+    QVERIFY(cache.requestVisible(visible, 10, 0, [](quint64, int, const QRectF&) {}));
+}
+
+void TestCellGrid::sharesItemsBetweenCells()
+{
+    Cache cache(16);
+    const QVector<quint64> started = request(cache, QRectF(105.80, 21.00, 0.5, 0.01), 10);
+    QVERIFY(started.size() >= 2);
+
+    const quint64 revision = cache.revision();
+    QVERIFY(cache.apply(started[0], cache.generation(), true, items({ 1, 2 })));
+    QVERIFY(cache.apply(started[1], cache.generation(), true, items({ 2, 3 })));
+    QVERIFY(cache.revision() > revision);
+
+    // Item 2 crossed the cell border and is stored once, held by both cells
+    const Cache::Items& stored = cache.items(0);
+    QCOMPARE(stored.size(), 3);
+    QCOMPARE(stored.value(2).cellRefs, 2);
+    QCOMPARE(stored.value(3).value, 3);
+    QVERIFY(cache.items(1).isEmpty());
+
+    // A late duplicate result for a loaded cell is ignored
+    QVERIFY(!cache.apply(started[0], cache.generation(), true, items({ 4 })));
+    QCOMPARE(cache.itemCount(), 3);
+}
+
+void TestCellGrid::evictsLeastRecentlyUsed()
+{
+    Cache cache(1);
+    const QRectF west(105.80, 21.00, 0.01, 0.01);
+    const QRectF east(106.50, 21.00, 0.01, 0.01);
+
+    const QVector<quint64> first = request(cache, west, 10);
+    QCOMPARE(first.size(), 1);
+    cache.apply(first[0], cache.generation(), true, items({ 1, 2 }));
+
+    // The west cell is older than the east one and goes, taking its items with it
+    const quint64 revision = cache.revision();
+    const QVector<quint64> second = request(cache, east, 10);
+    QCOMPARE(second.size(), 1);
+    QCOMPARE(cache.cellCount(), 1);
+    QCOMPARE(cache.itemCount(), 0);
+    QVERIFY(cache.revision() > revision);
+
+    // Its result arriving now is dropped; the east cell still takes its own
+    QVERIFY(!cache.apply(first[0], cache.generation(), true, items({ 1 })));
+    QVERIFY(cache.apply(second[0], cache.generation(), true, items({ 3 })));
+    QCOMPARE(cache.itemCount(), 1);
+
+    // Going back fetches the west cell again
+    QCOMPARE(request(cache, west, 10), first);
+}
+
+void TestCellGrid::dropsResultsFromBeforeClear()
+{
+    Cache cache(16);
+    const QRectF visible(105.80, 21.00, 0.01, 0.01);
+    const QVector<quint64> started = request(cache, visible, 10);
+    const int generation = cache.generation();
+
+    cache.clear();
+    QCOMPARE(cache.cellCount(), 0);
+
+    // The same cell is wanted again, but the result of the old fetch must not fill it
+    QCOMPARE(request(cache, visible, 10), started);
+    QVERIFY(!cache.apply(started[0], generation, true, items({ 1 })));
+    QCOMPARE(cache.itemCount(), 0);
+    QVERIFY(cache.apply(started[0], cache.generation(), true, items({ 1 })));
+    QCOMPARE(cache.itemCount(), 1);
+}
+
+void TestCellGrid::failedCellWaitsForRetry()
+{
+    Cache cache(16);
+    const QRectF visible(105.80, 21.00, 0.01, 0.01);
+    const QVector<quint64> started = request(cache, visible, 10);
+
+    QVERIFY(!cache.apply(started[0], cache.generation(), false, Cache::Fetched()));
+    QVERIFY(request(cache, visible, 10).isEmpty());
+    QVERIFY(!cache.requestVisible(visible, 10, 0, [](quint64, int, const QRectF&) {}));
+}
+
+QTEST_APPLESS_MAIN(TestCellGrid)
+#include "tst_cellgrid.moc"
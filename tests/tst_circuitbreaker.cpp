@@ -0,0 +1,110 @@
+#include "services/circuitbreaker.h"
+#include <QtTest>
+
+class TestCircuitBreaker : public QObject {
+    Q_OBJECT
+
+private slots:
+    void degradesThenGoesOffline();
+    void successResetsFailures();
+    void reportsEachChangeOnce();
+    void probeBackoffDoublesAndCaps();
+    void newOutageRestartsBackoff();
+    void tripGoesStraightOffline();
+};
+
+void TestCircuitBreaker::degradesThenGoesOffline()
+{
+    CircuitBreaker breaker(3, 100, 1000);
+    QCOMPARE(breaker.state(), CircuitBreaker::Connected);
+
+    breaker.recordFailure();
+    QCOMPARE(breaker.state(), CircuitBreaker::Degraded);
+    breaker.recordFailure();
+    QCOMPARE(breaker.state(), CircuitBreaker::Degraded);
+
+    const CircuitBreaker::Transition transition = breaker.recordFailure();
+    QCOMPARE(transition.from, CircuitBreaker::Degraded);
+    QCOMPARE(transition.to, CircuitBreaker::Offline);
+    QCOMPARE(breaker.consecutiveFailures(), 3);
+}
+
+void TestCircuitBreaker::successResetsFailures()
+{
+    CircuitBreaker breaker(3, 100, 1000);
+    breaker.recordFailure();
+    breaker.recordFailure();
+
+    const CircuitBreaker::Transition transition = breaker.recordSuccess();
+    QCOMPARE(transition.from, CircuitBreaker::Degraded);
+    QCOMPARE(transition.to, CircuitBreaker::Connected);
+    QCOMPARE(breaker.consecutiveFailures(), 0);
+
+    // The count starts over, so two more failures are not enough to go offline
+    breaker.recordFailure();
+    breaker.recordFailure();
+    QCOMPARE(breaker.state(), CircuitBreaker::Degraded);
+}
+
+void TestCircuitBreaker::reportsEachChangeOnce()
+{
+    // DatabaseService announces a change and starts probing only when told it changed
+    CircuitBreaker breaker(2, 100, 1000);
+    QVERIFY(!breaker.recordSuccess().changed());
+    QVERIFY(breaker.recordFailure().changed());
+    QVERIFY(breaker.recordFailure().changed());
+    QVERIFY(!breaker.recordFailure().changed());
+    QVERIFY(!breaker.trip().changed());
+
+    const CircuitBreaker::Transition recovered = breaker.recordSuccess();
+    QVERIFY(recovered.changed());
+    QCOMPARE(recovered.from, CircuitBreaker::Offline);
+    QVERIFY(!breaker.recordSuccess().changed());
+}
+
+void TestCircuitBreaker::probeBackoffDoublesAndCaps()
+{
+    CircuitBreaker breaker(1, 100, 500);
+    breaker.recordFailure();
+    QCOMPARE(breaker.probeDelayMs(), 100);
+
+    QCOMPARE(breaker.probeFailed(), 200);
+    QCOMPARE(breaker.probeFailed(), 400);
+    QCOMPARE(breaker.probeFailed(), 500);
+    QCOMPARE(breaker.probeFailed(), 500);
+    QCOMPARE(breaker.probeDelayMs(), 500);
+}
+
+void TestCircuitBreaker::newOutageRestartsBackoff()
+{
+    CircuitBreaker breaker(1, 100, 1000);
+    breaker.trip();
+    breaker.probeFailed();
+    breaker.probeFailed();
+    QCOMPARE(breaker.probeDelayMs(), 400);
+
+    // Failures while already offline keep the current backoff
+    breaker.recordFailure();
+    QCOMPARE(breaker.probeDelayMs(), 400);
+
+    breaker.recordSuccess();
+    breaker.recordFailure();
+    QCOMPARE(breaker.state(), CircuitBreaker::Offline);
+    QCOMPARE(breaker.probeDelayMs(), 100);
+}
+
+void TestCircuitBreaker::tripGoesStraightOffline()
+{
+    CircuitBreaker breaker(5, 100, 1000);
+    const CircuitBreaker::Transition transition = breaker.trip();
+    QCOMPARE(transition.from, CircuitBreaker::Connected);
+    QCOMPARE(transition.to, CircuitBreaker::Offline);
+
+    // Bad settings fall back to something usable
+    CircuitBreaker clamped(0, 0, -1);
+    QVERIFY(clamped.recordFailure().to == CircuitBreaker::Offline);
+    QCOMPARE(clamped.probeFailed(), 1);
+}
+
+QTEST_APPLESS_MAIN(TestCircuitBreaker)
+#include "tst_circuitbreaker.moc"
@@ -0,0 +1,73 @@
+#include "services/databasechanges.h"
+#include <QtTest>
+
+class TestDatabaseChanges : public QObject {
+    Q_OBJECT
+
+private slots:
+    void sortsByTable();
+    void latestOperationWins();
+    void ignoresOwnAndMalformedPayloads();
+    void resyncIsNotEmpty();
+
+private:
+    static std::string payload(const char* table, const char* op, const char* id, const char* origin = "other");
+};
+
+std::string TestDatabaseChanges::payload(const char* table, const char* op, const char* id, const char* origin)
+{
+    // Same shape as the gismap_notify_change() trigger builds
+    return QString("{\"table\":\"%1\",\"op\":\"%2\",\"id\":\"%3\",\"origin\":\"%4\"}")
+        .arg(table, op, id, origin).toStdString();
+}
+
+void TestDatabaseChanges::sortsByTable()
+{
+    DatabaseChanges changes;
+    QVERIFY(changes.isEmpty());
+
+    QVERIFY(changes.addNotification(payload("polygon_regions", "update", "r1"), "self"));
+    QVERIFY(changes.addNotification(payload("aircraft", "insert", "VN123"), "self"));
+    QVERIFY(changes.addNotification(payload("flight_routes", "delete", "route-7"), "self"));
+
+    QCOMPARE(changes.regionsChanged, QSet<QString>({ "r1" }));
+    QCOMPARE(changes.aircraftChanged, QSet<QString>({ "VN123" }));
+    QCOMPARE(changes.routesRemoved, QSet<QString>({ "route-7" }));
+    QVERIFY(changes.routesChanged.isEmpty());
+    QVERIFY(!changes.isEmpty());
+}
+
+void TestDatabaseChanges::latestOperationWins()
+{
+    DatabaseChanges changes;
+    changes.addNotification(payload("aircraft", "update", "VN1"), "self");
+    changes.addNotification(payload("aircraft", "update", "VN1"), "self");
+    changes.addNotification(payload("aircraft", "delete", "VN1"), "self");
+    QVERIFY(changes.aircraftChanged.isEmpty());
+    QCOMPARE(changes.aircraftRemoved, QSet<QString>({ "VN1" }));
+
+    // Re-created within the same batch
+    changes.addNotification(payload("aircraft", "insert", "VN1"), "self");
+    QCOMPARE(changes.aircraftChanged, QSet<QString>({ "VN1" }));
+    QVERIFY(changes.aircraftRemoved.isEmpty());
+}
+
+void TestDatabaseChanges::ignoresOwnAndMalformedPayloads()
+{
+    DatabaseChanges changes;
+    QVERIFY(!changes.addNotification(payload("aircraft", "update", "VN1", "self"), "self"));
+    QVERIFY(!changes.addNotification(payload("aircraft", "update", ""), "self"));
+    QVERIFY(!changes.addNotification(payload("airports", "update", "HAN"), "self"));
+    QVERIFY(!changes.addNotification("not json", "self"));
+    QVERIFY(changes.isEmpty());
+}
+
+void TestDatabaseChanges::resyncIsNotEmpty()
+{
+    DatabaseChanges changes;
+    changes.resync = true;
+    QVERIFY(!changes.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(TestDatabaseChanges)
+#include "tst_databasechanges.moc"
@@ -0,0 +1,87 @@
+#include "featurestore.h"
+#include <QCryptographicHash>
+#include <QTemporaryDir>
+#include <QtTest>
+
+class TestFeatureStore : public QObject {
+    Q_OBJECT
+
+private slots:
+    void locatesStreamedFeatures();
+    void cacheAndStreamAgree();
+    void nameFieldOverridesName();
+
+private:
+    static QVector<GeometryCache::SourceFeature> features();
+};
+
+QVector<GeometryCache::SourceFeature> TestFeatureStore::features()
+{
+    GeometryCache::SourceFeature hanoi;
+    hanoi.rings = { QPolygonF({ QPointF(105.7, 20.9), QPointF(106.0, 20.9), QPointF(106.0, 21.2),
+                                QPointF(105.7, 21.2), QPointF(105.7, 20.9) }) };
+    hanoi.name = "Ha Noi";
+    hanoi.attributes.insert("ten_tinh", "Thanh pho Ha Noi");
+
+    GeometryCache::SourceFeature haiPhong;
+    haiPhong.rings = { QPolygonF({ QPointF(106.5, 20.7), QPointF(106.8, 20.7), QPointF(106.8, 21.0),
+                                   QPointF(106.5, 20.7) }) };
+    haiPhong.name = "Hai Phong";
+
+    // No area, so it is left out of the store
+    GeometryCache::SourceFeature empty;
+    empty.name = "Empty";
+
+    return { hanoi, empty, haiPhong };
+}
+
+void TestFeatureStore::locatesStreamedFeatures()
+{
+    std::shared_ptr<const FeatureStore> store = FeatureStore::fromFeatures(features());
+    QCOMPARE(store->size(), 2);
+    QCOMPARE(store->indexOf("Hai Phong"), 1);
+    QCOMPARE(store->indexOf("Empty"), -1);
+
+    const int hanoi = store->locate(QPointF(105.85, 21.03));
+    QCOMPARE(store->name(hanoi), QString("Ha Noi"));
+    QCOMPARE(store->feature(hanoi).attributes.value("ten_tinh").toString(), QString("Thanh pho Ha Noi"));
+    QCOMPARE(store->locate(QPointF(106.75, 20.75)), 1);
+    QCOMPARE(store->locate(QPointF(104.0, 18.0)), -1);
+
+    // A stale hint still gives the right answer
+    QCOMPARE(store->locate(QPointF(106.75, 20.75), hanoi), 1);
+}
+
+void TestFeatureStore::cacheAndStreamAgree()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QByteArray hash = QCryptographicHash::hash("source", QCryptographicHash::Sha256);
+    const QString path = GeometryCache::cacheFilePath(dir.path(), hash);
+    QVERIFY(GeometryCache::build(path, hash, features()));
+    std::shared_ptr<const GeometryCache> cache = GeometryCache::open(path, hash);
+    QVERIFY(cache);
+
+    std::shared_ptr<const FeatureStore> cached = FeatureStore::fromCache(*cache);
+    std::shared_ptr<const FeatureStore> streamed = FeatureStore::fromFeatures(features());
+    QCOMPARE(cached->size(), streamed->size());
+
+    for (double lat = 20.6; lat < 21.3; lat += 0.05) {
+        for (double lon = 105.6; lon < 106.9; lon += 0.05) {
+            const QPointF point(lon, lat);
+            QCOMPARE(cached->name(cached->locate(point)), streamed->name(streamed->locate(point)));
+        }
+    }
+}
+
+void TestFeatureStore::nameFieldOverridesName()
+{
+    std::shared_ptr<const FeatureStore> store = FeatureStore::fromFeatures(features(), "ten_tinh");
+    QCOMPARE(store->indexOf("Thanh pho Ha Noi"), 0);
+
+    // Features without the field keep their own name
+    QCOMPARE(store->indexOf("Hai Phong"), 1);
+}
+
+QTEST_APPLESS_MAIN(TestFeatureStore)
+#include "tst_featurestore.moc"
@@ -0,0 +1,156 @@
+#include "geometrycache.h"
+#include "viewtransform.h"
+#include <QCryptographicHash>
+#include <QTemporaryDir>
+#include <QtTest>
+
+class TestGeometryCache : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void buildAndOpen();
+    void lodForZoom();
+    void rejectsOtherSource();
+    void rejectsCorruptHeader_data();
+    void rejectsCorruptHeader();
+    void rejectsTruncatedFile();
+
+private:
+    static QVector<GeometryCache::SourceFeature> features();
+    bool buildCache();
+    void patch(qint64 offset, const QByteArray& bytes);
+
+    QTemporaryDir m_dir;
+    QString m_path;
+    QByteArray m_hash = QCryptographicHash::hash("source", QCryptographicHash::Sha256);
+};
+
+// Header field offsets of the version 1 layout
+namespace {
+constexpr qint64 VersionOffset = 8;
+constexpr qint64 FeatureCountOffset = 48;
+constexpr qint64 PointsOffsetOffset = 80;
+}
+
+QVector<GeometryCache::SourceFeature> TestGeometryCache::features()
+{
+    GeometryCache::SourceFeature hanoi;
+    hanoi.rings = { QPolygonF({ QPointF(105.7, 20.9), QPointF(106.0, 20.9), QPointF(106.0, 21.2),
+                                QPointF(105.7, 21.2), QPointF(105.7, 20.9) }) };
+    hanoi.name = "Ha Noi";
+    hanoi.attributes.insert("code", "HN");
+
+    GeometryCache::SourceFeature haiPhong;
+    haiPhong.rings = { QPolygonF({ QPointF(106.5, 20.7), QPointF(106.8, 20.7), QPointF(106.8, 21.0),
+                                   QPointF(106.5, 20.7) }) };
+    haiPhong.name = "Hai Phong";
+
+    return { hanoi, haiPhong };
+}
+
+void TestGeometryCache::init()
+{
+    QVERIFY(m_dir.isValid());
+    m_path = GeometryCache::cacheFilePath(m_dir.path(), m_hash);
+    QFile::remove(m_path);
+}
+
+bool TestGeometryCache::buildCache()
+{
+    return GeometryCache::build(m_path, m_hash, features());
+}
+
+void TestGeometryCache::patch(qint64 offset, const QByteArray& bytes)
+{
+    QFile file(m_path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.seek(offset));
+    QCOMPARE(file.write(bytes), qint64(bytes.size()));
+}
+
+void TestGeometryCache::buildAndOpen()
+{
+    QVERIFY(buildCache());
+    std::shared_ptr<const GeometryCache> cache = GeometryCache::open(m_path, m_hash);
+    QVERIFY(cache);
+
+    QCOMPARE(cache->featureCount(), 2);
+    QCOMPARE(cache->featureName(0), QString("Ha Noi"));
+    QCOMPARE(cache->featureName(1), QString("Hai Phong"));
+    QCOMPARE(cache->featureAttributes(0).value("code").toString(), QString("HN"));
+
+    // Level 0 keeps every point, already projected to world coordinates
+    QCOMPARE(cache->ringCount(0, 0), 1);
+    const GeometryCache::Ring& ring = cache->ring(0, 0, 0);
+    QCOMPARE(int(ring.pointCount), 5);
+    const GeometryCache::Point* points = cache->points(ring);
+    const QPointF expected = ViewTransform::projectToWorld(QPointF(105.7, 20.9));
+    QCOMPARE(points[0].x, expected.x());
+    QCOMPARE(points[0].y, expected.y());
+
+    const QRectF bounds = cache->featureBounds(0);
+    QVERIFY(bounds.contains(ViewTransform::projectToWorld(QPointF(105.85, 21.05))));
+    QVERIFY(cache->bounds().contains(cache->featureBounds(1)));
+}
+
+void TestGeometryCache::lodForZoom()
+{
+    QVERIFY(buildCache());
+    std::shared_ptr<const GeometryCache> cache = GeometryCache::open(m_path, m_hash);
+    QVERIFY(cache);
+
+    // Each generalized level serves its own zoom and every coarser one
+    QCOMPARE(cache->lodForZoom(18), 0);
+    QCOMPARE(cache->lodForZoom(13), 0);
+    QCOMPARE(cache->lodForZoom(12), 1);
+    QCOMPARE(cache->lodForZoom(9), 2);
+    QCOMPARE(cache->lodForZoom(6), 3);
+    QCOMPARE(cache->lodForZoom(2), 3);
+}
+
+void TestGeometryCache::rejectsOtherSource()
+{
+    QVERIFY(buildCache());
+    QVERIFY(!GeometryCache::open(m_path, QCryptographicHash::hash("edited", QCryptographicHash::Sha256)));
+    QVERIFY(!GeometryCache::open(m_path, QByteArray()));
+    QVERIFY(!GeometryCache::build(m_path, QByteArray("short"), features()));
+}
+
+void TestGeometryCache::rejectsCorruptHeader_data()
+{
+    QTest::addColumn<qint64>("offset");
+    QTest::addColumn<QByteArray>("bytes");
+
+    QTest::newRow("magic") << qint64(0) << QByteArray("XXXX");
+    QTest::newRow("version") << VersionOffset << QByteArray("\x63\x00\x00\x00", 4);
+    QTest::newRow("feature count") << FeatureCountOffset << QByteArray("\xff\xff\xff\x7f", 4);
+    QTest::newRow("points offset") << PointsOffsetOffset << QByteArray(8, '\x7f');
+    QTest::newRow("misaligned points") << PointsOffsetOffset << QByteArray("\x09", 1);
+}
+
+void TestGeometryCache::rejectsCorruptHeader()
+{
+    QFETCH(qint64, offset);
+    QFETCH(QByteArray, bytes);
+
+    QVERIFY(buildCache());
+    QVERIFY(GeometryCache::open(m_path, m_hash));
+
+    patch(offset, bytes);
+    QVERIFY(!GeometryCache::open(m_path, m_hash));
+}
+
+void TestGeometryCache::rejectsTruncatedFile()
+{
+    QVERIFY(buildCache());
+    const qint64 size = QFileInfo(m_path).size();
+
+    for (qint64 length : { qint64(0), qint64(16), size / 2, size - 1 }) {
+        QVERIFY(QFile::resize(m_path, length));
+        QVERIFY2(!GeometryCache::open(m_path, m_hash), qPrintable(QString("truncated to %1 bytes").arg(length)));
+    }
+}
+
+QTEST_APPLESS_MAIN(TestGeometryCache)
+#include "tst_geometrycache.moc"
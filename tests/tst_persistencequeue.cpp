@@ -0,0 +1,264 @@
+#include "services/persistencequeue.h"
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <algorithm>
+#include <pqxx/pqxx>
+#include <stdexcept>
+
+class TestPersistenceQueue : public QObject {
+    Q_OBJECT
+
+private slots:
+    void coalescesPerAircraft();
+    void deleteAndUpdateReplaceEachOther();
+    void boundsSamples();
+    void requeueKeepsNewerEntries();
+    void requeuedSamplesGoFirst();
+    void classifiesFailures();
+    void settleKeepsOnlyRetries();
+    void journalRoundTrip();
+    void journalCapDropsOldestSamples();
+    void rejectsForeignJournal();
+
+private:
+    static AircraftSnapshot snapshot(const QString& id, double altitude);
+
+    template<typename Exception>
+    static PersistenceQueue::WriteResult classify(const Exception& error)
+    {
+        try {
+            throw error;
+        } catch (...) {
+            return PersistenceQueue::classifyFailure("testing,", 1);
+        }
+    }
+};
+
+AircraftSnapshot TestPersistenceQueue::snapshot(const QString& id, double altitude)
+{
+    AircraftSnapshot snapshot;
+    snapshot.aircraftId = id;
+    snapshot.altitude = altitude;
+    snapshot.updatedAt = QDateTime::fromMSecsSinceEpoch(qint64(altitude), Qt::UTC);
+    return snapshot;
+}
+
+void TestPersistenceQueue::coalescesPerAircraft()
+{
+    PersistenceQueue queue(true, 100);
+    queue.enqueue(snapshot("VN1", 1000));
+    queue.enqueue(snapshot("VN2", 2000));
+    queue.enqueue(snapshot("VN1", 1500));
+
+    // One row per aircraft, the latest state; every tick stays a history sample
+    QCOMPARE(queue.pendingCount(), 2);
+    QCOMPARE(queue.sampleCount(), 3);
+
+    const PersistenceQueue::Round round = queue.take();
+    QVERIFY(queue.isEmpty());
+    QCOMPARE(round.batch.size(), 2);
+    const auto vn1 = std::find_if(round.batch.cbegin(), round.batch.cend(),
+                                  [](const AircraftSnapshot& s) { return s.aircraftId == "VN1"; });
+    QVERIFY(vn1 != round.batch.cend());
+    QCOMPARE(vn1->altitude, 1500.0);
+    QCOMPARE(round.samples.first().altitude, 1000.0);
+    QCOMPARE(round.samples.last().altitude, 1500.0);
+}
+
+void TestPersistenceQueue::deleteAndUpdateReplaceEachOther()
+{
+    PersistenceQueue queue(false, 0);
+    queue.enqueue(snapshot("VN1", 1000));
+    queue.enqueueDelete("VN1");
+    QCOMPARE(queue.pendingCount(), 0);
+    QCOMPARE(queue.deleteCount(), 1);
+
+    // Re-added before the delete was written: the upsert wins
+    queue.enqueue(snapshot("VN1", 1200));
+    QCOMPARE(queue.pendingCount(), 1);
+    QCOMPARE(queue.deleteCount(), 0);
+    QCOMPARE(queue.sampleCount(), 0);
+
+    queue.discard("VN1");
+    QVERIFY(queue.isEmpty());
+}
+
+void TestPersistenceQueue::boundsSamples()
+{
+    PersistenceQueue queue(true, 3);
+    for (int i = 0; i < 5; ++i) {
+        queue.enqueue(snapshot("VN1", i));
+    }
+
+    // New samples past the bound are counted, not kept; the aircraft state still is
+    QCOMPARE(queue.sampleCount(), 3);
+    QCOMPARE(queue.takeDroppedSamples(), 2);
+    QCOMPARE(queue.takeDroppedSamples(), 0);
+    QCOMPARE(queue.take().batch.first().altitude, 4.0);
+}
+
+void TestPersistenceQueue::requeueKeepsNewerEntries()
+{
+    PersistenceQueue queue(false, 0);
+    queue.enqueue(snapshot("VN1", 1000));
+    queue.enqueue(snapshot("VN2", 2000));
+    queue.enqueue(snapshot("VN3", 3000));
+    queue.enqueueDelete("VN4");
+    const PersistenceQueue::Round failed = queue.take();
+
+    // While the round was being written: VN1 moved, VN2 was deleted, VN4 came back
+    queue.enqueue(snapshot("VN1", 1100));
+    queue.enqueueDelete("VN2");
+    queue.enqueue(snapshot("VN4", 4000));
+    queue.requeue(failed);
+
+    const PersistenceQueue::Round round = queue.take();
+    QCOMPARE(round.batch.size(), 3);
+    QCOMPARE(round.deletes, QStringList{ "VN2" });
+    for (const AircraftSnapshot& s : round.batch) {
+        if (s.aircraftId == "VN1") QCOMPARE(s.altitude, 1100.0);
+        if (s.aircraftId == "VN3") QCOMPARE(s.altitude, 3000.0);
+        if (s.aircraftId == "VN4") QCOMPARE(s.altitude, 4000.0);
+        QVERIFY(s.aircraftId != "VN2");
+    }
+}
+
+void TestPersistenceQueue::requeuedSamplesGoFirst()
+{
+    PersistenceQueue queue(true, 4);
+    queue.enqueue(snapshot("VN1", 1));
+    queue.enqueue(snapshot("VN1", 2));
+    queue.enqueue(snapshot("VN1", 3));
+    const PersistenceQueue::Round failed = queue.take();
+
+    queue.enqueue(snapshot("VN1", 4));
+    queue.enqueue(snapshot("VN1", 5));
+    queue.requeue(failed);
+
+    // Oldest first, and the oldest are the ones that no longer fit
+    const PersistenceQueue::Round round = queue.take();
+    QCOMPARE(round.samples.size(), 4);
+    QCOMPARE(round.samples.first().altitude, 2.0);
+    QCOMPARE(round.samples.last().altitude, 5.0);
+    QCOMPARE(queue.takeDroppedSamples(), 1);
+}
+
+void TestPersistenceQueue::classifiesFailures()
+{
+    // The server refused the rows themselves: writing them again would fail again
+    QCOMPARE(classify(pqxx::data_exception("invalid input syntax")), PersistenceQueue::Rejected);
+    QCOMPARE(classify(pqxx::integrity_constraint_violation("duplicate key")), PersistenceQueue::Rejected);
+
+    // Nothing wrong with the rows; the next flush may well get them through
+    QCOMPARE(classify(pqxx::broken_connection("server closed the connection")), PersistenceQueue::Retry);
+    QCOMPARE(classify(pqxx::in_doubt_error("commit outcome unknown")), PersistenceQueue::Retry);
+    QCOMPARE(classify(pqxx::serialization_failure("could not serialize access")), PersistenceQueue::Retry);
+    QCOMPARE(classify(std::runtime_error("pool checkout timed out")), PersistenceQueue::Retry);
+}
+
+void TestPersistenceQueue::settleKeepsOnlyRetries()
+{
+    PersistenceQueue queue(true, 10);
+    queue.enqueue(snapshot("VN1", 1000));
+    queue.enqueueDelete("VN2");
+    PersistenceQueue::Round round = queue.take();
+
+    // States back for another try, samples dropped as rejected, deletes done
+    QVERIFY(queue.settle(round, PersistenceQueue::Retry, PersistenceQueue::Rejected, PersistenceQueue::Written));
+    QCOMPARE(queue.pendingCount(), 1);
+    QCOMPARE(queue.sampleCount(), 0);
+    QCOMPARE(queue.deleteCount(), 0);
+
+    round = queue.take();
+    QVERIFY(!queue.settle(round, PersistenceQueue::Written, PersistenceQueue::Written, PersistenceQueue::Rejected));
+    QVERIFY(queue.isEmpty());
+}
+
+void TestPersistenceQueue::journalRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("journal/persistence.journal");
+
+    PersistenceQueue queue(true, 10);
+    AircraftSnapshot state = snapshot("VN1", 1000);
+    state.callSign = "HVN123";
+    state.position = QPointF(105.85, 21.03);
+    state.state = 2;
+    queue.enqueue(state);
+    queue.enqueue(snapshot("VN2", 2000));
+    queue.enqueueDelete("VN3");
+    QVERIFY(queue.saveJournal(path, 1024 * 1024));
+
+    // Replayed after a restart, with history since turned off
+    PersistenceQueue replayed(false, 10);
+    QVERIFY(replayed.loadJournal(path));
+    QCOMPARE(replayed.pendingCount(), 2);
+    QCOMPARE(replayed.deleteCount(), 1);
+    QCOMPARE(replayed.sampleCount(), 0);
+
+    const PersistenceQueue::Round round = replayed.take();
+    QCOMPARE(round.deletes, QStringList{ "VN3" });
+    const auto vn1 = std::find_if(round.batch.cbegin(), round.batch.cend(),
+                                  [](const AircraftSnapshot& s) { return s.aircraftId == "VN1"; });
+    QVERIFY(vn1 != round.batch.cend());
+    QCOMPARE(vn1->callSign, QString("HVN123"));
+    QCOMPARE(vn1->position, QPointF(105.85, 21.03));
+    QCOMPARE(vn1->state, 2);
+    QCOMPARE(vn1->updatedAt, state.updatedAt);
+}
+
+void TestPersistenceQueue::journalCapDropsOldestSamples()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString full = dir.filePath("full.journal");
+    const QString capped = dir.filePath("capped.journal");
+
+    PersistenceQueue queue(true, 1000);
+    for (int i = 0; i < 100; ++i) {
+        queue.enqueue(snapshot("VN1", i));
+    }
+    QVERIFY(queue.saveJournal(full, 1024 * 1024));
+
+    // Room for about half the samples; the aircraft state is always kept
+    const qint64 size = QFileInfo(full).size();
+    QVERIFY(queue.saveJournal(capped, size / 2));
+    QVERIFY(QFileInfo(capped).size() <= size / 2);
+
+    PersistenceQueue replayed(true, 1000);
+    QVERIFY(replayed.loadJournal(capped));
+    QCOMPARE(replayed.pendingCount(), 1);
+    QVERIFY(replayed.sampleCount() > 0);
+    QVERIFY(replayed.sampleCount() < 100);
+
+    const PersistenceQueue::Round round = replayed.take();
+    QCOMPARE(round.samples.last().altitude, 99.0);
+    QCOMPARE(round.samples.first().altitude, double(100 - round.samples.size()));
+}
+
+void TestPersistenceQueue::rejectsForeignJournal()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("other.journal");
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("not a journal at all");
+    file.close();
+
+    PersistenceQueue queue(true, 10);
+    queue.enqueue(snapshot("VN1", 1000));
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("unknown format"));
+    QVERIFY(!queue.loadJournal(path));
+
+    // What was queued is left alone
+    QCOMPARE(queue.pendingCount(), 1);
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Cannot open persistence journal"));
+    QVERIFY(!queue.loadJournal(dir.filePath("missing.journal")));
+}
+
+QTEST_APPLESS_MAIN(TestPersistenceQueue)
+#include "tst_persistencequeue.moc"
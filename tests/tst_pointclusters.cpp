@@ -0,0 +1,113 @@
+#include "pointclusters.h"
+#include <QtTest>
+
+class TestPointClusters : public QObject {
+    Q_OBJECT
+
+private slots:
+    void mergesByWeight();
+    void keepsCountsAtEveryLevel();
+    void levelForZoomClamps();
+    void indexFindsClustersInView();
+    void emptyInput();
+
+private:
+    using Cluster = PointClusters::Cluster;
+
+    static int totalCount(const PointClusters::Level& level);
+};
+
+int TestPointClusters::totalCount(const PointClusters::Level& level)
+{
+    int count = 0;
+    for (const Cluster& cluster : level.clusters) {
+        count += cluster.count;
+    }
+    return count;
+}
+
+void TestPointClusters::mergesByWeight()
+{
+    // The second input is a server aggregate standing for three points
+    const PointClusters clusters({ Cluster{ QPointF(10.0, 10.0), 1, 1 },
+                                   Cluster{ QPointF(10.4, 10.4), 3, -1 },
+                                   Cluster{ QPointF(200.0, 200.0), 1, 7 } },
+                                 0, 2, 40.0);
+    QCOMPARE(clusters.pointCount(), 3);
+
+    // 10 world units per cell at zoom 2: the first two share a cell
+    const PointClusters::Level* level = clusters.levelForZoom(2);
+    QVERIFY(level);
+    QCOMPARE(level->clusters.size(), 2);
+
+    const Cluster& merged = level->clusters[0].count == 4 ? level->clusters[0] : level->clusters[1];
+    const Cluster& alone = level->clusters[0].count == 4 ? level->clusters[1] : level->clusters[0];
+    QCOMPARE(merged.count, 4);
+    QVERIFY(qAbs(merged.world.x() - 10.3) < 1e-9);
+    QVERIFY(qAbs(merged.world.y() - 10.3) < 1e-9);
+
+    // A lone point is still addressable by its id
+    QCOMPARE(alone.count, 1);
+    QCOMPARE(alone.pointId, qint64(7));
+    QCOMPARE(alone.world, QPointF(200.0, 200.0));
+}
+
+void TestPointClusters::keepsCountsAtEveryLevel()
+{
+    QVector<Cluster> points;
+    for (int i = 0; i < 400; ++i) {
+        points.append(Cluster{ QPointF((i * 37) % 256 + 0.5, (i * 91) % 256 + 0.5), 1 + i % 4, i });
+    }
+    int expected = 0;
+    for (const Cluster& point : points) {
+        expected += point.count;
+    }
+
+    const PointClusters clusters(points, 3, 8, 40.0);
+    int previous = 0;
+    for (int zoom = 3; zoom <= 9; ++zoom) {
+        const PointClusters::Level* level = clusters.levelForZoom(zoom);
+        QVERIFY(level);
+        QCOMPARE(totalCount(*level), expected);
+
+        // Coarser zooms never hold more clusters than finer ones
+        QVERIFY(level->clusters.size() >= previous);
+        previous = level->clusters.size();
+    }
+}
+
+void TestPointClusters::levelForZoomClamps()
+{
+    const PointClusters clusters({ Cluster{ QPointF(1, 1), 1, 1 }, Cluster{ QPointF(1.1, 1.1), 1, 2 } }, 4, 6, 40.0);
+    QCOMPARE(clusters.minZoom(), 4);
+    QCOMPARE(clusters.maxZoom(), 6);
+
+    // Below the range the coarsest level is used, past it the unmerged points
+    QCOMPARE(clusters.levelForZoom(0), clusters.levelForZoom(4));
+    QCOMPARE(clusters.levelForZoom(4)->clusters.size(), 1);
+    QCOMPARE(clusters.levelForZoom(7)->clusters.size(), 2);
+    QCOMPARE(clusters.levelForZoom(20), clusters.levelForZoom(7));
+}
+
+void TestPointClusters::indexFindsClustersInView()
+{
+    const PointClusters clusters({ Cluster{ QPointF(5, 5), 1, 1 }, Cluster{ QPointF(100, 100), 1, 2 } }, 0, 0, 1.0);
+    const PointClusters::Level* level = clusters.levelForZoom(1);
+
+    QVector<qint64> found;
+    level->index.query(QRectF(0, 0, 10, 10), [&found, level](int i) {
+        found.append(level->clusters[i].pointId);
+    });
+    QCOMPARE(found, QVector<qint64>{ 1 });
+}
+
+void TestPointClusters::emptyInput()
+{
+    const PointClusters clusters(QVector<Cluster>(), 0, 5, 40.0);
+    QVERIFY(clusters.isEmpty());
+    QCOMPARE(clusters.pointCount(), 0);
+    QVERIFY(!clusters.levelForZoom(3));
+}
+
+QTEST_APPLESS_MAIN(TestPointClusters)
+#include "tst_pointclusters.moc"
@@ -0,0 +1,62 @@
+#include "preparedpolygon.h"
+#include <QtTest>
+
+class TestPreparedPolygon : public QObject {
+    Q_OBJECT
+
+private slots:
+    void matchesQPolygonF();
+    void holes();
+    void classifiesCells();
+};
+
+void TestPreparedPolygon::matchesQPolygonF()
+{
+    // Concave outline, so boundary cells and fully inside/outside cells all occur
+    QPolygonF outline;
+    outline << QPointF(0, 0) << QPointF(10, 0) << QPointF(10, 10) << QPointF(6, 10)
+            << QPointF(6, 4) << QPointF(4, 4) << QPointF(4, 10) << QPointF(0, 10) << QPointF(0, 0);
+    const PreparedPolygon prepared(outline, 8);
+
+    QCOMPARE(prepared.boundingRect(), outline.boundingRect());
+    for (double y = -1.05; y < 11.0; y += 0.37) {
+        for (double x = -1.05; x < 11.0; x += 0.37) {
+            const QPointF point(x, y);
+            QVERIFY2(prepared.containsPoint(point) == outline.containsPoint(point, Qt::OddEvenFill),
+                     qPrintable(QString("point %1, %2").arg(x).arg(y)));
+        }
+    }
+    QCOMPARE(prepared.cellAt(QPointF(-5, -5)), -1);
+}
+
+void TestPreparedPolygon::holes()
+{
+    const QPolygonF outer(QRectF(0, 0, 10, 10));
+    const QPolygonF hole(QRectF(3, 3, 4, 4));
+    const PreparedPolygon prepared(QVector<QPolygonF>{ outer, hole });
+
+    QVERIFY(prepared.containsPoint(QPointF(1, 1)));
+    QVERIFY(!prepared.containsPoint(QPointF(5, 5)));
+    QVERIFY(prepared.containsPoint(QPointF(8, 5)));
+    QVERIFY(!prepared.containsPoint(QPointF(12, 5)));
+    QVERIFY(PreparedPolygon().isEmpty());
+}
+
+void TestPreparedPolygon::classifiesCells()
+{
+    // One-unit cells; only the cells the outline or the hole edges touch need a crossing test
+    const PreparedPolygon prepared(QVector<QPolygonF>{ QPolygonF(QRectF(0, 0, 10, 10)),
+                                                       QPolygonF(QRectF(3, 3, 4, 4)) }, 10);
+
+    QCOMPARE(prepared.cellClass(prepared.cellAt(QPointF(1.5, 1.5))), PreparedPolygon::Inside);
+    QCOMPARE(prepared.cellClass(prepared.cellAt(QPointF(5.5, 5.5))), PreparedPolygon::Outside);
+    QCOMPARE(prepared.cellClass(prepared.cellAt(QPointF(0.5, 5.5))), PreparedPolygon::Boundary);
+    QCOMPARE(prepared.cellClass(prepared.cellAt(QPointF(3.5, 5.5))), PreparedPolygon::Boundary);
+
+    // Classified cells answer without a crossing test and must agree with it
+    QVERIFY(prepared.containsPoint(QPointF(1.2, 1.8)));
+    QVERIFY(!prepared.containsPoint(QPointF(5.2, 5.8)));
+}
+
+QTEST_APPLESS_MAIN(TestPreparedPolygon)
+#include "tst_preparedpolygon.moc"
@@ -0,0 +1,109 @@
+#include "regiontally.h"
+#include <QtTest>
+#include <algorithm>
+
+class TestRegionTally : public QObject {
+    Q_OBJECT
+
+private slots:
+    void countsFollowMoves();
+    void outsideIsNotCounted();
+    void removeAndClear();
+    void relocateAllRecounts();
+
+private:
+    using Tally = RegionTally<QString>;
+    static Tally tally(int regionCount);
+};
+
+TestRegionTally::Tally TestRegionTally::tally(int regionCount)
+{
+    Tally tally;
+    tally.relocateAll(regionCount, [](const QString&) { return -1; });
+    return tally;
+}
+
+void TestRegionTally::countsFollowMoves()
+{
+    Tally provinces = tally(3);
+    QVERIFY(provinces.assign("VN1", 0));
+    QVERIFY(provinces.assign("VN2", 0));
+    QVERIFY(provinces.assign("VN3", 2));
+    QCOMPARE(provinces.count(0), 2);
+    QCOMPARE(provinces.count(2), 1);
+
+    // Staying put changes nothing and is not reported
+    QVERIFY(!provinces.assign("VN1", 0));
+    QCOMPARE(provinces.count(0), 2);
+
+    QVERIFY(provinces.assign("VN1", 1));
+    QCOMPARE(provinces.count(0), 1);
+    QCOMPARE(provinces.count(1), 1);
+    QCOMPARE(provinces.regionOf("VN1"), 1);
+
+    QVector<QString> inFirst = provinces.keysIn(0);
+    QCOMPARE(inFirst, QVector<QString>({ "VN2" }));
+}
+
+void TestRegionTally::outsideIsNotCounted()
+{
+    Tally provinces = tally(2);
+
+    // A new item outside every region is tracked, but nothing changed
+    QVERIFY(!provinces.assign("VN1", -1));
+    QVERIFY(provinces.contains("VN1"));
+    QCOMPARE(provinces.regionOf("VN1"), -1);
+    QCOMPARE(provinces.regionOf("unknown"), -1);
+
+    QVERIFY(provinces.assign("VN1", 1));
+    QVERIFY(provinces.assign("VN1", -1));
+    QCOMPARE(provinces.count(1), 0);
+    QCOMPARE(provinces.count(-1), 0);
+    QVERIFY(provinces.keysIn(-1).isEmpty());
+}
+
+void TestRegionTally::removeAndClear()
+{
+    Tally provinces = tally(2);
+    provinces.assign("VN1", 0);
+    provinces.assign("VN2", 0);
+    provinces.assign("VN3", -1);
+
+    QVERIFY(provinces.remove("VN1"));
+    QVERIFY(!provinces.remove("VN1"));
+    QVERIFY(provinces.remove("VN3"));
+    QCOMPARE(provinces.count(0), 1);
+    QCOMPARE(provinces.size(), 1);
+
+    provinces.clear();
+    QCOMPARE(provinces.size(), 0);
+    QCOMPARE(provinces.count(0), 0);
+    QCOMPARE(provinces.regionCount(), 2);
+}
+
+void TestRegionTally::relocateAllRecounts()
+{
+    Tally provinces = tally(2);
+    provinces.assign("VN1", 0);
+    provinces.assign("VN2", 1);
+    provinces.assign("VN3", 1);
+
+    // A new boundary set: indices are reassigned and counts rebuilt from scratch
+    provinces.relocateAll(4, [](const QString& key) { return key == "VN1" ? -1 : 3; });
+    QCOMPARE(provinces.regionCount(), 4);
+    QCOMPARE(provinces.count(0), 0);
+    QCOMPARE(provinces.count(1), 0);
+    QCOMPARE(provinces.count(3), 2);
+    QCOMPARE(provinces.regionOf("VN1"), -1);
+
+    QVector<QString> inLast = provinces.keysIn(3);
+    std::sort(inLast.begin(), inLast.end());
+    QCOMPARE(inLast, QVector<QString>({ "VN2", "VN3" }));
+
+    int visited = 0;
+    provinces.forEachKey([&visited](const QString&) { ++visited; });
+    QCOMPARE(visited, 3);
+}
+
+QTEST_APPLESS_MAIN(TestRegionTally)
+#include "tst_regiontally.moc"
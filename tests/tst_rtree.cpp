@@ -0,0 +1,77 @@
+#include "rtree.h"
+#include <QtTest>
+#include <algorithm>
+
+class TestRTree : public QObject {
+    Q_OBJECT
+
+private slots:
+    void matchesLinearScan();
+    void emptyAndPointEntries();
+    void rebuildReplacesEntries();
+};
+
+void TestRTree::matchesLinearScan()
+{
+    QVector<RTree<int>::Entry> entries;
+    for (int i = 0; i < 500; ++i) {
+        const double x = (i * 37) % 200;
+        const double y = (i * 91) % 200;
+        entries.append(RTree<int>::Entry{ QRectF(x, y, 1 + i % 7, 1 + i % 5), i });
+    }
+    RTree<int> tree;
+    tree.build(entries);
+    QCOMPARE(tree.size(), entries.size());
+
+    for (const QRectF& query : { QRectF(0, 0, 20, 20), QRectF(50, 120, 60, 3), QRectF(190, 190, 50, 50) }) {
+        QVector<int> found;
+        tree.query(query, [&found](int value) { found.append(value); });
+
+        // Closed rectangles: touching an edge counts, unlike QRectF::intersects()
+        QVector<int> expected;
+        for (const RTree<int>::Entry& entry : entries) {
+            const QRectF& r = entry.bounds;
+            if (r.left() <= query.right() && query.left() <= r.right()
+                && r.top() <= query.bottom() && query.top() <= r.bottom()) {
+                expected.append(entry.value);
+            }
+        }
+        std::sort(found.begin(), found.end());
+        QCOMPARE(found, expected);
+    }
+}
+
+void TestRTree::emptyAndPointEntries()
+{
+    RTree<int> tree;
+    int calls = 0;
+    tree.query(QPointF(1, 1), [&calls](int) { ++calls; });
+    QCOMPARE(calls, 0);
+
+    // Zero-size bounds (points) must still be found by a point query on them
+    tree.build({ RTree<int>::Entry{ QRectF(QPointF(2, 3), QPointF(2, 3)), 7 } });
+    QVector<int> found;
+    tree.query(QPointF(2, 3), [&found](int value) { found.append(value); });
+    QCOMPARE(found, QVector<int>{ 7 });
+}
+
+void TestRTree::rebuildReplacesEntries()
+{
+    // Regions are re-indexed whole when one is added, edited or removed
+    RTree<int> tree;
+    tree.build({ RTree<int>::Entry{ QRectF(0, 0, 10, 10), 1 }, RTree<int>::Entry{ QRectF(20, 20, 5, 5), 2 } });
+    tree.build({ RTree<int>::Entry{ QRectF(20, 20, 5, 5), 2 } });
+    QCOMPARE(tree.size(), 1);
+
+    QVector<int> found;
+    tree.query(QPointF(5, 5), [&found](int value) { found.append(value); });
+    QVERIFY(found.isEmpty());
+
+    tree.clear();
+    QVERIFY(tree.isEmpty());
+    tree.query(QPointF(22, 22), [&found](int value) { found.append(value); });
+    QVERIFY(found.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(TestRTree)
+#include "tst_rtree.moc"
@@ -0,0 +1,152 @@
+#include "trailbuffer.h"
+#include <QRegularExpression>
+#include <QtTest>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class TestTrailBuffer : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void wrapsAroundOldestFirst();
+    void clearBumpsGeneration();
+    void clampsToSlotCapacity();
+    void forEachMatchesToVector();
+    void capacityChangeStartsOver();
+    void recyclesSlots();
+    void concurrentAcquireAndRelease();
+};
+
+void TestTrailBuffer::initTestCase()
+{
+    // Small slots and blocks so wrap-around and block growth show up quickly
+    TrailPool::instance().configure(4, 2);
+    QCOMPARE(TrailPool::instance().slotCapacity(), 4);
+}
+
+void TestTrailBuffer::wrapsAroundOldestFirst()
+{
+    TrailBuffer trail;
+    QVERIFY(trail.isEmpty());
+
+    for (int i = 0; i < 6; ++i) {
+        trail.append(QPointF(i, -i));
+    }
+
+    QCOMPARE(trail.capacity(), 4);
+    QCOMPARE(trail.size(), 4);
+    QCOMPARE(trail.totalAppended(), quint64(6));
+    QCOMPARE(trail.at(0), QPointF(2, -2));
+    QCOMPARE(trail.last(), QPointF(5, -5));
+    QCOMPARE(trail.toVector(), QVector<QPointF>({ QPointF(2, -2), QPointF(3, -3), QPointF(4, -4), QPointF(5, -5) }));
+}
+
+void TestTrailBuffer::clearBumpsGeneration()
+{
+    TrailBuffer trail;
+    trail.append(QPointF(1, 1));
+    trail.append(QPointF(2, 2));
+    const int generation = trail.generation();
+
+    trail.clear();
+    QVERIFY(trail.isEmpty());
+    QCOMPARE(trail.generation(), generation + 1);
+    QCOMPARE(trail.totalAppended(), quint64(2));
+
+    trail.append(QPointF(3, 3));
+    QCOMPARE(trail.size(), 1);
+    QCOMPARE(trail.last(), QPointF(3, 3));
+}
+
+void TestTrailBuffer::clampsToSlotCapacity()
+{
+    TrailBuffer trail;
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Trail capacity 100 exceeds the pool slot size"));
+    trail.setCapacity(100);
+    QCOMPARE(trail.capacity(), 4);
+
+    trail.setCapacity(0);
+    QCOMPARE(trail.capacity(), 2);
+}
+
+void TestTrailBuffer::forEachMatchesToVector()
+{
+    // forEach walks the ring in place and must visit in the same order as the copy
+    TrailBuffer trail;
+    for (int i = 0; i < 7; ++i) {
+        trail.append(QPointF(i, i));
+    }
+
+    QVector<QPointF> visited;
+    trail.forEach([&visited](const QPointF& point) { visited.append(point); });
+    QCOMPARE(visited, trail.toVector());
+    QCOMPARE(visited.first(), QPointF(3, 3));
+}
+
+void TestTrailBuffer::capacityChangeStartsOver()
+{
+    TrailBuffer trail;
+    trail.append(QPointF(1, 1));
+    trail.append(QPointF(2, 2));
+    const int generation = trail.generation();
+
+    // Points laid out for the old capacity would wrap at the wrong place
+    trail.setCapacity(3);
+    QVERIFY(trail.isEmpty());
+    QCOMPARE(trail.generation(), generation + 1);
+
+    // Setting the same capacity again keeps what is there
+    trail.append(QPointF(3, 3));
+    trail.setCapacity(3);
+    QCOMPARE(trail.size(), 1);
+}
+
+void TestTrailBuffer::recyclesSlots()
+{
+    TrailPool& pool = TrailPool::instance();
+    const int used = pool.usedSlots();
+    {
+        TrailBuffer a;
+        TrailBuffer b;
+        a.append(QPointF(0, 0));
+        b.append(QPointF(0, 0));
+        QCOMPARE(pool.usedSlots(), used + 2);
+    }
+    QCOMPARE(pool.usedSlots(), used);
+
+    // A released slot is handed out again before the pool grows
+    const int allocated = pool.allocatedSlots();
+    TrailBuffer c;
+    c.append(QPointF(1, 1));
+    QCOMPARE(pool.allocatedSlots(), allocated);
+}
+
+void TestTrailBuffer::concurrentAcquireAndRelease()
+{
+    // Aircraft are built on pool threads while loading from the database
+    TrailPool& pool = TrailPool::instance();
+    const int used = pool.usedSlots();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t]() {
+            for (int round = 0; round < 200; ++round) {
+                std::vector<std::unique_ptr<TrailBuffer>> trails;
+                for (int i = 0; i < 8; ++i) {
+                    trails.push_back(std::make_unique<TrailBuffer>());
+                    trails.back()->append(QPointF(t, i));
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    QCOMPARE(pool.usedSlots(), used);
+}
+
+QTEST_APPLESS_MAIN(TestTrailBuffer)
+#include "tst_trailbuffer.moc"
@@ -0,0 +1,182 @@
+#include "wkbreader.h"
+#include <QtTest>
+
+class TestWkb : public QObject {
+    Q_OBJECT
+
+private slots:
+    void roundTripPolygonWithHole();
+    void roundTripMultiPolygon();
+    void readsBigEndianEwkbWithSrid();
+    void skipsIsoZOrdinates();
+    void readsGeometryCollection();
+    void rejectsTruncatedBuffer();
+    void rejectsCountsBeyondBuffer();
+    void rejectsNonPolygonal();
+    void decodesByteaHex();
+
+private:
+    static WkbReader::Polygon square(double x, double y, double size);
+    static bool read(const QByteArray& wkb, QVector<WkbReader::Polygon>& polygons);
+};
+
+WkbReader::Polygon TestWkb::square(double x, double y, double size)
+{
+    QPolygonF ring;
+    ring << QPointF(x, y) << QPointF(x + size, y) << QPointF(x + size, y + size)
+         << QPointF(x, y + size) << QPointF(x, y);
+    return WkbReader::Polygon{ ring };
+}
+
+bool TestWkb::read(const QByteArray& wkb, QVector<WkbReader::Polygon>& polygons)
+{
+    WkbReader reader(wkb.constData(), static_cast<std::size_t>(wkb.size()));
+    return reader.readPolygons(polygons);
+}
+
+void TestWkb::roundTripPolygonWithHole()
+{
+    WkbReader::Polygon polygon = square(105.0, 21.0, 1.0);
+    polygon.append(square(105.25, 21.25, 0.5).first());
+
+    const QByteArray wkb = WkbWriter::writePolygons({ polygon });
+
+    QVector<WkbReader::Polygon> polygons;
+    QVERIFY(read(wkb, polygons));
+    QCOMPARE(polygons.size(), 1);
+    QCOMPARE(polygons.first(), polygon);
+}
+
+void TestWkb::roundTripMultiPolygon()
+{
+    const QVector<WkbReader::Polygon> input = { square(0.0, 0.0, 1.0), square(10.0, 10.0, 2.0) };
+    const QByteArray wkb = WkbWriter::writePolygons(input);
+
+    QVector<WkbReader::Polygon> polygons;
+    QVERIFY(read(wkb, polygons));
+    QCOMPARE(polygons, input);
+}
+
+void TestWkb::readsBigEndianEwkbWithSrid()
+{
+    // SRID=4326;POLYGON((0 0,1 0,0 1,0 0)) as PostGIS writes it in XDR
+    QByteArray wkb;
+    QDataStream out(&wkb, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::BigEndian);
+    out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    out << quint8(0) << quint32(0x20000003) << quint32(4326) << quint32(1) << quint32(4);
+    for (const QPointF& point : { QPointF(0, 0), QPointF(1, 0), QPointF(0, 1), QPointF(0, 0) }) {
+        out << point.x() << point.y();
+    }
+
+    QVector<WkbReader::Polygon> polygons;
+    QVERIFY(read(wkb, polygons));
+    QCOMPARE(polygons.size(), 1);
+    QCOMPARE(polygons.first().first().size(), 4);
+    QCOMPARE(polygons.first().first().at(2), QPointF(0, 1));
+}
+
+void TestWkb::skipsIsoZOrdinates()
+{
+    // POLYGON Z((0 0 5,1 0 5,0 1 5,0 0 5)) in ISO encoding
+    QByteArray wkb;
+    QDataStream out(&wkb, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    out << quint8(1) << quint32(1003) << quint32(1) << quint32(4);
+    for (const QPointF& point : { QPointF(0, 0), QPointF(1, 0), QPointF(0, 1), QPointF(0, 0) }) {
+        out << point.x() << point.y() << 5.0;
+    }
+
+    QVector<WkbReader::Polygon> polygons;
+    QVERIFY(read(wkb, polygons));
+    QCOMPARE(polygons.size(), 1);
+    QCOMPARE(polygons.first().first(), QPolygonF({ QPointF(0, 0), QPointF(1, 0), QPointF(0, 1), QPointF(0, 0) }));
+}
+
+void TestWkb::readsGeometryCollection()
+{
+    // GEOMETRYCOLLECTION(POLYGON(...), MULTIPOLYGON(...)) flattens into one list
+    const WkbReader::Polygon single = square(0.0, 0.0, 1.0);
+    const QVector<WkbReader::Polygon> multi = { square(5.0, 5.0, 1.0), square(8.0, 8.0, 1.0) };
+
+    QByteArray wkb;
+    QDataStream out(&wkb, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out << quint8(1) << quint32(7) << quint32(2);
+    wkb += WkbWriter::writePolygons({ single });
+    wkb += WkbWriter::writePolygons(multi);
+
+    QVector<WkbReader::Polygon> polygons;
+    QVERIFY(read(wkb, polygons));
+    QCOMPARE(polygons, QVector<WkbReader::Polygon>({ single, multi[0], multi[1] }));
+}
+
+void TestWkb::rejectsTruncatedBuffer()
+{
+    const QByteArray wkb = WkbWriter::writePolygons({ square(0.0, 0.0, 1.0) });
+
+    // Every proper prefix ends inside a header, a count or a point
+    for (int length = 0; length < wkb.size(); ++length) {
+        QVector<WkbReader::Polygon> polygons;
+        QVERIFY2(!read(wkb.left(length), polygons), qPrintable(QString("prefix of %1 bytes").arg(length)));
+    }
+}
+
+void TestWkb::rejectsCountsBeyondBuffer()
+{
+    // Counts are checked against the bytes left before anything is allocated
+    QByteArray rings;
+    QDataStream ringOut(&rings, QIODevice::WriteOnly);
+    ringOut.setByteOrder(QDataStream::LittleEndian);
+    ringOut << quint8(1) << quint32(3) << quint32(0x7FFFFFFF);
+
+    QByteArray points;
+    QDataStream pointOut(&points, QIODevice::WriteOnly);
+    pointOut.setByteOrder(QDataStream::LittleEndian);
+    pointOut << quint8(1) << quint32(3) << quint32(1) << quint32(0x10000000) << 0.0 << 0.0;
+
+    QByteArray members;
+    QDataStream memberOut(&members, QIODevice::WriteOnly);
+    memberOut.setByteOrder(QDataStream::LittleEndian);
+    memberOut << quint8(1) << quint32(6) << quint32(1000000);
+
+    for (const QByteArray& wkb : { rings, points, members }) {
+        QVector<WkbReader::Polygon> polygons;
+        QVERIFY(!read(wkb, polygons));
+    }
+}
+
+void TestWkb::rejectsNonPolygonal()
+{
+    // POINT(1 2)
+    QByteArray wkb;
+    QDataStream out(&wkb, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out << quint8(1) << quint32(1) << 1.0 << 2.0;
+
+    QVector<WkbReader::Polygon> polygons;
+    QVERIFY(!read(wkb, polygons));
+
+    // Neither byte order marker
+    wkb[0] = char(2);
+    QVERIFY(!read(wkb, polygons));
+}
+
+void TestWkb::decodesByteaHex()
+{
+    const QByteArray wkb = WkbWriter::writePolygons({ square(0.0, 0.0, 1.0) });
+    const QByteArray text = "\\x" + wkb.toHex();
+
+    QByteArray buffer;
+    QVERIFY(WkbReader::decodeByteaHex(text.constData(), static_cast<std::size_t>(text.size()), buffer));
+    QCOMPARE(buffer, wkb);
+
+    const QByteArray bad = "\\x01zz";
+    QVERIFY(!WkbReader::decodeByteaHex(bad.constData(), static_cast<std::size_t>(bad.size()), buffer));
+    const QByteArray odd = "\\x010";
+    QVERIFY(!WkbReader::decodeByteaHex(odd.constData(), static_cast<std::size_t>(odd.size()), buffer));
+}
+
+QTEST_APPLESS_MAIN(TestWkb)
+#include "tst_wkb.moc"